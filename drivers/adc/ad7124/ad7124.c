@@ -45,6 +45,7 @@
 #include <stdbool.h>
 #include "ad7124.h"
 #include "delay.h"
+#include "error.h"
 
 /* Error codes */
 #define INVALID_VAL -1 /* Invalid argument */
@@ -58,6 +59,17 @@
  */
 #define AD7124_POST_RESET_DELAY      4
 
+/* Data register read command, implicit in continuous read mode */
+#define AD7124_DATA_READ_CMD	(AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD | \
+				 AD7124_COMM_REG_RA(AD7124_DATA_REG))
+
+/* Data, appended status and CRC */
+#define AD7124_STREAM_FRAME_MAX	5
+
+/* Time to wait for DOUT/RDY when leaving the continuous read mode, longer
+ * than the slowest conversion */
+#define AD7124_STREAM_STOP_MS	2000
+
 
 /***************************************************************************//**
  * @brief Reads the value of the specified register without checking if the
@@ -403,6 +415,208 @@ int32_t ad7124_read_data(struct ad7124_dev *dev,
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief DOUT/RDY falling edge handler, clocks out one frame in continuous
+ *        read mode and queues it, untouched, for ad7124_stream_read().
+ *        When a stop is requested the data read command is sent instead,
+ *        which exits the continuous read mode, and the interrupt is left
+ *        disabled.
+ *
+ * @param ctx   - The handler of the instance of the driver.
+ * @param event - Interrupt event (unused).
+ * @param extra - Platform specific data (unused).
+ *
+ * @return None.
+*******************************************************************************/
+static void ad7124_stream_irq_handler(void *ctx, uint32_t event, void *extra)
+{
+	struct ad7124_dev *dev = ctx;
+	uint8_t frame[AD7124_STREAM_FRAME_MAX + 1] = {0};
+
+	if(!dev->stream)
+		return;
+
+	/* DOUT/RDY toggles while the frame is clocked out */
+	irq_disable(dev->irq_ctrl, dev->rdy_irq_id);
+	if (dev->stream->stop_req) {
+		frame[0] = AD7124_DATA_READ_CMD;
+		if (spi_write_and_read(dev->spi_desc, frame,
+				       dev->stream->frame_size + 1) == 0) {
+			dev->stream->stop_req = false;
+			return;
+		}
+	} else if (spi_write_and_read(dev->spi_desc, frame,
+				      dev->stream->frame_size) == 0) {
+		cb_write(dev->stream->cb, frame, dev->stream->frame_size);
+	}
+	irq_enable(dev->irq_ctrl, dev->rdy_irq_id);
+}
+
+/***************************************************************************//**
+ * @brief Starts streaming conversions in continuous read mode. The status
+ *        byte is appended to every result to tag its channel, results are
+ *        read from the DOUT/RDY falling edge interrupt and queued in a ring
+ *        buffer; no register access is possible until ad7124_stream_stop().
+ *
+ * @param dev        - The handler of the instance of the driver.
+ * @param nr_samples - Size of the ring buffer, in conversion results.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_stream_start(struct ad7124_dev *dev,
+			    uint32_t nr_samples)
+{
+	struct ad7124_stream *stream;
+	struct ad7124_st_reg *regs;
+	int32_t ret;
+
+	if(!dev || !dev->irq_ctrl || !nr_samples || dev->stream)
+		return INVALID_VAL;
+
+	regs = dev->regs;
+
+	stream = (struct ad7124_stream *)calloc(1, sizeof(*stream));
+	if (!stream)
+		return INVALID_VAL;
+
+	stream->frame_size = regs[AD7124_Data].size + 1;
+	if (dev->use_crc != AD7124_DISABLE_CRC)
+		stream->frame_size++;
+
+	ret = cb_init(&stream->cb, nr_samples * stream->frame_size);
+	if (ret < 0)
+		goto error_stream;
+
+	/* The handler ignores DOUT/RDY until dev->stream is set */
+	ret = irq_enable(dev->irq_ctrl, dev->rdy_irq_id);
+	if (ret < 0)
+		goto error_cb;
+
+	stream->adc_ctrl = regs[AD7124_ADC_Control].value;
+	regs[AD7124_ADC_Control].value |= AD7124_ADC_CTRL_REG_DATA_STATUS |
+					  AD7124_ADC_CTRL_REG_CONT_READ;
+	ret = ad7124_write_register(dev, regs[AD7124_ADC_Control]);
+	if (ret < 0)
+		goto error_irq;
+
+	dev->stream = stream;
+
+	return 0;
+
+error_irq:
+	regs[AD7124_ADC_Control].value = stream->adc_ctrl;
+	irq_disable(dev->irq_ctrl, dev->rdy_irq_id);
+error_cb:
+	cb_remove(stream->cb);
+error_stream:
+	free(stream);
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief Exits continuous read mode, restores the ADC control register and
+ *        frees the stream buffer. The exit command is sent by the DOUT/RDY
+ *        interrupt, so that it is issued while DOUT/RDY is low.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_stream_stop(struct ad7124_dev *dev)
+{
+	struct ad7124_stream *stream;
+	uint32_t timeout = AD7124_STREAM_STOP_MS;
+	int32_t ret;
+
+	if(!dev || !dev->stream)
+		return INVALID_VAL;
+
+	stream = dev->stream;
+
+	stream->stop_req = true;
+	while (stream->stop_req && --timeout)
+		mdelay(1);
+
+	ret = irq_disable(dev->irq_ctrl, dev->rdy_irq_id);
+	if (ret < 0)
+		return ret;
+
+	/* No conversion came in, keep streaming */
+	if (stream->stop_req) {
+		stream->stop_req = false;
+		irq_enable(dev->irq_ctrl, dev->rdy_irq_id);
+		return TIMEOUT;
+	}
+
+	dev->regs[AD7124_ADC_Control].value = stream->adc_ctrl;
+	dev->stream = NULL;
+	cb_remove(stream->cb);
+	free(stream);
+
+	return ad7124_write_register(dev, dev->regs[AD7124_ADC_Control]);
+}
+
+/***************************************************************************//**
+ * @brief Reads the streamed conversion results, verifying the CRC of the
+ *        whole batch. Results failing the check are dropped and counted in
+ *        stream->crc_errors.
+ *
+ * @param dev        - The handler of the instance of the driver.
+ * @param samples    - Buffer receiving the results.
+ * @param nr_samples - Maximum number of results to read.
+ *
+ * @return Returns the number of results read or negative error code.
+*******************************************************************************/
+int32_t ad7124_stream_read(struct ad7124_dev *dev,
+			   struct ad7124_sample *samples,
+			   uint32_t nr_samples)
+{
+	struct ad7124_stream *stream;
+	uint8_t frame[AD7124_STREAM_FRAME_MAX + 1];
+	uint32_t size, i, n = 0;
+	uint8_t data_size, j;
+	int32_t ret;
+
+	if(!dev || !dev->stream || !samples)
+		return INVALID_VAL;
+
+	stream = dev->stream;
+	data_size = dev->regs[AD7124_Data].size;
+
+	ret = cb_size(stream->cb, &size);
+	if (ret < 0 && ret != -EOVERRUN)
+		return ret;
+
+	size /= stream->frame_size;
+	if (size > nr_samples)
+		size = nr_samples;
+
+	/* The CRC covers the implicit read command */
+	frame[0] = AD7124_DATA_READ_CMD;
+	for (i = 0; i < size; i++) {
+		ret = cb_read(stream->cb, &frame[1], stream->frame_size);
+		if (ret < 0 && ret != -EOVERRUN)
+			return ret;
+
+		if (dev->use_crc != AD7124_DISABLE_CRC &&
+		    ad7124_compute_crc8(frame, stream->frame_size + 1)) {
+			stream->crc_errors++;
+			continue;
+		}
+
+		samples[n].value = 0;
+		for (j = 1; j <= data_size; j++)
+			samples[n].value = (samples[n].value << 8) | frame[j];
+		samples[n].status = frame[data_size + 1];
+		samples[n].channel =
+			AD7124_STATUS_REG_CH_ACTIVE(samples[n].status);
+		n++;
+	}
+
+	return n;
+}
+
 /***************************************************************************//**
  * @brief Computes the CRC checksum for a data buffer.
  *
@@ -502,6 +716,9 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 
 	dev->regs = init_param->regs;
 	dev->spi_rdy_poll_cnt = init_param->spi_rdy_poll_cnt;
+	dev->stream = NULL;
+	dev->irq_ctrl = init_param->irq_ctrl;
+	dev->rdy_irq_id = init_param->rdy_irq_id;
 
 	/* Initialize the SPI communication. */
 	ret = spi_init(&dev->spi_desc, init_param->spi_init);
@@ -534,7 +751,16 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 
 	*device = dev;
 
-	return ret;
+	if (ret < 0 || !dev->irq_ctrl)
+		return ret;
+
+	/* Conversions are read from the DOUT/RDY interrupt when streaming */
+	dev->rdy_cb.callback = ad7124_stream_irq_handler;
+	dev->rdy_cb.ctx = dev;
+	dev->rdy_cb.config = init_param->rdy_irq_config;
+
+	return irq_register_callback(dev->irq_ctrl, dev->rdy_irq_id,
+				     &dev->rdy_cb);
 }
 
 /***************************************************************************//**
@@ -548,6 +774,12 @@ int32_t ad7124_remove(struct ad7124_dev *dev)
 {
 	int32_t ret;
 
+	if (dev->stream)
+		ad7124_stream_stop(dev);
+
+	if (dev->irq_ctrl)
+		irq_unregister(dev->irq_ctrl, dev->rdy_irq_id);
+
 	ret = spi_remove(dev->spi_desc);
 
 	free(dev);
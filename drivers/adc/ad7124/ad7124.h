@@ -45,8 +45,11 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 #include "spi.h"
 #include "delay.h"
+#include "irq.h"
+#include "circular_buffer.h"
 
 /******************************************************************************/
 /******************* Register map and register definitions ********************/
@@ -331,6 +334,35 @@ enum ad7124_registers {
 	AD7124_REG_NO
 };
 
+/*
+ * One conversion result read in continuous read mode.
+ * @value: The conversion result.
+ * @channel: The channel the result belongs to, from the appended status.
+ * @status: The appended status byte.
+ */
+struct ad7124_sample {
+	uint32_t value;
+	uint8_t channel;
+	uint8_t status;
+};
+
+/*
+ * Continuous read streaming state.
+ * @cb: Raw frames (data, status and optional CRC) read on DOUT/RDY.
+ * @adc_ctrl: ADC control register value before streaming started.
+ * @frame_size: Size of one raw frame, in bytes.
+ * @crc_errors: Number of frames dropped because of a CRC mismatch.
+ * @stop_req: Set by ad7124_stream_stop(), the next DOUT/RDY interrupt exits
+ *            the continuous read mode and clears it.
+ */
+struct ad7124_stream {
+	struct circular_buffer *cb;
+	int32_t adc_ctrl;
+	uint8_t frame_size;
+	uint32_t crc_errors;
+	volatile bool stop_req;
+};
+
 /*
  * The structure describes the device and is used with the ad7124 driver.
  * @spi_desc: A reference to the SPI configuration of the device.
@@ -342,6 +374,10 @@ enum ad7124_registers {
  * @spi_rdy_poll_cnt: Number of times the driver should read the Error register
  *                    to check if the device is ready to accept user requests,
  *                    before a timeout error will be issued.
+ * @irq_ctrl: Interrupt controller handling the DOUT/RDY falling edge.
+ * @rdy_irq_id: DOUT/RDY interrupt ID.
+ * @rdy_cb: DOUT/RDY interrupt callback.
+ * @stream: Continuous read state, NULL when not streaming.
  */
 struct ad7124_dev {
 	/* SPI */
@@ -351,6 +387,11 @@ struct ad7124_dev {
 	int16_t use_crc;
 	int16_t check_ready;
 	int16_t spi_rdy_poll_cnt;
+	/* Streaming */
+	struct irq_ctrl_desc	*irq_ctrl;
+	uint32_t		rdy_irq_id;
+	struct callback_desc	rdy_cb;
+	struct ad7124_stream	*stream;
 };
 
 struct ad7124_init_param {
@@ -359,6 +400,10 @@ struct ad7124_init_param {
 	/* Device Settings */
 	struct ad7124_st_reg	*regs;
 	int16_t spi_rdy_poll_cnt;
+	/* Streaming (optional) */
+	struct irq_ctrl_desc	*irq_ctrl;
+	uint32_t		rdy_irq_id;
+	void			*rdy_irq_config;
 };
 
 /******************************************************************************/
@@ -407,6 +452,18 @@ int32_t ad7124_wait_for_conv_ready(struct ad7124_dev *dev,
 int32_t ad7124_read_data(struct ad7124_dev *dev,
 			 int32_t* p_data);
 
+/*! Starts streaming conversions in continuous read mode. */
+int32_t ad7124_stream_start(struct ad7124_dev *dev,
+			    uint32_t nr_samples);
+
+/*! Exits continuous read mode and frees the stream buffer. */
+int32_t ad7124_stream_stop(struct ad7124_dev *dev);
+
+/*! Reads and verifies the streamed conversion results. */
+int32_t ad7124_stream_read(struct ad7124_dev *dev,
+			   struct ad7124_sample *samples,
+			   uint32_t nr_samples);
+
 /*! Computes the CRC checksum for a data buffer. */
 uint8_t ad7124_compute_crc8(uint8_t* p_buf,
 			    uint8_t buf_size);
@@ -46,12 +46,25 @@
 /******************************************************************************/
 #include <stdlib.h>
 #include "ad717x.h"
+#include "delay.h"
+#include "error.h"
 
 /* Error codes */
 #define INVALID_VAL -1 /* Invalid argument */
 #define COMM_ERR    -2 /* Communication error on receive */
 #define TIMEOUT     -3 /* A timeout has occured */
 
+/* Data register read command, implicit in continuous read mode */
+#define AD717X_DATA_READ_CMD	(AD717X_COMM_REG_WEN | AD717X_COMM_REG_RD | \
+				 AD717X_COMM_REG_RA(AD717X_DATA_REG))
+
+/* Data (up to 32 bits), appended status and checksum */
+#define AD717X_STREAM_FRAME_MAX	6
+
+/* Time to wait for DOUT/RDY when leaving the continuous read mode, longer
+ * than the slowest conversion */
+#define AD717X_STREAM_STOP_MS	2000
+
 /***************************************************************************//**
 * @brief  Searches through the list of registers of the driver instance and
 *         retrieves a pointer to the register that matches the given address.
@@ -333,6 +346,230 @@ int32_t AD717X_ComputeDataregSize(ad717x_dev *device)
 	return 0;
 }
 
+/***************************************************************************//**
+* @brief DOUT/RDY falling edge handler, clocks out one frame in continuous
+*        read mode and queues it, untouched, for AD717X_StreamRead().
+*        When a stop is requested the data read command is sent instead,
+*        which exits the continuous read mode, and the interrupt is left
+*        disabled.
+*
+* @param ctx   - The handler of the instance of the driver.
+* @param event - Interrupt event (unused).
+* @param extra - Platform specific data (unused).
+*
+* @return None.
+*******************************************************************************/
+static void AD717X_StreamIrqHandler(void *ctx, uint32_t event, void *extra)
+{
+	ad717x_dev *device = ctx;
+	uint8_t frame[AD717X_STREAM_FRAME_MAX + 1] = {0};
+
+	if(!device->stream)
+		return;
+
+	/* DOUT/RDY toggles while the frame is clocked out */
+	irq_disable(device->irq_ctrl, device->rdy_irq_id);
+	if(device->stream->stopReq) {
+		frame[0] = AD717X_DATA_READ_CMD;
+		if(spi_write_and_read(device->spi_desc, frame,
+				      device->stream->frameSize + 1) == 0) {
+			device->stream->stopReq = false;
+			return;
+		}
+	} else if(spi_write_and_read(device->spi_desc, frame,
+				     device->stream->frameSize) == 0) {
+		cb_write(device->stream->cb, frame, device->stream->frameSize);
+	}
+	irq_enable(device->irq_ctrl, device->rdy_irq_id);
+}
+
+/***************************************************************************//**
+* @brief Starts streaming conversions in continuous read mode. The status
+*        register is appended to every result to tag its channel, results are
+*        read from the DOUT/RDY falling edge interrupt and queued in a ring
+*        buffer; no register access is possible until AD717X_StreamStop().
+*
+* @param device    - The handler of the instance of the driver.
+* @param nrSamples - Size of the ring buffer, in conversion results.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_StreamStart(ad717x_dev *device,
+			   uint32_t nrSamples)
+{
+	ad717x_stream *stream;
+	ad717x_st_reg *ifmodeReg;
+	int32_t ret;
+
+	if(!device || !device->irq_ctrl || !nrSamples || device->stream)
+		return INVALID_VAL;
+
+	ifmodeReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	if(!ifmodeReg)
+		return INVALID_VAL;
+
+	stream = (ad717x_stream *)calloc(1, sizeof(*stream));
+	if(!stream)
+		return INVALID_VAL;
+
+	stream->dataReg = AD717X_GetReg(device, AD717X_DATA_REG);
+	if(!stream->dataReg) {
+		ret = INVALID_VAL;
+		goto error_stream;
+	}
+
+	stream->ifmodeValue = ifmodeReg->value;
+	ifmodeReg->value |= AD717X_IFMODE_REG_DATA_STAT;
+	AD717X_ComputeDataregSize(device);
+
+	stream->frameSize = stream->dataReg->size;
+	if(device->useCRC != AD717X_DISABLE)
+		stream->frameSize++;
+
+	ret = cb_init(&stream->cb, nrSamples * stream->frameSize);
+	if(ret < 0)
+		goto error_ifmode;
+
+	/* The handler ignores DOUT/RDY until device->stream is set */
+	ret = irq_enable(device->irq_ctrl, device->rdy_irq_id);
+	if(ret < 0)
+		goto error_cb;
+
+	ifmodeReg->value |= AD717X_IFMODE_REG_CONT_READ;
+	ret = AD717X_WriteRegister(device, AD717X_IFMODE_REG);
+	if(ret < 0)
+		goto error_irq;
+
+	device->stream = stream;
+
+	return 0;
+
+error_irq:
+	irq_disable(device->irq_ctrl, device->rdy_irq_id);
+error_cb:
+	cb_remove(stream->cb);
+error_ifmode:
+	ifmodeReg->value = stream->ifmodeValue;
+	AD717X_ComputeDataregSize(device);
+error_stream:
+	free(stream);
+
+	return ret;
+}
+
+/***************************************************************************//**
+* @brief Exits continuous read mode, restores the interface mode register and
+*        frees the stream buffer. The exit command is sent by the DOUT/RDY
+*        interrupt, so that it is issued while DOUT/RDY is low.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_StreamStop(ad717x_dev *device)
+{
+	ad717x_stream *stream;
+	ad717x_st_reg *ifmodeReg;
+	uint32_t timeout = AD717X_STREAM_STOP_MS;
+	int32_t ret;
+
+	if(!device || !device->stream)
+		return INVALID_VAL;
+
+	stream = device->stream;
+
+	stream->stopReq = true;
+	while(stream->stopReq && --timeout)
+		mdelay(1);
+
+	ret = irq_disable(device->irq_ctrl, device->rdy_irq_id);
+	if(ret < 0)
+		return ret;
+
+	/* No conversion came in, keep streaming */
+	if(stream->stopReq) {
+		stream->stopReq = false;
+		irq_enable(device->irq_ctrl, device->rdy_irq_id);
+		return TIMEOUT;
+	}
+
+	ifmodeReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	ifmodeReg->value = stream->ifmodeValue;
+	device->stream = NULL;
+	cb_remove(stream->cb);
+	free(stream);
+
+	ret = AD717X_WriteRegister(device, AD717X_IFMODE_REG);
+	if(ret < 0)
+		return ret;
+
+	return AD717X_ComputeDataregSize(device);
+}
+
+/***************************************************************************//**
+* @brief Reads the streamed conversion results, verifying the checksum of the
+*        whole batch. Results failing the check are dropped and counted in
+*        stream->checkErrors.
+*
+* @param device    - The handler of the instance of the driver.
+* @param samples   - Buffer receiving the results.
+* @param nrSamples - Maximum number of results to read.
+*
+* @return Returns the number of results read or negative error code.
+*******************************************************************************/
+int32_t AD717X_StreamRead(ad717x_dev *device,
+			  ad717x_sample *samples,
+			  uint32_t nrSamples)
+{
+	ad717x_stream *stream;
+	uint8_t frame[AD717X_STREAM_FRAME_MAX + 1];
+	uint32_t size, i, n = 0;
+	uint8_t dataSize, check8, j;
+	int32_t ret;
+
+	if(!device || !device->stream || !samples)
+		return INVALID_VAL;
+
+	stream = device->stream;
+	/* The data register size accounts for the appended status */
+	dataSize = stream->dataReg->size - 1;
+
+	ret = cb_size(stream->cb, &size);
+	if(ret < 0 && ret != -EOVERRUN)
+		return ret;
+
+	size /= stream->frameSize;
+	if(size > nrSamples)
+		size = nrSamples;
+
+	/* The checksum covers the implicit read command */
+	frame[0] = AD717X_DATA_READ_CMD;
+	for(i = 0; i < size; i++) {
+		ret = cb_read(stream->cb, &frame[1], stream->frameSize);
+		if(ret < 0 && ret != -EOVERRUN)
+			return ret;
+
+		check8 = 0;
+		if(device->useCRC == AD717X_USE_CRC)
+			check8 = AD717X_ComputeCRC8(frame, stream->frameSize + 1);
+		if(device->useCRC == AD717X_USE_XOR)
+			check8 = AD717X_ComputeXOR8(frame, stream->frameSize + 1);
+		if(check8 != 0) {
+			stream->checkErrors++;
+			continue;
+		}
+
+		samples[n].value = 0;
+		for(j = 1; j <= dataSize; j++)
+			samples[n].value = (samples[n].value << 8) | frame[j];
+		samples[n].status = frame[dataSize + 1];
+		samples[n].channel = AD717X_STATUS_REG_CH(samples[n].status);
+		n++;
+	}
+
+	return n;
+}
+
 /***************************************************************************//**
 * @brief Computes the CRC checksum for a data buffer.
 *
@@ -436,6 +673,9 @@ int32_t AD717X_Init(ad717x_dev **device,
 
 	dev->regs = init_param.regs;
 	dev->num_regs = init_param.num_regs;
+	dev->stream = NULL;
+	dev->irq_ctrl = init_param.irq_ctrl;
+	dev->rdy_irq_id = init_param.rdy_irq_id;
 
 	/* Initialize the SPI communication. */
 	ret = spi_init(&dev->spi_desc, &init_param.spi_init);
@@ -484,6 +724,17 @@ int32_t AD717X_Init(ad717x_dev **device,
 	if(ret < 0)
 		return ret;
 
+	/* Conversions are read from the DOUT/RDY interrupt when streaming */
+	if(dev->irq_ctrl) {
+		dev->rdy_cb.callback = AD717X_StreamIrqHandler;
+		dev->rdy_cb.ctx = dev;
+		dev->rdy_cb.config = init_param.rdy_irq_config;
+		ret = irq_register_callback(dev->irq_ctrl, dev->rdy_irq_id,
+					    &dev->rdy_cb);
+		if(ret < 0)
+			return ret;
+	}
+
 	*device = dev;
 
 	return ret;
@@ -498,6 +749,12 @@ int32_t AD717X_remove(ad717x_dev *dev)
 {
 	int32_t ret;
 
+	if(dev->stream)
+		AD717X_StreamStop(dev);
+
+	if(dev->irq_ctrl)
+		irq_unregister(dev->irq_ctrl, dev->rdy_irq_id);
+
 	ret = spi_remove(dev->spi_desc);
 
 	free(dev);
@@ -47,7 +47,10 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 #include "spi.h"
+#include "irq.h"
+#include "circular_buffer.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -66,6 +69,32 @@ typedef struct {
 	int32_t size;
 } ad717x_st_reg;
 
+/*! AD717X conversion result read in continuous read mode */
+typedef struct {
+	uint32_t value;
+	uint8_t channel;
+	uint8_t status;
+} ad717x_sample;
+
+/*
+ * Continuous read streaming state.
+ * @cb: Raw frames (data, status and optional checksum) read on DOUT/RDY.
+ * @dataReg: Data register, cached to stay out of the register list lookup.
+ * @ifmodeValue: Interface mode register value before streaming started.
+ * @frameSize: Size of one raw frame, in bytes.
+ * @checkErrors: Number of frames dropped because of a checksum mismatch.
+ * @stopReq: Set by AD717X_StreamStop(), the next DOUT/RDY interrupt exits
+ *           the continuous read mode and clears it.
+ */
+typedef struct {
+	struct circular_buffer	*cb;
+	ad717x_st_reg		*dataReg;
+	int32_t			ifmodeValue;
+	uint8_t			frameSize;
+	uint32_t		checkErrors;
+	volatile bool		stopReq;
+} ad717x_stream;
+
 /*
  * The structure describes the device and is used with the ad717x driver.
  * @slave_select_id: The ID of the Slave Select to be passed to the SPI calls.
@@ -73,6 +102,10 @@ typedef struct {
  *       provide when calling the Setup() function.
  * @num_regs: The length of the register list.
  * @userCRC: Error check type to use on SPI transfers.
+ * @irq_ctrl: Interrupt controller handling the DOUT/RDY falling edge.
+ * @rdy_irq_id: DOUT/RDY interrupt ID.
+ * @rdy_cb: DOUT/RDY interrupt callback.
+ * @stream: Continuous read state, NULL when not streaming.
  */
 typedef struct {
 	/* SPI */
@@ -81,6 +114,11 @@ typedef struct {
 	ad717x_st_reg		*regs;
 	uint8_t			num_regs;
 	ad717x_crc_mode		useCRC;
+	/* Streaming */
+	struct irq_ctrl_desc	*irq_ctrl;
+	uint32_t		rdy_irq_id;
+	struct callback_desc	rdy_cb;
+	ad717x_stream		*stream;
 } ad717x_dev;
 
 typedef struct {
@@ -89,6 +127,10 @@ typedef struct {
 	/* Device Settings */
 	ad717x_st_reg		*regs;
 	uint8_t			num_regs;
+	/* Streaming (optional) */
+	struct irq_ctrl_desc	*irq_ctrl;
+	uint32_t		rdy_irq_id;
+	void			*rdy_irq_config;
 } ad717x_init_param;
 
 /*****************************************************************************/
@@ -313,6 +355,18 @@ int32_t AD717X_ReadData(ad717x_dev *device,
  *  read. */
 int32_t AD717X_ComputeDataregSize(ad717x_dev *device);
 
+/*! Starts streaming conversions in continuous read mode. */
+int32_t AD717X_StreamStart(ad717x_dev *device,
+			   uint32_t nrSamples);
+
+/*! Exits continuous read mode and frees the stream buffer. */
+int32_t AD717X_StreamStop(ad717x_dev *device);
+
+/*! Reads and verifies the streamed conversion results. */
+int32_t AD717X_StreamRead(ad717x_dev *device,
+			  ad717x_sample *samples,
+			  uint32_t nrSamples);
+
 /*! Computes the CRC checksum for a data buffer. */
 uint8_t AD717X_ComputeCRC8(uint8_t* pBuf,
 			   uint8_t bufSize);
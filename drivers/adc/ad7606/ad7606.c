@@ -43,7 +43,12 @@
 #include "stdio.h"
 #include "stdlib.h"
 #include "stdbool.h"
+#include "string.h"
 #include "ad7606.h"
+#ifdef AD7606_SPI_ENGINE_OFFLOAD
+#include "spi_engine.h"
+#include "axi_dmac.h"
+#endif
 
 static const struct ad7606_chip_info ad7606_chip_info_tbl[] = {
 	[ID_AD7605_4] = {
@@ -155,6 +160,328 @@ int32_t ad7606_spi_read_samples(struct ad7606_dev *dev,
 	return 0;
 }
 
+/**
+ * Wait for the end of the current conversion.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad7606_wait_busy(struct ad7606_dev *dev)
+{
+	uint32_t timeout = 1000;
+	uint8_t busy;
+	int32_t ret;
+
+	do {
+		ret = gpio_get_value(dev->gpio_busy, &busy);
+		if (ret < 0)
+			return ret;
+		if (!busy)
+			return 0;
+		udelay(1);
+	} while (--timeout);
+
+	return -1;
+}
+
+/**
+ * Convert the big endian conversion result, read in place, to host order.
+ * @param data - Raw conversion result, overwritten with the samples.
+ * @param nr_ch - Number of channels.
+ */
+static void ad7606_unpack(uint16_t *data, uint8_t nr_ch)
+{
+	uint8_t *raw = (uint8_t *)data;
+	uint8_t i;
+
+	for (i = 0; i < nr_ch; i++)
+		data[i] = (raw[2 * i] << 8) | raw[2 * i + 1];
+}
+
+/**
+ * Trigger one conversion and read the result of all channels.
+ * @param dev - The device structure.
+ * @param data - Buffer holding one sample per channel.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad7606_read(struct ad7606_dev *dev,
+		    uint16_t *data)
+{
+	uint8_t nr_ch;
+	int32_t ret;
+
+	nr_ch = ad7606_chip_info_tbl[dev->device_id].num_channels;
+
+	ret = gpio_set_value(dev->gpio_convst, 0);
+	if (ret < 0)
+		return ret;
+
+	ret = gpio_set_value(dev->gpio_convst, 1);
+	if (ret < 0)
+		return ret;
+
+	ret = ad7606_wait_busy(dev);
+	if (ret < 0)
+		return ret;
+
+	memset(data, 0, nr_ch * sizeof(*data));
+	ret = spi_write_and_read(dev->spi_desc, (uint8_t *)data, nr_ch * 2);
+	if (ret < 0)
+		return ret;
+
+	ad7606_unpack(data, nr_ch);
+
+	return 0;
+}
+
+/**
+ * BUSY falling edge handler, reads all the channels of the finished
+ * conversion straight into the burst ring buffer.
+ * @param ctx - The device structure.
+ * @param event - Interrupt event (unused).
+ * @param extra - Platform specific data (unused).
+ */
+static void ad7606_busy_irq_handler(void *ctx, uint32_t event, void *extra)
+{
+	struct ad7606_dev *dev = ctx;
+	struct ad7606_burst *burst = &dev->burst;
+	uint16_t *frame;
+	uint32_t next;
+	uint8_t nr_ch;
+
+	if (!burst->active)
+		return;
+
+	nr_ch = ad7606_chip_info_tbl[dev->device_id].num_channels;
+
+	next = burst->write_idx + 1;
+	if (next == burst->nr_frames)
+		next = 0;
+
+	/* Keep the conversion in sync with the ADC even if it is dropped */
+	if (next == burst->read_idx) {
+		burst->overflows++;
+		spi_write_and_read(dev->spi_desc, dev->data, nr_ch * 2);
+	} else {
+		frame = &burst->buff[burst->write_idx * nr_ch];
+		if (spi_write_and_read(dev->spi_desc, (uint8_t *)frame,
+				       nr_ch * 2) == 0) {
+			ad7606_unpack(frame, nr_ch);
+			burst->write_idx = next;
+		}
+	}
+
+	if (burst->limited && !--burst->remaining) {
+		burst->active = false;
+		pwm_disable(dev->trigger);
+		irq_disable(dev->irq_ctrl, dev->busy_irq_id);
+	}
+}
+
+/**
+ * Start a hardware timed burst acquisition.
+ *
+ * CONVST is driven by the PWM generator and every conversion is read from
+ * the BUSY interrupt into the caller ring buffer, which is consumed through
+ * ad7606_burst_read().
+ * @param dev - The device structure.
+ * @param param - Burst parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad7606_burst_start(struct ad7606_dev *dev,
+			   struct ad7606_burst_param *param)
+{
+	struct ad7606_burst *burst = &dev->burst;
+	int32_t ret;
+
+	if (!dev->trigger || !dev->irq_ctrl || !param->buff ||
+	    param->nr_frames < 2)
+		return -1;
+
+	if (burst->active)
+		return -1;
+
+	burst->buff = param->buff;
+	burst->nr_frames = param->nr_frames;
+	burst->write_idx = 0;
+	burst->read_idx = 0;
+	burst->overflows = 0;
+	burst->remaining = param->nr_conversions;
+	burst->limited = param->nr_conversions != 0;
+
+	ret = pwm_set_period(dev->trigger, param->period_ns);
+	if (ret < 0)
+		return ret;
+
+	ret = irq_enable(dev->irq_ctrl, dev->busy_irq_id);
+	if (ret < 0)
+		return ret;
+
+	burst->active = true;
+
+	ret = pwm_enable(dev->trigger);
+	if (ret < 0) {
+		burst->active = false;
+		irq_disable(dev->irq_ctrl, dev->busy_irq_id);
+	}
+
+	return ret;
+}
+
+/**
+ * Stop the burst acquisition. The samples already captured can still be
+ * read with ad7606_burst_read().
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad7606_burst_stop(struct ad7606_dev *dev)
+{
+	int32_t ret;
+
+	if (!dev->trigger || !dev->irq_ctrl)
+		return -1;
+
+	ret = pwm_disable(dev->trigger);
+	if (ret < 0)
+		return ret;
+
+	dev->burst.active = false;
+
+	return irq_disable(dev->irq_ctrl, dev->busy_irq_id);
+}
+
+/**
+ * Get the number of frames waiting in the burst ring buffer.
+ * @param dev - The device structure.
+ * @return The number of available frames.
+ */
+uint32_t ad7606_burst_available(struct ad7606_dev *dev)
+{
+	struct ad7606_burst *burst = &dev->burst;
+	uint32_t wr = burst->write_idx;
+	uint32_t rd = burst->read_idx;
+
+	if (wr >= rd)
+		return wr - rd;
+
+	return burst->nr_frames - rd + wr;
+}
+
+/**
+ * Read frames from the burst ring buffer, copying contiguous spans.
+ * @param dev - The device structure.
+ * @param data - Destination, holds nr_frames * num_channels samples.
+ * @param nr_frames - Maximum number of frames to read.
+ * @return The number of frames read.
+ */
+int32_t ad7606_burst_read(struct ad7606_dev *dev,
+			  uint16_t *data,
+			  uint32_t nr_frames)
+{
+	struct ad7606_burst *burst = &dev->burst;
+	uint32_t avail, span, rd, done = 0;
+	uint8_t nr_ch;
+
+	if (!burst->buff)
+		return -1;
+
+	nr_ch = ad7606_chip_info_tbl[dev->device_id].num_channels;
+	avail = ad7606_burst_available(dev);
+	nr_frames = nr_frames < avail ? nr_frames : avail;
+	rd = burst->read_idx;
+
+	while (done < nr_frames) {
+		span = burst->nr_frames - rd;
+		if (span > nr_frames - done)
+			span = nr_frames - done;
+
+		memcpy(&data[done * nr_ch], &burst->buff[rd * nr_ch],
+		       span * nr_ch * sizeof(*data));
+		done += span;
+		rd += span;
+		if (rd == burst->nr_frames)
+			rd = 0;
+	}
+
+	burst->read_idx = rd;
+
+	return done;
+}
+
+#ifdef AD7606_SPI_ENGINE_OFFLOAD
+/**
+ * Capture a burst through the SPI engine offload module.
+ *
+ * The PWM generator triggers the conversions and the SPI engine reads every
+ * conversion by itself, the DMA storing the samples at offload_msg->rx_addr.
+ * The offload DMA is cyclic, so it is stopped as soon as it reports the end
+ * of the first pass over the buffer.
+ * @param dev - The device structure.
+ * @param period_ns - CONVST period, in nanoseconds.
+ * @param nr_conversions - Number of conversions to capture.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad7606_burst_offload(struct ad7606_dev *dev,
+			     uint32_t period_ns,
+			     uint32_t nr_conversions)
+{
+	struct spi_engine_desc *eng_desc;
+	uint64_t timeout_us;
+	uint32_t pending;
+	uint8_t nr_ch;
+	int32_t ret;
+
+	if (!dev->trigger || !dev->offload_msg)
+		return -1;
+
+	eng_desc = dev->spi_desc->extra;
+	nr_ch = ad7606_chip_info_tbl[dev->device_id].num_channels;
+
+	ret = pwm_set_period(dev->trigger, period_ns);
+	if (ret < 0)
+		return ret;
+
+	ret = spi_engine_offload_transfer(dev->spi_desc, *dev->offload_msg,
+					  nr_conversions);
+	if (ret < 0)
+		return ret;
+
+	ret = pwm_enable(dev->trigger);
+	if (ret < 0)
+		return ret;
+
+	/*
+	 * Each conversion lasts at least one CONVST period, allow twice that
+	 * for SPI reads slower than the trigger.
+	 */
+	timeout_us = ((uint64_t)period_ns * nr_conversions) / 500 + 1000;
+	do {
+		axi_dmac_read(eng_desc->offload_rx_dma, AXI_DMAC_REG_IRQ_PENDING,
+			      &pending);
+		if (pending & AXI_DMAC_IRQ_EOT)
+			break;
+		udelay(1);
+	} while (--timeout_us);
+
+	axi_dmac_write(eng_desc->offload_rx_dma, AXI_DMAC_REG_CTRL, 0);
+	axi_dmac_write(eng_desc->offload_rx_dma, AXI_DMAC_REG_IRQ_PENDING,
+		       pending);
+
+	ret = pwm_disable(dev->trigger);
+	if (ret < 0)
+		return ret;
+
+	if (!timeout_us)
+		return -1;
+
+	if (dev->dcache_invalidate_range)
+		dev->dcache_invalidate_range(dev->offload_msg->rx_addr,
+					     nr_conversions * nr_ch *
+					     (eng_desc->data_width / 8));
+
+	return 0;
+}
+#endif
+
 int32_t ad7606_reset(struct ad7606_dev *dev)
 {
 	int32_t ret;
@@ -302,6 +629,30 @@ int32_t ad7606_init(struct ad7606_dev **device,
 	if (ad7606_chip_info_tbl[dev->device_id].has_oversampling)
 		ad7606_set_os_ratio(dev, init_param->osr);
 
+	if (init_param->trigger_init) {
+		ret = pwm_init(&dev->trigger, init_param->trigger_init);
+		if (ret < 0)
+			goto error;
+	}
+
+#ifdef AD7606_SPI_ENGINE_OFFLOAD
+	dev->offload_msg = init_param->offload_msg;
+	dev->dcache_invalidate_range = init_param->dcache_invalidate_range;
+#endif
+
+	if (init_param->irq_ctrl) {
+		dev->irq_ctrl = init_param->irq_ctrl;
+		dev->busy_irq_id = init_param->busy_irq_id;
+		dev->busy_cb.callback = ad7606_busy_irq_handler;
+		dev->busy_cb.ctx = dev;
+		dev->busy_cb.config = init_param->busy_irq_config;
+		ret = irq_register_callback(dev->irq_ctrl, dev->busy_irq_id,
+					    &dev->busy_cb);
+		if (ret < 0)
+			goto error;
+		dev->busy_irq_registered = true;
+	}
+
 	*device = dev;
 
 	printf("ad7606 successfully initialized\n");
@@ -317,6 +668,16 @@ int32_t ad7606_remove(struct ad7606_dev *dev)
 {
 	int32_t ret;
 
+	if (dev->busy_irq_registered) {
+		irq_disable(dev->irq_ctrl, dev->busy_irq_id);
+		irq_unregister(dev->irq_ctrl, dev->busy_irq_id);
+	}
+
+	if (dev->trigger) {
+		pwm_disable(dev->trigger);
+		pwm_remove(dev->trigger);
+	}
+
 	ret = spi_remove(dev->spi_desc);
 
 	free(dev);
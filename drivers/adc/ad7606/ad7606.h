@@ -43,9 +43,12 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
 #include "delay.h"
 #include "gpio.h"
 #include "spi.h"
+#include "pwm.h"
+#include "irq.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -70,6 +73,8 @@
 #define AD7606_RD_FLAG_MSK(x)		(BIT(6) | ((x) & 0x3F))
 #define AD7606_WR_FLAG_MSK(x)		((x) & 0x3F)
 
+#define AD7606_MAX_CHANNELS		8
+
 enum ad7606_supported_device_ids {
 	ID_AD7605_4,
 	ID_AD7606_4,
@@ -103,6 +108,45 @@ struct ad7606_chip_info {
 	bool has_registers;
 };
 
+/**
+ * @struct ad7606_burst_param
+ * @brief Burst acquisition parameters.
+ */
+struct ad7606_burst_param {
+	/** Caller ring buffer, holds nr_frames * num_channels samples */
+	uint16_t *buff;
+	/** Ring buffer size, in conversions (frames) */
+	uint32_t nr_frames;
+	/** CONVST period, in nanoseconds */
+	uint32_t period_ns;
+	/** Number of conversions to capture, 0 for continuous acquisition */
+	uint32_t nr_conversions;
+};
+
+/**
+ * @struct ad7606_burst
+ * @brief Burst acquisition state, shared between the BUSY interrupt
+ * (producer) and ad7606_burst_read() (consumer).
+ */
+struct ad7606_burst {
+	/** Caller ring buffer */
+	uint16_t *buff;
+	/** Ring buffer size, in frames */
+	uint32_t nr_frames;
+	/** Next frame written by the BUSY interrupt */
+	volatile uint32_t write_idx;
+	/** Next frame returned to the consumer */
+	volatile uint32_t read_idx;
+	/** Frames dropped because the consumer did not keep up */
+	volatile uint32_t overflows;
+	/** Conversions left to capture, 0 for continuous acquisition */
+	volatile uint32_t remaining;
+	/** Conversions are limited to nr_conversions */
+	bool limited;
+	/** Acquisition running */
+	volatile bool active;
+};
+
 struct ad7606_dev {
 	/* SPI */
 	spi_desc *spi_desc;
@@ -119,6 +163,17 @@ struct ad7606_dev {
 	/* Buffer to store the conv result */
 	uint8_t	data[16];
 	bool sw_mode_en;
+	/* Burst acquisition */
+	struct pwm_desc *trigger;
+	struct irq_ctrl_desc *irq_ctrl;
+	uint32_t busy_irq_id;
+	struct callback_desc busy_cb;
+	bool busy_irq_registered;
+	struct ad7606_burst burst;
+#ifdef AD7606_SPI_ENGINE_OFFLOAD
+	struct spi_engine_offload_message *offload_msg;
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+#endif
 };
 
 struct ad7606_init_param {
@@ -137,6 +192,21 @@ struct ad7606_init_param {
 	enum ad7606_range range;
 	enum ad7606_osr osr;
 	bool sw_mode_en;
+	/* Burst acquisition (optional) */
+	/* PWM generator driving CONVST, NULL if not wired */
+	struct pwm_init_param *trigger_init;
+	/* Interrupt controller handling the BUSY falling edge */
+	struct irq_ctrl_desc *irq_ctrl;
+	/* BUSY interrupt ID */
+	uint32_t busy_irq_id;
+	/* Platform specific BUSY interrupt configuration */
+	void *busy_irq_config;
+#ifdef AD7606_SPI_ENGINE_OFFLOAD
+	/* SPI engine offload message used for DMA captures */
+	struct spi_engine_offload_message *offload_msg;
+	/* Invalidate the data cache for the given address range */
+	void (*dcache_invalidate_range)(uint32_t address, uint32_t bytes_count);
+#endif
 };
 
 int32_t ad7606_spi_reg_read(struct ad7606_dev *dev,
@@ -149,6 +219,20 @@ int32_t ad7606_spi_read_bulk(struct ad7606_dev *dev);
 int32_t ad7606_spi_read_samples(struct ad7606_dev *dev,
 				uint8_t channel,
 				uint16_t *adc_data);
+int32_t ad7606_read(struct ad7606_dev *dev,
+		    uint16_t *data);
+int32_t ad7606_burst_start(struct ad7606_dev *dev,
+			   struct ad7606_burst_param *param);
+int32_t ad7606_burst_stop(struct ad7606_dev *dev);
+uint32_t ad7606_burst_available(struct ad7606_dev *dev);
+int32_t ad7606_burst_read(struct ad7606_dev *dev,
+			  uint16_t *data,
+			  uint32_t nr_frames);
+#ifdef AD7606_SPI_ENGINE_OFFLOAD
+int32_t ad7606_burst_offload(struct ad7606_dev *dev,
+			     uint32_t period_ns,
+			     uint32_t nr_conversions);
+#endif
 int32_t ad7606_reset(struct ad7606_dev *dev);
 int32_t ad7606_request_gpios(struct ad7606_dev *dev,
 			     struct ad7606_init_param *init_param);
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <inttypes.h>
+#include <stdbool.h>
 #include "error.h"
 #include "delay.h"
 #include "util.h"
@@ -182,84 +183,246 @@ int32_t axi_adc_delay_set(struct axi_adc *adc,
 }
 
 /***************************************************************************//**
- * @brief axi_adc_delay_calibrate
+ * @brief Clear the PN status of all channels, wait and collect the channels
+ *        that reported errors during the dwell time. The status is cleared
+ *        AXI_ADC_DELAY_SETTLE_US after the call, so that the errors caused
+ *        by the previous tap change are not counted.
+ * @param adc - The device structure.
+ * @param dwell_us - Observation window in microseconds.
+ * @return Bitmask of the channels with PN errors or out of sync.
 *******************************************************************************/
-int32_t axi_adc_delay_calibrate(struct axi_adc *adc,
-				uint32_t no_of_lanes,
-				enum axi_adc_pn_sel sel)
+static uint32_t axi_adc_pn_err_mask(struct axi_adc *adc, uint32_t dwell_us)
+{
+	uint32_t err_mask = 0;
+	uint32_t reg_data;
+	uint8_t ch;
+
+	udelay(AXI_ADC_DELAY_SETTLE_US);
+	for (ch = 0; ch < adc->num_channels; ch++)
+		axi_adc_write(adc, AXI_ADC_REG_CHAN_STATUS(ch), 0xff);
+	udelay(dwell_us);
+
+	for (ch = 0; ch < adc->num_channels && ch < 32; ch++) {
+		axi_adc_read(adc, AXI_ADC_REG_CHAN_STATUS(ch), &reg_data);
+		if (reg_data & (AXI_ADC_PN_ERR | AXI_ADC_PN_OOS))
+			err_mask |= BIT(ch);
+	}
+
+	return err_mask;
+}
+
+/***************************************************************************//**
+ * @brief Check whether a lane saw PN errors.
+ * @param cal - The calibration parameters.
+ * @param lane - The lane index.
+ * @param err_mask - Channel error mask returned by axi_adc_pn_err_mask().
+ * @return true if the lane has errors, false otherwise.
+*******************************************************************************/
+static bool axi_adc_lane_err(const struct axi_adc_delay_cal *cal,
+			     uint32_t lane, uint32_t err_mask)
 {
-	uint8_t err_field[32] = {0};
-	uint16_t valid_range[5] = {0};
-	uint16_t invalid_range[5] = {0};
-	uint16_t delay = 0;
-	uint16_t start_valid_delay = 32;
-	uint16_t start_invalid_delay = 32;
-	uint8_t interval = 0;
-	uint8_t max_interval = 0;
-	uint8_t max_valid_range = 0;
-	uint8_t cnt_valid[5] = {0};
-	uint8_t cnt_invalid = 0;
-	uint8_t val = 0;
-	uint8_t max_val = 32;
-
-	for (delay = 0; delay < 32; delay++) {
-		axi_adc_delay_set(adc, no_of_lanes, delay);
-		mdelay(20);
-		if (axi_adc_pn_mon(adc, sel, 100) == 0) {
-			err_field[delay] = 0;
-			start_valid_delay = start_valid_delay == 32 ?
-					    delay : start_valid_delay;
+	if (!cal->lane_chan)
+		return err_mask != 0;
+
+	return (err_mask & BIT(cal->lane_chan[lane])) != 0;
+}
+
+/***************************************************************************//**
+ * @brief Find the widest window of passing taps.
+ * @param pass - Bitmap of the taps that passed, bit n for tap n.
+ * @param eye - The resulting eye. A zero width means no passing tap.
+ * @return None.
+*******************************************************************************/
+static void axi_adc_delay_eye_find(uint32_t pass,
+				   struct axi_adc_delay_eye *eye)
+{
+	uint8_t tap;
+	uint8_t start = 0;
+	uint8_t width = 0;
+
+	eye->start = 0;
+	eye->width = 0;
+	for (tap = 0; tap < AXI_ADC_DELAY_TAPS; tap++) {
+		if (pass & BIT(tap)) {
+			if (!width)
+				start = tap;
+			width++;
+			if (width > eye->width) {
+				eye->start = start;
+				eye->width = width;
+			}
 		} else {
-			err_field[delay] = 1;
+			width = 0;
 		}
 	}
-	if (start_valid_delay > 31) {
-		printf("%s FAILED.\n", __func__);
-		axi_adc_delay_set(adc, no_of_lanes, 0);
+	eye->center = eye->start + (eye->width ? (eye->width - 1) / 2 : 0);
+}
+
+/***************************************************************************//**
+ * @brief Check a single tap of a lane with the long dwell time, while the
+ *        other lanes stay at their current taps.
+ * @param adc - The device structure.
+ * @param cal - The calibration parameters.
+ * @param lane - The lane index.
+ * @param tap - The tap to be checked.
+ * @return true if the tap is error free, false otherwise.
+*******************************************************************************/
+static bool axi_adc_delay_confirm(struct axi_adc *adc,
+				  const struct axi_adc_delay_cal *cal,
+				  uint32_t lane, uint8_t tap)
+{
+	uint32_t err_mask;
+
+	axi_adc_idelay_set(adc, lane, tap);
+	err_mask = axi_adc_pn_err_mask(adc, cal->confirm_ms * 1000);
+
+	return !axi_adc_lane_err(cal, lane, err_mask);
+}
+
+/***************************************************************************//**
+ * @brief Calibrate the interface delay of each lane independently.
+ *
+ * All the taps are first swept with the short reject dwell time. When the
+ * lanes can be observed individually (lane_chan is set) a single sweep of all
+ * lanes in parallel is enough, otherwise each lane is swept on its own while
+ * the others are held in the center of the common eye. Only the edges of
+ * the widest eye of each lane are then checked with the long confirm dwell
+ * time, shrinking the eye until both edges are error free.
+ * @param adc - The device structure.
+ * @param cal - The calibration parameters. The per-lane eyes are returned in
+ *              cal->eye, if not NULL.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+*******************************************************************************/
+int32_t axi_adc_delay_calibrate_lanes(struct axi_adc *adc,
+				      struct axi_adc_delay_cal *cal)
+{
+	struct axi_adc_delay_eye eye[AXI_ADC_DELAY_MAX_LANES];
+	struct axi_adc_delay_eye common;
+	uint32_t pass[AXI_ADC_DELAY_MAX_LANES] = {0};
+	uint32_t pcore_version;
+	uint32_t err_mask;
+	uint32_t common_pass = 0;
+	uint32_t lane;
+	uint32_t reg_data;
+	uint8_t tap;
+	uint8_t ch;
+
+	if (!cal || !cal->no_of_lanes ||
+	    cal->no_of_lanes > AXI_ADC_DELAY_MAX_LANES)
+		return FAILURE;
+
+	if (cal->lane_chan)
+		for (lane = 0; lane < cal->no_of_lanes; lane++)
+			if (cal->lane_chan[lane] >= adc->num_channels ||
+			    cal->lane_chan[lane] >= 32)
+				return FAILURE;
+
+	axi_adc_read(adc, 0x0, &pcore_version);
+	pcore_version >>= 16;
+	if (pcore_version < 9) {
+		printf("%s: pcore version %"PRIu32" not supported\n\r",
+		       __func__, pcore_version);
 		return FAILURE;
 	}
 
-	start_valid_delay = 32;
-	start_invalid_delay = 32;
-	for (val = 0; val < max_val; val++) {
-		if (err_field[val] == 0) {
-			if (start_valid_delay == 32) {
-				start_valid_delay = val;
-			}
-			if (start_valid_delay != 32 && start_invalid_delay != 32 ) {
-				start_valid_delay = 32;
-				start_invalid_delay = 32;
-			}
-			cnt_valid[interval]++;
-		}
-		if((err_field[val] == 1) || (val == max_val - 1)) {
-			if (start_invalid_delay == 32) {
-				start_invalid_delay = val;
-			}
-			if (start_valid_delay != 32 && start_invalid_delay != 32 ) {
-				valid_range[interval] = start_valid_delay;
-				invalid_range[interval] = start_invalid_delay;
-				start_valid_delay = 32;
-				start_invalid_delay = 32;
-				interval++;
+	for (ch = 0; ch < adc->num_channels; ch++) {
+		axi_adc_read(adc, AXI_ADC_REG_CHAN_CNTRL(ch), &reg_data);
+		reg_data |= AXI_ADC_ENABLE;
+		axi_adc_write(adc, AXI_ADC_REG_CHAN_CNTRL(ch), reg_data);
+		axi_adc_set_pnsel(adc, ch, cal->sel);
+	}
+	mdelay(1);
+
+	/* Common sweep, every lane on the same tap */
+	for (tap = 0; tap < AXI_ADC_DELAY_TAPS; tap++) {
+		for (lane = 0; lane < cal->no_of_lanes; lane++)
+			axi_adc_idelay_set(adc, lane, tap);
+		err_mask = axi_adc_pn_err_mask(adc, cal->reject_us);
+		if (!err_mask)
+			common_pass |= BIT(tap);
+		for (lane = 0; lane < cal->no_of_lanes; lane++)
+			if (!axi_adc_lane_err(cal, lane, err_mask))
+				pass[lane] |= BIT(tap);
+	}
+
+	/* Lanes not observable individually, sweep them one at a time */
+	if (!cal->lane_chan) {
+		axi_adc_delay_eye_find(common_pass, &common);
+		if (!common.width)
+			goto error;
+		for (lane = 0; lane < cal->no_of_lanes; lane++)
+			axi_adc_idelay_set(adc, lane, common.center);
+		for (lane = 0; lane < cal->no_of_lanes; lane++) {
+			pass[lane] = 0;
+			for (tap = 0; tap < AXI_ADC_DELAY_TAPS; tap++) {
+				axi_adc_idelay_set(adc, lane, tap);
+				err_mask = axi_adc_pn_err_mask(adc, cal->reject_us);
+				if (!err_mask)
+					pass[lane] |= BIT(tap);
 			}
-			cnt_invalid++;
+			axi_adc_idelay_set(adc, lane, common.center);
 		}
 	}
 
-	for (val = 0; val < 5; val++) {
-		if (cnt_valid[val] > max_valid_range) {
-			max_valid_range = cnt_valid[val];
-			max_interval = val;
-		}
+	for (lane = 0; lane < cal->no_of_lanes; lane++) {
+		axi_adc_delay_eye_find(pass[lane], &eye[lane]);
+		if (!eye[lane].width)
+			goto error;
+		axi_adc_idelay_set(adc, lane, eye[lane].center);
 	}
 
-	delay = (valid_range[max_interval] + invalid_range[max_interval] - 1) / 2;
+	/* Confirm the eye edges with the long dwell time */
+	for (lane = 0; lane < cal->no_of_lanes; lane++) {
+		while (eye[lane].width &&
+		       !axi_adc_delay_confirm(adc, cal, lane, eye[lane].start)) {
+			eye[lane].start++;
+			eye[lane].width--;
+		}
+		while (eye[lane].width > 1 &&
+		       !axi_adc_delay_confirm(adc, cal, lane,
+					      eye[lane].start + eye[lane].width - 1))
+			eye[lane].width--;
+		if (!eye[lane].width)
+			goto error;
+		eye[lane].center = eye[lane].start + (eye[lane].width - 1) / 2;
+		axi_adc_idelay_set(adc, lane, eye[lane].center);
+	}
 
-	printf("adc_delay: setting zero error delay (%d)\n\r", delay);
-	axi_adc_delay_set(adc, no_of_lanes, delay);
+	for (lane = 0; lane < cal->no_of_lanes; lane++) {
+		printf("adc_delay: lane %"PRIu32" delay %d (eye %d-%d)\n\r", lane,
+		       eye[lane].center, eye[lane].start,
+		       eye[lane].start + eye[lane].width - 1);
+		if (cal->eye)
+			cal->eye[lane] = eye[lane];
+	}
 
 	return SUCCESS;
+
+error:
+	printf("%s FAILED.\n", __func__);
+	for (lane = 0; lane < cal->no_of_lanes; lane++)
+		axi_adc_idelay_set(adc, lane, 0);
+
+	return FAILURE;
+}
+
+/***************************************************************************//**
+ * @brief axi_adc_delay_calibrate
+*******************************************************************************/
+int32_t axi_adc_delay_calibrate(struct axi_adc *adc,
+				uint32_t no_of_lanes,
+				enum axi_adc_pn_sel sel)
+{
+	struct axi_adc_delay_cal cal = {
+		.no_of_lanes = no_of_lanes,
+		.sel = sel,
+		.lane_chan = NULL,
+		.reject_us = AXI_ADC_DELAY_REJECT_US,
+		.confirm_ms = AXI_ADC_DELAY_CONFIRM_MS,
+		.eye = NULL,
+	};
+
+	return axi_adc_delay_calibrate_lanes(adc, &cal);
 }
 
 /***************************************************************************//**
@@ -114,6 +114,20 @@
 
 #define AXI_ADC_REG_DELAY(l)		(0x0800 + (l) * 0x4)
 
+#define AXI_ADC_DELAY_TAPS		32
+#define AXI_ADC_DELAY_MAX_LANES		32
+
+#ifndef AXI_ADC_DELAY_REJECT_US
+#define AXI_ADC_DELAY_REJECT_US		1000
+#endif
+#ifndef AXI_ADC_DELAY_CONFIRM_MS
+#define AXI_ADC_DELAY_CONFIRM_MS	100
+#endif
+/* Time for the PN checker to resync after a tap change */
+#ifndef AXI_ADC_DELAY_SETTLE_US
+#define AXI_ADC_DELAY_SETTLE_US		10
+#endif
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -141,6 +155,39 @@ enum axi_adc_pn_sel {
 	AXI_ADC_PN_END = 10,
 };
 
+/**
+ * @struct axi_adc_delay_eye
+ * @brief Error free window of taps of a lane.
+ */
+struct axi_adc_delay_eye {
+	/** First error free tap */
+	uint8_t start;
+	/** Number of error free taps */
+	uint8_t width;
+	/** Selected tap */
+	uint8_t center;
+};
+
+/**
+ * @struct axi_adc_delay_cal
+ * @brief Interface delay calibration parameters.
+ */
+struct axi_adc_delay_cal {
+	/** Number of data lanes */
+	uint32_t no_of_lanes;
+	/** PN sequence to be checked */
+	enum axi_adc_pn_sel sel;
+	/** Channel whose PN status reflects each lane, NULL if the lanes
+	 *  can't be observed individually */
+	const uint8_t *lane_chan;
+	/** Dwell time used to quickly reject a tap */
+	uint32_t reject_us;
+	/** Dwell time used to confirm the eye edges */
+	uint32_t confirm_ms;
+	/** Eye of each lane, no_of_lanes entries, optional */
+	struct axi_adc_delay_eye *eye;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -171,6 +218,8 @@ int32_t axi_adc_delay_set(struct axi_adc *adc,
 int32_t axi_adc_delay_calibrate(struct axi_adc *core,
 				uint32_t no_of_lanes,
 				enum axi_adc_pn_sel sel);
+int32_t axi_adc_delay_calibrate_lanes(struct axi_adc *adc,
+				      struct axi_adc_delay_cal *cal);
 int32_t axi_adc_set_calib_phase(struct axi_adc *adc,
 				uint32_t chan,
 				int32_t val,
@@ -43,11 +43,13 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <inttypes.h>
+#include <string.h>
 #include "error.h"
 #include "delay.h"
 #include "util.h"
 #include "axi_dac_core.h"
 #include "axi_io.h"
+#include "axi_dmac.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -798,6 +800,200 @@ int32_t axi_dac_load_custom_data(struct axi_dac *dac,
 }
 
 
+/***************************************************************************//**
+ * @brief Interleave int16 channel data, one sample of each channel per frame.
+ * @param dst - Destination buffer.
+ * @param src - Channel data, one array per channel.
+ * @param nb_ch - Number of channels.
+ * @param nb_samples - Number of samples per channel.
+ * @return None.
+*******************************************************************************/
+static void axi_dac_wave_pack_int16(int16_t *dst,
+				    const int16_t *const *src,
+				    uint32_t nb_ch,
+				    uint32_t nb_samples)
+{
+	uint32_t *dst32 = (uint32_t *)dst;
+	uint64_t *dst64 = (uint64_t *)dst;
+	uint32_t i, ch;
+
+	/* Build whole frames in a register for the common channel counts */
+	switch (nb_ch) {
+	case 1:
+		memcpy(dst, src[0], nb_samples * sizeof(*dst));
+		break;
+	case 2:
+		for (i = 0; i < nb_samples; i++)
+			dst32[i] = (uint16_t)src[0][i] |
+				   ((uint32_t)(uint16_t)src[1][i] << 16);
+		break;
+	case 4:
+		for (i = 0; i < nb_samples; i++)
+			dst64[i] = (uint16_t)src[0][i] |
+				   ((uint64_t)(uint16_t)src[1][i] << 16) |
+				   ((uint64_t)(uint16_t)src[2][i] << 32) |
+				   ((uint64_t)(uint16_t)src[3][i] << 48);
+		break;
+	default:
+		for (ch = 0; ch < nb_ch; ch++)
+			for (i = 0; i < nb_samples; i++)
+				dst[i * nb_ch + ch] = src[ch][i];
+		break;
+	}
+}
+
+/***************************************************************************//**
+ * @brief Convert float channel data to int16 and interleave it.
+ * @param dst - Destination buffer.
+ * @param src - Channel data, one array per channel, full scale is +/-1.0.
+ * @param nb_ch - Number of channels.
+ * @param nb_samples - Number of samples per channel.
+ * @return None.
+*******************************************************************************/
+static void axi_dac_wave_pack_float(int16_t *dst,
+				    const float *const *src,
+				    uint32_t nb_ch,
+				    uint32_t nb_samples)
+{
+	uint32_t i, ch;
+	float val;
+
+	for (ch = 0; ch < nb_ch; ch++) {
+		for (i = 0; i < nb_samples; i++) {
+			val = src[ch][i] * 32767.0f;
+			if (val > 32767.0f)
+				val = 32767.0f;
+			else if (val < -32768.0f)
+				val = -32768.0f;
+			dst[i * nb_ch + ch] = (int16_t)val;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief Initialize a DMA waveform loader.
+ * @param loader - The waveform loader.
+ * @param init - The initialization parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+*******************************************************************************/
+int32_t axi_dac_wave_loader_init(struct axi_dac_wave_loader **loader,
+				 const struct axi_dac_wave_loader_init *init)
+{
+	struct axi_dac_wave_loader *ldr;
+	uint8_t i;
+
+	if (!loader || !init || !init->dac || !init->dmac || !init->buff[0] ||
+	    !init->buff_size)
+		return FAILURE;
+
+	for (i = 0; i < 2; i++)
+		if ((uintptr_t)init->buff[i] % AXI_DAC_WAVE_ALIGN)
+			return FAILURE;
+
+	ldr = (struct axi_dac_wave_loader *)calloc(1, sizeof(*ldr));
+	if (!ldr)
+		return FAILURE;
+
+	ldr->dac = init->dac;
+	ldr->dmac = init->dmac;
+	ldr->buff_size = init->buff_size;
+	ldr->nb_buffs = init->buff[1] ? 2 : 1;
+	for (i = 0; i < ldr->nb_buffs; i++) {
+		ldr->buff[i] = init->buff[i];
+		ldr->dma_address[i] = init->dma_address[i] ? init->dma_address[i] :
+				      (uint32_t)(uintptr_t)init->buff[i];
+	}
+	ldr->cache_flush = init->cache_flush;
+	ldr->active = -1;
+
+	*loader = ldr;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Free the resources allocated by axi_dac_wave_loader_init().
+ * @param loader - The waveform loader.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+*******************************************************************************/
+int32_t axi_dac_wave_loader_remove(struct axi_dac_wave_loader *loader)
+{
+	if (!loader)
+		return FAILURE;
+
+	free(loader);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Load a waveform and transmit it in a loop.
+ *
+ * The channel data is interleaved in bulk into the buffer that is not being
+ * transmitted, the buffer is flushed once and the cyclic DMA transfer is
+ * then restarted on it. With two buffers the previous waveform keeps playing
+ * until the new one is completely prepared. With a single buffer the
+ * transfer is stopped before the buffer is rewritten, so the output pauses
+ * while the new waveform is prepared.
+ * @param loader - The waveform loader.
+ * @param ch_data - One array of nb_samples samples for each DAC channel.
+ * @param fmt - Format of the channel data.
+ * @param nb_samples - Number of samples per channel.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+*******************************************************************************/
+int32_t axi_dac_wave_load(struct axi_dac_wave_loader *loader,
+			  const void *const *ch_data,
+			  enum axi_dac_wave_fmt fmt,
+			  uint32_t nb_samples)
+{
+	uint32_t nb_ch = loader->dac->num_channels;
+	uint32_t size;
+	int32_t next;
+	int32_t ret;
+
+	if (!ch_data || !nb_ch || !nb_samples ||
+	    nb_samples > loader->buff_size / (nb_ch * sizeof(int16_t)))
+		return FAILURE;
+
+	size = nb_samples * nb_ch * sizeof(int16_t);
+	next = (loader->nb_buffs == 2 && loader->active == 0) ? 1 : 0;
+
+	/* Don't rewrite the buffer the cyclic transfer is reading */
+	if (loader->active == next)
+		axi_dmac_write(loader->dmac, AXI_DMAC_REG_CTRL, 0x0);
+
+	switch (fmt) {
+	case AXI_DAC_WAVE_INT16:
+		axi_dac_wave_pack_int16(loader->buff[next],
+					(const int16_t *const *)ch_data,
+					nb_ch, nb_samples);
+		break;
+	case AXI_DAC_WAVE_FLOAT:
+		axi_dac_wave_pack_float(loader->buff[next],
+					(const float *const *)ch_data,
+					nb_ch, nb_samples);
+		break;
+	default:
+		return FAILURE;
+	}
+
+	if (loader->cache_flush)
+		loader->cache_flush((uint32_t)(uintptr_t)loader->buff[next],
+				    round_up(size, AXI_DAC_WAVE_ALIGN) *
+				    AXI_DAC_WAVE_ALIGN);
+
+	ret = axi_dmac_transfer(loader->dmac, loader->dma_address[next], size);
+	if (ret != SUCCESS)
+		return ret;
+
+	if (loader->active < 0)
+		axi_dac_set_datasel(loader->dac, -1, AXI_DAC_DATA_SEL_DMA);
+
+	loader->active = next;
+
+	return SUCCESS;
+}
+
 /***************************************************************************//**
  * @brief axi_dac_init
  *******************************************************************************/
@@ -44,6 +44,14 @@
 /******************************************************************************/
 #include <stdint.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Alignment of the waveform buffers, a multiple of the cache line size */
+#ifndef AXI_DAC_WAVE_ALIGN
+#define AXI_DAC_WAVE_ALIGN	64
+#endif
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -87,6 +95,40 @@ struct axi_dac_channel {
 	enum axi_dac_data_sel sel;      // set to one of the enumerated type above.
 };
 
+enum axi_dac_wave_fmt {
+	AXI_DAC_WAVE_INT16,
+	AXI_DAC_WAVE_FLOAT,
+};
+
+struct axi_dmac;
+
+struct axi_dac_wave_loader {
+	struct axi_dac *dac;
+	struct axi_dmac *dmac;
+	uint8_t nb_buffs;
+	void *buff[2];
+	uint32_t dma_address[2];
+	uint32_t buff_size;
+	/* Buffer being transmitted, -1 if none */
+	int32_t active;
+	void (*cache_flush)(uint32_t address, uint32_t size);
+};
+
+struct axi_dac_wave_loader_init {
+	struct axi_dac *dac;
+	/* Transmit DMA, set up with DMA_CYCLIC */
+	struct axi_dmac *dmac;
+	/* AXI_DAC_WAVE_ALIGN aligned buffers. The second one is optional, without
+	 * it the output pauses while a new waveform is loaded */
+	void *buff[2];
+	/* Addresses of the buffers seen by the DMA, 0 if the same */
+	uint32_t dma_address[2];
+	/* Size of each buffer, in bytes */
+	uint32_t buff_size;
+	/* Data cache flush of a CPU address, NULL if the buffers are not cached */
+	void (*cache_flush)(uint32_t address, uint32_t size);
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -137,5 +179,12 @@ int32_t axi_dac_load_custom_data(struct axi_dac *dac,
 				 uint32_t custom_tx_count,
 				 uint32_t address);
 int32_t axi_dac_data_setup(struct axi_dac *dac);
+int32_t axi_dac_wave_loader_init(struct axi_dac_wave_loader **loader,
+				 const struct axi_dac_wave_loader_init *init);
+int32_t axi_dac_wave_loader_remove(struct axi_dac_wave_loader *loader);
+int32_t axi_dac_wave_load(struct axi_dac_wave_loader *loader,
+			  const void *const *ch_data,
+			  enum axi_dac_wave_fmt fmt,
+			  uint32_t nb_samples);
 
 #endif
@@ -313,71 +313,188 @@ static void axi_clkgen_setup_ranges(struct axi_clkgen *axi_clkgen,
 }
 
 /**
- * @brief axi_clkgen_calc_params
+ * @brief axi_clkgen_get_ranges
  */
-void axi_clkgen_calc_params(struct axi_clkgen *axi_clkgen,
-			    uint32_t fin,
-			    uint32_t fout,
-			    uint32_t *best_d,
-			    uint32_t *best_m,
-			    uint32_t *best_dout)
+static void axi_clkgen_get_ranges(struct axi_clkgen *clkgen)
 {
-	uint32_t fpfd_min	= 10000;
-	uint32_t fpfd_max	= 300000;
-	uint32_t fvco_min	= 600000;
-	uint32_t fvco_max	= 1200000;
-	uint32_t	   d		= 0;
-	uint32_t	   d_min	= 0;
-	uint32_t	   d_max	= 0;
-	uint32_t	   _d_min	= 0;
-	uint32_t	   _d_max	= 0;
-	uint32_t	   m		= 0;
-	uint32_t	   m_min	= 0;
-	uint32_t	   m_max	= 0;
-	uint32_t	   dout		= 0;
-	uint32_t	   fvco		= 0;
-	int32_t		   f		= 0;
-	int32_t		   best_f	= 0;
 	uint32_t pcore_version;
 
-	axi_clkgen_read(axi_clkgen, AXI_REG_VERSION, &pcore_version);
+	if (clkgen->ranges_valid)
+		return;
+
+	clkgen->fpfd_min = 10000;
+	clkgen->fpfd_max = 300000;
+	clkgen->fvco_min = 600000;
+	clkgen->fvco_max = 1200000;
+
+	axi_clkgen_read(clkgen, AXI_REG_VERSION, &pcore_version);
 	if (AXI_PCORE_VER_MAJOR(pcore_version) > 0x04)
-		axi_clkgen_setup_ranges(axi_clkgen, &fpfd_min, &fpfd_max,
-					&fvco_min, &fvco_max);
+		axi_clkgen_setup_ranges(clkgen, &clkgen->fpfd_min, &clkgen->fpfd_max,
+					&clkgen->fvco_min, &clkgen->fvco_max);
 
-	fin /= 1000;
-	fout /= 1000;
+	clkgen->ranges_valid = true;
+}
+
+/**
+ * @brief axi_clkgen_try
+ */
+static bool axi_clkgen_try(struct axi_clkgen_solution *sol,
+			   uint64_t fin, uint32_t d, uint32_t m, uint32_t dout)
+{
+	uint64_t div = (uint64_t)d * dout;
+	int64_t err;
+	uint32_t rate;
+
+	rate = (fin * m + div / 2) / div;
+	err = (int64_t)rate - sol->fout;
+	if (sol->d && (abs(err) >= abs((int64_t)sol->rate - sol->fout)))
+		return false;
+
+	sol->d = d;
+	sol->m = m;
+	sol->dout = dout;
+	sol->rate = rate;
+	sol->error = err;
+
+	return (fin * m == (uint64_t)sol->fout * div);
+}
 
-	best_f = 0x7fffffff;
-	*best_d = 0;
-	*best_m = 0;
-	*best_dout = 0;
+/**
+ * @brief axi_clkgen_search
+ *
+ * Exhaustive search of the MMCM parameters, in Hz. For each input divider
+ * the VCO window bounds the multiplier, and only the two output dividers
+ * around each VCO rate (or the two multipliers around each output divider,
+ * whichever is the smaller set) can hold the optimum. The search stops at
+ * the first exact solution.
+ */
+static void axi_clkgen_search(struct axi_clkgen *clkgen,
+			      struct axi_clkgen_solution *sol)
+{
+	uint64_t fin = sol->fin;
+	uint64_t fout = sol->fout;
+	uint64_t fpfd_min = clkgen->fpfd_min * 1000ULL;
+	uint64_t fpfd_max = clkgen->fpfd_max * 1000ULL;
+	uint64_t fvco_min = clkgen->fvco_min * 1000ULL;
+	uint64_t fvco_max = clkgen->fvco_max * 1000ULL;
+	uint32_t d, d_min, d_max;
+	uint32_t m, m_min, m_max;
+	uint32_t dout, dout_min, dout_max;
+	uint32_t i;
 
 	d_min = max(DIV_ROUND_UP(fin, fpfd_max), 1);
 	d_max = min(fin / fpfd_min, 80);
 
-	m_min = max(DIV_ROUND_UP(fvco_min, fin) * d_min, 1);
-	m_max = min(fvco_max * d_max / fin, 64);
-
-	for(m = m_min; m <= m_max; m++) {
-		_d_min = max(d_min, DIV_ROUND_UP(fin * m, fvco_max));
-		_d_max = min(d_max, fin * m / fvco_min);
-
-		for (d = _d_min; d <= _d_max; d++) {
-			fvco = fin * m / d;
-			dout = DIV_ROUND_CLOSEST(fvco, fout);
-			dout = clamp(dout, 1, 128);
-			f = fvco / dout;
-			if (abs(f - (int32_t)fout) < abs(best_f - (int32_t)fout)) {
-				best_f = f;
-				*best_d = d;
-				*best_m = m;
-				*best_dout = dout;
-				if (best_f == (int32_t)fout)
-					return;
+	for (d = d_min; d <= d_max; d++) {
+		m_min = max(DIV_ROUND_UP(fvco_min * d, fin), 1);
+		m_max = min(fvco_max * d / fin, 64);
+		if (m_min > m_max)
+			continue;
+
+		dout_min = clamp(fin * m_min / d / fout, 1, 128);
+		dout_max = clamp(fin * m_max / d / fout + 1, 1, 128);
+
+		if (m_max - m_min <= dout_max - dout_min) {
+			for (m = m_min; m <= m_max; m++) {
+				dout = clamp(fin * m / d / fout, 1, 128);
+				for (i = 0; i < 2 && dout + i <= 128; i++)
+					if (axi_clkgen_try(sol, fin, d, m, dout + i))
+						return;
 			}
+		} else {
+			for (dout = dout_min; dout <= dout_max; dout++) {
+				m = clamp(fout * d * dout / fin, m_min, m_max);
+				for (i = 0; i < 2 && m + i <= m_max; i++)
+					if (axi_clkgen_try(sol, fin, d, m + i, dout))
+						return;
+			}
+		}
+	}
+}
+
+/**
+ * @brief axi_clkgen_solve
+ *
+ * Find the MMCM parameters giving the output rate closest to fout. Recent
+ * solutions are memoized, so switching between a few rates does not search
+ * again.
+ */
+int32_t axi_clkgen_solve(struct axi_clkgen *clkgen,
+			 uint32_t fin,
+			 uint32_t fout,
+			 struct axi_clkgen_solution *sol)
+{
+	struct axi_clkgen_solution *entry;
+	uint32_t i;
+
+	for (i = 0; i < clkgen->cache_len; i++) {
+		entry = &clkgen->cache[i];
+		if ((entry->fin == fin) && (entry->fout == fout)) {
+			*sol = *entry;
+			return sol->d ? SUCCESS : FAILURE;
 		}
 	}
+
+	sol->fin = fin;
+	sol->fout = fout;
+	sol->d = 0;
+	sol->m = 0;
+	sol->dout = 0;
+	sol->rate = 0;
+	sol->error = 0;
+
+	if (fin && fout) {
+		axi_clkgen_get_ranges(clkgen);
+		axi_clkgen_search(clkgen, sol);
+	}
+
+	clkgen->cache[clkgen->cache_next] = *sol;
+	clkgen->cache_next = (clkgen->cache_next + 1) % AXI_CLKGEN_CACHE_SIZE;
+	if (clkgen->cache_len < AXI_CLKGEN_CACHE_SIZE)
+		clkgen->cache_len++;
+
+	return sol->d ? SUCCESS : FAILURE;
+}
+
+/**
+ * @brief axi_clkgen_plan
+ *
+ * Solve a set of output rates from the parent rate ahead of time. The
+ * entries can later be applied with axi_clkgen_set_solution().
+ */
+int32_t axi_clkgen_plan(struct axi_clkgen *clkgen,
+			const uint32_t *rates,
+			uint32_t nb_rates,
+			struct axi_clkgen_solution *plan)
+{
+	int32_t ret = SUCCESS;
+	uint32_t i;
+
+	for (i = 0; i < nb_rates; i++)
+		if (axi_clkgen_solve(clkgen, clkgen->parent_rate, rates[i],
+				     &plan[i]) != SUCCESS)
+			ret = FAILURE;
+
+	return ret;
+}
+
+/**
+ * @brief axi_clkgen_calc_params
+ */
+void axi_clkgen_calc_params(struct axi_clkgen *axi_clkgen,
+			    uint32_t fin,
+			    uint32_t fout,
+			    uint32_t *best_d,
+			    uint32_t *best_m,
+			    uint32_t *best_dout)
+{
+	struct axi_clkgen_solution sol;
+
+	axi_clkgen_solve(axi_clkgen, fin, fout, &sol);
+
+	*best_d = sol.d;
+	*best_m = sol.m;
+	*best_dout = sol.dout;
 }
 
 /**
@@ -413,14 +530,14 @@ static void axi_clkgen_mmcm_enable(struct axi_clkgen *clkgen,
 }
 
 /**
- * @brief axi_clkgen_set_rate
+ * @brief axi_clkgen_set_solution
  */
-int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen,
-			    uint32_t rate)
+int32_t axi_clkgen_set_solution(struct axi_clkgen *clkgen,
+				const struct axi_clkgen_solution *sol)
 {
-	uint32_t d		 = 0;
-	uint32_t m		 = 0;
-	uint32_t dout	 = 0;
+	uint32_t d		 = sol->d;
+	uint32_t m		 = sol->m;
+	uint32_t dout	 = sol->dout;
 	uint32_t nocount = 0;
 	uint32_t high	 = 0;
 	uint32_t edge	 = 0;
@@ -429,13 +546,8 @@ int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen,
 	uint32_t lock	 = 0;
 	uint32_t reg_val;
 
-	if (clkgen->parent_rate == 0 || rate == 0)
-		return 0;
-
-	axi_clkgen_calc_params(clkgen, clkgen->parent_rate, rate, &d, &m, &dout);
-
 	if (d == 0 || dout == 0 || m == 0)
-		return 0;
+		return FAILURE;
 
 	filter = axi_clkgen_lookup_filter(m - 1);
 	lock = axi_clkgen_lookup_lock(m - 1);
@@ -476,16 +588,35 @@ int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen,
 
 	axi_clkgen_read(clkgen, AXI_CLKGEN_REG_STATUS, &reg_val);
 	if ((reg_val & AXI_CLKGEN_STATUS) == 0x0) {
-		printf("%s: MMCM-PLL NOT locked (%"PRIu32" Hz)\n", clkgen->name, rate);
+		printf("%s: MMCM-PLL NOT locked (%"PRIu32" Hz)\n", clkgen->name,
+		       sol->rate);
 		return FAILURE;
 
 	} else {
-		printf("%s: MMCM-PLL locked (%"PRIu32" Hz)\n", clkgen->name, rate);
+		printf("%s: MMCM-PLL locked (%"PRIu32" Hz)\n", clkgen->name,
+		       sol->rate);
 	}
 
 	return SUCCESS;
 }
 
+/**
+ * @brief axi_clkgen_set_rate
+ */
+int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen,
+			    uint32_t rate)
+{
+	struct axi_clkgen_solution sol;
+
+	if (clkgen->parent_rate == 0 || rate == 0)
+		return 0;
+
+	if (axi_clkgen_solve(clkgen, clkgen->parent_rate, rate, &sol) != SUCCESS)
+		return 0;
+
+	return axi_clkgen_set_solution(clkgen, &sol);
+}
+
 /**
  * @brief axi_clkgen_get_rate
  */
@@ -533,6 +664,9 @@ int32_t axi_clkgen_init(struct axi_clkgen **clk,
 	clkgen->base = init->base;
 	clkgen->name = init->name;
 	clkgen->parent_rate = init->parent_rate;
+	clkgen->ranges_valid = false;
+	clkgen->cache_len = 0;
+	clkgen->cache_next = 0;
 
 	*clk = clkgen;
 
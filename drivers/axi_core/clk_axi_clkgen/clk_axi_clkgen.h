@@ -43,14 +43,48 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Number of recently solved (input, output) rate pairs kept per instance */
+#ifndef AXI_CLKGEN_CACHE_SIZE
+#define AXI_CLKGEN_CACHE_SIZE	4
+#endif
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
+struct axi_clkgen_solution {
+	/* Input rate (Hz) */
+	uint32_t	fin;
+	/* Requested output rate (Hz) */
+	uint32_t	fout;
+	/* Input divider, 0 if no solution exists */
+	uint32_t	d;
+	/* Feedback multiplier */
+	uint32_t	m;
+	/* Output divider */
+	uint32_t	dout;
+	/* Achieved output rate (Hz) */
+	uint32_t	rate;
+	/* Achieved minus requested rate (Hz) */
+	int32_t		error;
+};
+
 struct axi_clkgen {
 	const char	*name;
 	uint32_t	base;
 	uint32_t	parent_rate;
+	bool		ranges_valid;
+	uint32_t	fpfd_min;
+	uint32_t	fpfd_max;
+	uint32_t	fvco_min;
+	uint32_t	fvco_max;
+	struct axi_clkgen_solution	cache[AXI_CLKGEN_CACHE_SIZE];
+	uint32_t	cache_len;
+	uint32_t	cache_next;
 };
 
 struct axi_clkgen_init {
@@ -62,6 +96,12 @@ struct axi_clkgen_init {
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
+int32_t axi_clkgen_solve(struct axi_clkgen *clkgen, uint32_t fin,
+			 uint32_t fout, struct axi_clkgen_solution *sol);
+int32_t axi_clkgen_plan(struct axi_clkgen *clkgen, const uint32_t *rates,
+			uint32_t nb_rates, struct axi_clkgen_solution *plan);
+int32_t axi_clkgen_set_solution(struct axi_clkgen *clkgen,
+				const struct axi_clkgen_solution *sol);
 int32_t axi_clkgen_set_rate(struct axi_clkgen *clkgen, uint32_t rate);
 int32_t axi_clkgen_get_rate(struct axi_clkgen *clkgen, uint32_t *rate);
 int32_t axi_clkgen_init(struct axi_clkgen **clk,
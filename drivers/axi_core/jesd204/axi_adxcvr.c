@@ -81,10 +81,9 @@
 #define ADXCVR_DRP_PORT_ADDR_COMMON		0x00
 #define ADXCVR_DRP_PORT_ADDR_CHANNEL	0x20
 
-#define ADXCVR_DRP_PORT_COMMON(x)		(x)
-#define ADXCVR_DRP_PORT_CHANNEL(x)		(0x100 + (x))
-
-#define ADXCVR_BROADCAST				0xff
+#ifndef ADXCVR_DRP_TIMEOUT_US
+#define ADXCVR_DRP_TIMEOUT_US		20000
+#endif
 
 /**
  * @brief adxcvr_write
@@ -117,14 +116,15 @@ int32_t adxcvr_drp_wait_idle(struct adxcvr *xcvr,
 			     uint32_t drp_addr)
 {
 	uint32_t val;
-	int32_t timeout = 20;
+	int32_t timeout = ADXCVR_DRP_TIMEOUT_US;
 
+	/* A DRP access takes a few DRP clock cycles, spin instead of sleeping */
 	do {
 		adxcvr_read(xcvr, ADXCVR_REG_DRP_STATUS(drp_addr), &val);
 		if (!(val & ADXCVR_DRP_STATUS_BUSY))
 			return ADXCVR_DRP_STATUS_RDATA(val);
 
-		mdelay(1);
+		udelay(1);
 	} while (timeout--);
 
 	printf("%s: %s: Timeout!", xcvr->name, __func__);
@@ -149,6 +149,9 @@ int32_t adxcvr_drp_read(struct adxcvr *xcvr,
 		drp_addr = ADXCVR_DRP_PORT_ADDR_CHANNEL;
 
 	drp_sel = drp_port & 0xFF;
+	/* A broadcast read returns the first lane only, lanes may differ */
+	if (drp_sel == ADXCVR_BROADCAST)
+		drp_sel = 0;
 
 	adxcvr_write(xcvr, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
 	adxcvr_write(xcvr, ADXCVR_REG_DRP_CTRL(drp_addr), ADXCVR_DRP_CTRL_ADDR(reg));
@@ -215,6 +218,7 @@ int32_t adxcvr_clk_set_rate(struct adxcvr *xcvr,
 	if (ret < 0)
 		return ret;
 
+	/* Masked updates are read-modify-write, keep them per lane */
 	for (i = 0; i < xcvr->num_lanes; i++) {
 
 		if (xcvr->cpll_enable)
@@ -329,7 +333,6 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 {
 	struct adxcvr *xcvr;
 	uint32_t synth_conf, xcvr_type;
-	uint32_t i;
 	int32_t ret;
 
 	xcvr = (struct adxcvr *)malloc(sizeof(*xcvr));
@@ -342,6 +345,7 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 	xcvr->out_clk_sel = init->out_clk_sel;
 	xcvr->cpll_enable = init->cpll_enable;
 	xcvr->lpm_enable = init->lpm_enable;
+	xcvr->xlx_xcvr.drp_verify = init->drp_verify;
 
 	xcvr->lane_rate_khz = init->lane_rate_khz;
 	xcvr->ref_rate_khz = init->ref_rate_khz;
@@ -400,13 +404,11 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 
 	xcvr->xlx_xcvr.ad_xcvr = xcvr;
 
-	if (!xcvr->tx_enable) {
-		for (i = 0; i < xcvr->num_lanes; i++) {
-			xilinx_xcvr_configure_lpm_dfe_mode(&xcvr->xlx_xcvr,
-							   ADXCVR_DRP_PORT_CHANNEL(i),
-							   xcvr->lpm_enable);
-		}
-	}
+	/* A full register write, the same on every lane */
+	if (!xcvr->tx_enable)
+		xilinx_xcvr_configure_lpm_dfe_mode(&xcvr->xlx_xcvr,
+						   ADXCVR_DRP_PORT_CHANNEL(ADXCVR_BROADCAST),
+						   xcvr->lpm_enable);
 
 	if (xcvr->lane_rate_khz && xcvr->ref_rate_khz) {
 		ret = adxcvr_clk_set_rate(xcvr, xcvr->lane_rate_khz, xcvr->ref_rate_khz);
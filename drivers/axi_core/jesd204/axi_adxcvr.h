@@ -46,6 +46,14 @@
 #include <stdbool.h>
 #include "xilinx_transceiver.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADXCVR_DRP_PORT_COMMON(x)	(x)
+#define ADXCVR_DRP_PORT_CHANNEL(x)	(0x100 + (x))
+
+#define ADXCVR_BROADCAST		0xff
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -70,6 +78,8 @@ struct adxcvr_init {
 	uint32_t out_clk_sel;
 	bool cpll_enable;
 	bool lpm_enable;
+	/** Read back and check every DRP write */
+	bool drp_verify;
 	uint32_t lane_rate_khz;
 	uint32_t ref_rate_khz;
 };
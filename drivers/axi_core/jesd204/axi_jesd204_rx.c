@@ -180,20 +180,23 @@ int32_t axi_jesd204_rx_lane_clk_disable(struct axi_jesd204_rx *jesd)
 }
 
 /**
- * @brief axi_jesd204_rx_status_read
+ * @brief Read the link status.
+ * @param jesd - The device structure.
+ * @param status - The link status.
+ * @return SUCCESS in case of success, FAILURE otherwise.
  */
-uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
+int32_t axi_jesd204_rx_status_get(struct axi_jesd204_rx *jesd,
+				  struct jesd204_rx_status *status)
 {
 	uint32_t link_disabled;
 	uint32_t link_status;
 	uint32_t sysref_status;
 	uint32_t clock_ratio;
-	uint32_t clock_rate;
-	uint32_t link_rate;
 	uint32_t sysref_config;
 	uint32_t link_config0;
-	uint32_t lmfc_rate;
-	const char *l_status;
+
+	if (!jesd || !status)
+		return FAILURE;
 
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATE, &link_disabled);
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATUS, &link_status);
@@ -202,59 +205,84 @@ uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_SYSREF_CONF, &sysref_config);
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CONF0, &link_config0);
 
+	status->link_disabled = link_disabled & 0x1;
+	status->ext_reset = link_disabled & 0x2;
+	status->link_state = link_status & 0x3;
+	status->sysref_enabled =
+		!(sysref_config & JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE);
+	status->sysref_captured = status->sysref_enabled && (sysref_status & 1);
+	status->sysref_align_error = status->sysref_enabled &&
+				     (sysref_status & 2);
+	status->measured_link_clk_khz = clock_ratio ?
+					DIV_ROUND_CLOSEST_ULL(100000ULL * clock_ratio,
+							1ULL << 16) : 0;
+
+	status->lane_rate_khz = jesd->lane_clk_khz;
+	if (jesd->encoder == JESD204_RX_ENCODER_64B66B) {
+		status->link_rate_khz = DIV_ROUND_CLOSEST(jesd->lane_clk_khz, 66);
+		status->lmfc_rate_khz = (jesd->lane_clk_khz * 8) /
+					(66 * ((link_config0 & 0xFF) + 1));
+	} else {
+		status->link_rate_khz = DIV_ROUND_CLOSEST(jesd->lane_clk_khz, 40);
+		status->lmfc_rate_khz = jesd->lane_clk_khz /
+					(10 * ((link_config0 & 0xFF) + 1));
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_rx_status_read
+ */
+uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd)
+{
+	struct jesd204_rx_status status;
+	uint32_t clock_rate;
+	const char *l_status;
+
+	axi_jesd204_rx_status_get(jesd, &status);
+
 	printf("%s status:\n", jesd->name);
 
-	printf("\tLink is %s\n", (link_disabled & 0x1) ? "disabled" : "enabled");
+	printf("\tLink is %s\n", status.link_disabled ? "disabled" : "enabled");
 
-	if (clock_ratio == 0) {
+	clock_rate = status.measured_link_clk_khz;
+	if (clock_rate == 0)
 		printf("\tMeasured Link Clock: off\n");
-	} else {
-		clock_rate = DIV_ROUND_CLOSEST_ULL(100000ULL * clock_ratio,
-						   1ULL << 16);
+	else
 		printf("\tMeasured Link Clock: %"PRIu32".%.3"PRIu32" MHz\n",\
 		       clock_rate / 1000, clock_rate % 1000);
-	}
 
 	clock_rate = jesd->device_clk_khz;
 	printf("\tReported Link Clock: %"PRIu32".%.3"PRIu32" MHz\n",
 	       clock_rate / 1000, clock_rate % 1000);
 
-	if (!link_disabled) {
+	if (!status.link_disabled) {
 		l_status = (jesd->encoder == JESD204_RX_ENCODER_8B10B) ?
-			   axi_jesd204_rx_link_status_label[link_status & 0x3] :
-			   axi_jesd204_rx_link_status_64b66b_l[link_status & 0x3];
-
-		clock_rate = jesd->lane_clk_khz;
-		if (jesd->encoder == JESD204_RX_ENCODER_64B66B) {
-			link_rate = DIV_ROUND_CLOSEST(clock_rate, 66);
-			lmfc_rate = (clock_rate * 8) /
-				    (66 * ((link_config0 & 0xFF) + 1));
-		} else {
-			link_rate = DIV_ROUND_CLOSEST(clock_rate, 40);
-			lmfc_rate = clock_rate /
-				    (10 * ((link_config0 & 0xFF) + 1));
-		}
+			   axi_jesd204_rx_link_status_label[status.link_state] :
+			   axi_jesd204_rx_link_status_64b66b_l[status.link_state];
+
 		printf("\tLane rate: %"PRIu32".%.3"PRIu32" MHz\n"
 		       "\tLane rate / %d: %"PRIu32".%.3"PRIu32" MHz\n"
 		       "\t%s rate: %"PRIu32".%.3"PRIu32" MHz\n",
-		       clock_rate / 1000, clock_rate % 1000,
+		       status.lane_rate_khz / 1000, status.lane_rate_khz % 1000,
 		       (jesd->encoder == JESD204_RX_ENCODER_8B10B) ? 40 : 66,
-		       link_rate / 1000, link_rate % 1000,
+		       status.link_rate_khz / 1000, status.link_rate_khz % 1000,
 		       (jesd->encoder == JESD204_RX_ENCODER_8B10B) ? "LMFC" :
 		       "LEMC",
-		       lmfc_rate / 1000, lmfc_rate % 1000);
+		       status.lmfc_rate_khz / 1000, status.lmfc_rate_khz % 1000);
 
 		printf("\tLink status: %s\n"
 		       "\tSYSREF captured: %s\n"
 		       "\tSYSREF alignment error: %s\n",
 		       l_status,
-		       (sysref_config & JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE) ?
-		       "disabled" : (sysref_status & 1) ? "Yes" : "No",
-		       (sysref_config & JESD204_RX_REG_SYSREF_CONF_SYSREF_DISABLE) ?
-		       "disabled" : (sysref_status & 2) ? "Yes" : "No");
+		       !status.sysref_enabled ?
+		       "disabled" : status.sysref_captured ? "Yes" : "No",
+		       !status.sysref_enabled ?
+		       "disabled" : status.sysref_align_error ? "Yes" : "No");
 	} else {
 		printf("\tExternal reset is %s\n",
-		       (link_disabled & 0x2) ? "asserted" : "deasserted");
+		       status.ext_reset ? "asserted" : "deasserted");
 	}
 
 	return SUCCESS;
@@ -269,6 +297,51 @@ int32_t axi_jesd204_rx_get_lane_errors(struct axi_jesd204_rx *jesd,
 	return axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_ERRORS(lane), errors);
 }
 
+/**
+ * @brief Read the status of a lane.
+ * @param jesd - The device structure.
+ * @param lane - The lane index.
+ * @param status - The lane status.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_jesd204_rx_lane_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t lane,
+				       struct jesd204_rx_lane_status *status)
+{
+	uint32_t octets_per_multiframe;
+	uint32_t lane_status;
+	uint32_t lane_latency;
+
+	if (!jesd || !status || lane >= jesd->num_lanes)
+		return FAILURE;
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(lane), &lane_status);
+
+	status->cgs_state = lane_status & 0x3;
+	status->ifs_ready = lane_status & BIT(4);
+	status->ilas_ready = lane_status & BIT(5);
+	status->emb_state = JESD204_EMB_STATE_GET(lane_status);
+	status->latency_multiframes = 0;
+	status->latency_octets = 0;
+	status->errors = 0;
+
+	if (PCORE_VERSION_MINOR(jesd->version) >= 2)
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_ERRORS(lane),
+				    &status->errors);
+
+	if (jesd->encoder == JESD204_RX_ENCODER_8B10B && status->ifs_ready) {
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CONF0,
+				    &octets_per_multiframe);
+		octets_per_multiframe = (octets_per_multiframe & 0xffff) + 1;
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_LATENCY(lane),
+				    &lane_latency);
+		status->latency_multiframes = lane_latency / octets_per_multiframe;
+		status->latency_octets = lane_latency % octets_per_multiframe;
+	}
+
+	return SUCCESS;
+}
+
 /**
  * @brief axi_jesd204_rx_laneinfo_8b10b_read
  */
@@ -276,33 +349,26 @@ static int32_t axi_jesd204_rx_laneinfo_8b10b_read(struct axi_jesd204_rx *jesd,
 		uint32_t lane,
 		uint32_t lane_status)
 {
-	uint32_t octets_per_multiframe;
-	uint32_t lane_latency;
+	struct jesd204_rx_lane_status status;
 	uint32_t val[4];
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(lane), &lane_status);
+	axi_jesd204_rx_lane_status_get(jesd, lane, &status);
 
 	printf("\tCGS state: %s\n",
-	       axi_jesd204_rx_lane_status_label[lane_status & 0x3]);
+	       axi_jesd204_rx_lane_status_label[status.cgs_state]);
 
 	printf("\tInitial Frame Synchronization: %s\n",
-	       (lane_status & BIT(4)) ? "Yes" : "No");
-	if (!(lane_status & BIT(4)))
+	       status.ifs_ready ? "Yes" : "No");
+	if (!status.ifs_ready)
 		return FAILURE;
 
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_CONF0, &octets_per_multiframe);
-	octets_per_multiframe &= 0xffff;
-	octets_per_multiframe += 1;
-
-	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_LATENCY(lane), &lane_latency);
 	printf("\tLane Latency: %"PRIu32" Multi-frames and %"PRIu32" Octets\n",
-	       lane_latency / octets_per_multiframe,
-	       lane_latency % octets_per_multiframe);
+	       status.latency_multiframes, status.latency_octets);
 
 	printf("\tInitial Lane Alignment Sequence: %s\n",
-	       (lane_status & BIT(5)) ? "Yes" : "No");
+	       status.ilas_ready ? "Yes" : "No");
 
-	if (!(lane_status & BIT(5)))
+	if (!status.ilas_ready)
 		return FAILURE;
 
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_ILAS(lane, 0), &val[0]);
@@ -392,6 +458,35 @@ int32_t axi_jesd204_rx_laneinfo_read(struct axi_jesd204_rx *jesd, uint32_t lane)
 	return SUCCESS;
 }
 
+/**
+ * @brief Check whether a lane lost its alignment.
+ */
+static bool axi_jesd204_rx_lane_desynced(struct axi_jesd204_rx *jesd,
+		uint32_t lane_status)
+{
+	uint32_t state;
+
+	if (jesd->encoder == JESD204_RX_ENCODER_8B10B)
+		return (lane_status & 0x3) == 0x0;
+
+	state = JESD204_EMB_STATE_GET(lane_status);
+
+	return !(state > JESD204_EMB_STATE_INIT &&
+		 state <= JESD204_EMB_STATE_LOCK);
+}
+
+/**
+ * @brief Restart the link.
+ */
+static int32_t axi_jesd204_rx_relink(struct axi_jesd204_rx *jesd)
+{
+	axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x1);
+	mdelay(100);
+	axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
+
+	return SUCCESS;
+}
+
 /**
  * @brief axi_jesd204_rx_check_lane_status
  */
@@ -404,16 +499,8 @@ bool axi_jesd204_rx_check_lane_status(struct axi_jesd204_rx *jesd,
 
 	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(lane), &status);
 
-	if (jesd->encoder == JESD204_RX_ENCODER_8B10B) {
-		status &= 0x3;
-		if (status != 0x0)
-			return false;
-	} else {
-		status = JESD204_EMB_STATE_GET(status);
-		if (status > JESD204_EMB_STATE_INIT &&
-		    status <= JESD204_EMB_STATE_LOCK)
-			return false;
-	}
+	if (!axi_jesd204_rx_lane_desynced(jesd, status))
+		return false;
 
 	if (PCORE_VERSION_MINOR(jesd->version) >= 2) {
 		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_ERRORS(lane), &errors);
@@ -445,16 +532,177 @@ int32_t axi_jesd204_rx_watchdog(struct axi_jesd204_rx *jesd)
 		for (i = 0; i < jesd->num_lanes; i++)
 			restart |= axi_jesd204_rx_check_lane_status(jesd, i);
 
-		if (restart) {
-			axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x1);
-			mdelay(100);
-			axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
-		}
+		if (restart)
+			axi_jesd204_rx_relink(jesd);
 	}
 
 	return SUCCESS;
 }
 
+/**
+ * @brief Initialize a link monitor.
+ * @param monitor - The link monitor.
+ * @param init - The initialization parameters.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_jesd204_rx_monitor_init(struct jesd204_rx_monitor **monitor,
+				    const struct jesd204_rx_monitor_init *init)
+{
+	struct jesd204_rx_monitor *mon;
+
+	if (!monitor || !init || !init->jesd)
+		return FAILURE;
+
+	mon = (struct jesd204_rx_monitor *)calloc(1, sizeof(*mon));
+	if (!mon)
+		return FAILURE;
+
+	mon->lane_errors = (uint32_t *)calloc(init->jesd->num_lanes,
+					      sizeof(*mon->lane_errors));
+	if (!mon->lane_errors) {
+		free(mon);
+		return FAILURE;
+	}
+
+	mon->jesd = init->jesd;
+	mon->relink = init->relink;
+	mon->ctx = init->ctx;
+	mon->error_threshold = init->error_threshold;
+
+	*monitor = mon;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by axi_jesd204_rx_monitor_init().
+ * @param mon - The link monitor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_jesd204_rx_monitor_remove(struct jesd204_rx_monitor *mon)
+{
+	if (!mon)
+		return FAILURE;
+
+	/* Don't leave the link disabled halfway through a relink */
+	if (mon->relink_pending)
+		axi_jesd204_rx_write(mon->jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
+
+	free(mon->lane_errors);
+	free(mon);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Check the link health, meant to be called periodically.
+ *
+ * Nothing is reported while the link is disabled by software, see
+ * axi_jesd204_rx_lane_clk_disable(). Otherwise, only the link state is read
+ * while the link is down. Once in DATA, the status and the error counter of
+ * each lane are read and the counters are compared with the previous call.
+ * The link is restarted when it drops out of DATA, when a lane loses alignment
+ * or when at least error_threshold errors are counted in a single call.
+ * The restart goes through the relink callback if any. Otherwise the link is
+ * disabled and the next call enables it again, so the call never blocks and
+ * the link stays disabled for one poll period.
+ * @param mon - The link monitor.
+ * @param events - JESD204_RX_MON_* events seen during this call, optional.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t axi_jesd204_rx_monitor_poll(struct jesd204_rx_monitor *mon,
+				    uint32_t *events)
+{
+	struct axi_jesd204_rx *jesd = mon->jesd;
+	uint32_t link_disabled;
+	uint32_t link_status;
+	uint32_t lane_status;
+	uint32_t errors;
+	uint32_t delta = 0;
+	uint32_t ev = 0;
+	bool link_up;
+	bool rebase;
+	uint32_t i;
+	int32_t ret = SUCCESS;
+
+	/* Second half of a restart started by the previous call */
+	if (mon->relink_pending) {
+		axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE, 0x0);
+		mon->relink_pending = false;
+		if (events)
+			*events = 0;
+		return SUCCESS;
+	}
+
+	/* A link disabled by software is neither down nor to be restarted */
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_DISABLE, &link_disabled);
+	if (link_disabled & 0x1) {
+		mon->link_up = false;
+		if (events)
+			*events = 0;
+		return SUCCESS;
+	}
+
+	axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATE, &link_disabled);
+	if (link_disabled) {
+		link_up = false;
+	} else {
+		axi_jesd204_rx_read(jesd, JESD204_RX_REG_LINK_STATUS, &link_status);
+		link_up = (link_status & 0x3) == 3;
+	}
+
+	if (mon->link_up && !link_up) {
+		ev |= JESD204_RX_MON_LINK_DOWN;
+		mon->nb_link_drops++;
+	} else if (!mon->link_up && link_up) {
+		ev |= JESD204_RX_MON_LINK_UP;
+	}
+	rebase = !mon->link_up;
+	mon->link_up = link_up;
+
+	if (link_up) {
+		for (i = 0; i < jesd->num_lanes; i++) {
+			axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_STATUS(i),
+					    &lane_status);
+			if (axi_jesd204_rx_lane_desynced(jesd, lane_status))
+				ev |= JESD204_RX_MON_LANE_DESYNC;
+
+			if (PCORE_VERSION_MINOR(jesd->version) < 2)
+				continue;
+
+			axi_jesd204_rx_read(jesd, JESD204_RX_REG_LANE_ERRORS(i),
+					    &errors);
+			if (!rebase)
+				delta += errors - mon->lane_errors[i];
+			mon->lane_errors[i] = errors;
+		}
+	}
+
+	if (delta) {
+		ev |= JESD204_RX_MON_LANE_ERRORS;
+		mon->total_errors += delta;
+	}
+
+	if ((ev & (JESD204_RX_MON_LINK_DOWN | JESD204_RX_MON_LANE_DESYNC)) ||
+	    (mon->error_threshold && delta >= mon->error_threshold)) {
+		if (mon->relink) {
+			ret = mon->relink(mon->ctx, jesd, ev);
+		} else {
+			axi_jesd204_rx_write(jesd, JESD204_RX_REG_LINK_DISABLE,
+					     0x1);
+			mon->relink_pending = true;
+		}
+		ev |= JESD204_RX_MON_RELINK;
+		mon->nb_relinks++;
+		mon->link_up = false;
+	}
+
+	if (events)
+		*events = ev;
+
+	return ret;
+}
+
 /**
  * @brief axi_jesd204_rx_apply_config
  */
@@ -44,6 +44,16 @@
 /******************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include "util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define JESD204_RX_MON_LINK_DOWN	BIT(0)
+#define JESD204_RX_MON_LINK_UP		BIT(1)
+#define JESD204_RX_MON_LANE_DESYNC	BIT(2)
+#define JESD204_RX_MON_LANE_ERRORS	BIT(3)
+#define JESD204_RX_MON_RELINK		BIT(4)
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -84,15 +94,99 @@ struct jesd204_rx_init {
 	uint32_t lane_clk_khz;
 };
 
+/**
+ * @struct jesd204_rx_status
+ * @brief Link status.
+ */
+struct jesd204_rx_status {
+	/** Link disabled by software */
+	bool link_disabled;
+	/** External reset asserted */
+	bool ext_reset;
+	/** RESET, WAIT FOR PHY, CGS, DATA (8b10b) or
+	 *  RESET, WAIT_BS, BLOCK_SYNC, DATA (64b66b) */
+	uint32_t link_state;
+	bool sysref_enabled;
+	bool sysref_captured;
+	bool sysref_align_error;
+	/** Measured link clock, 0 if off */
+	uint32_t measured_link_clk_khz;
+	uint32_t lane_rate_khz;
+	uint32_t link_rate_khz;
+	/** LMFC (8b10b) or LEMC (64b66b) rate */
+	uint32_t lmfc_rate_khz;
+};
+
+/**
+ * @struct jesd204_rx_lane_status
+ * @brief Lane status.
+ */
+struct jesd204_rx_lane_status {
+	/** INIT, CHECK, DATA (8b10b) */
+	uint32_t cgs_state;
+	/** Initial frame synchronization done (8b10b) */
+	bool ifs_ready;
+	/** Initial lane alignment sequence done (8b10b) */
+	bool ilas_ready;
+	/** Extended multiblock alignment state (64b66b) */
+	uint32_t emb_state;
+	/** Lane latency (8b10b, valid after the frame synchronization) */
+	uint32_t latency_multiframes;
+	uint32_t latency_octets;
+	/** Error counter, 0 on cores older than 1.2 */
+	uint32_t errors;
+};
+
+/**
+ * @struct jesd204_rx_monitor
+ * @brief Link monitor, see axi_jesd204_rx_monitor_poll().
+ */
+struct jesd204_rx_monitor {
+	struct axi_jesd204_rx *jesd;
+	/** Link restart callback. If NULL, the link is disabled and re-enabled
+	 *  by the next poll */
+	int32_t (*relink)(void *ctx, struct axi_jesd204_rx *jesd,
+			  uint32_t events);
+	void *ctx;
+	/** Errors per poll that trigger a restart, 0 to disable */
+	uint32_t error_threshold;
+	bool link_up;
+	/** Link disabled by the monitor, to be re-enabled by the next poll */
+	bool relink_pending;
+	/** Last read error counter of each lane */
+	uint32_t *lane_errors;
+	uint32_t total_errors;
+	uint32_t nb_link_drops;
+	uint32_t nb_relinks;
+};
+
+struct jesd204_rx_monitor_init {
+	struct axi_jesd204_rx *jesd;
+	int32_t (*relink)(void *ctx, struct axi_jesd204_rx *jesd,
+			  uint32_t events);
+	void *ctx;
+	uint32_t error_threshold;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 int32_t axi_jesd204_rx_lane_clk_enable(struct axi_jesd204_rx *jesd);
 int32_t axi_jesd204_rx_lane_clk_disable(struct axi_jesd204_rx *jesd);
 uint32_t axi_jesd204_rx_status_read(struct axi_jesd204_rx *jesd);
+int32_t axi_jesd204_rx_status_get(struct axi_jesd204_rx *jesd,
+				  struct jesd204_rx_status *status);
+int32_t axi_jesd204_rx_lane_status_get(struct axi_jesd204_rx *jesd,
+				       uint32_t lane,
+				       struct jesd204_rx_lane_status *status);
 int32_t axi_jesd204_rx_laneinfo_read(struct axi_jesd204_rx *jesd,
 				     uint32_t lane);
 int32_t axi_jesd204_rx_watchdog(struct axi_jesd204_rx *jesd);
+int32_t axi_jesd204_rx_monitor_init(struct jesd204_rx_monitor **monitor,
+				    const struct jesd204_rx_monitor_init *init);
+int32_t axi_jesd204_rx_monitor_remove(struct jesd204_rx_monitor *mon);
+int32_t axi_jesd204_rx_monitor_poll(struct jesd204_rx_monitor *mon,
+				    uint32_t *events);
 int32_t axi_jesd204_rx_init(struct axi_jesd204_rx **jesd204,
 			    const struct jesd204_rx_init *init);
 int32_t axi_jesd204_rx_remove(struct axi_jesd204_rx *jesd);
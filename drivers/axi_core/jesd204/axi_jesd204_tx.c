@@ -137,20 +137,23 @@ int32_t axi_jesd204_tx_lane_clk_disable(struct axi_jesd204_tx *jesd)
 }
 
 /**
- * @brief axi_jesd204_tx_status_read
+ * @brief Read the link status.
+ * @param jesd - The device structure.
+ * @param status - The link status.
+ * @return SUCCESS in case of success, FAILURE otherwise.
  */
-uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd)
+int32_t axi_jesd204_tx_status_get(struct axi_jesd204_tx *jesd,
+				  struct jesd204_tx_status *status)
 {
 	uint32_t link_disabled;
 	uint32_t link_status;
 	uint32_t sysref_status;
 	uint32_t clock_ratio;
-	uint32_t clock_rate;
-	uint32_t link_rate;
 	uint32_t sysref_config;
 	uint32_t link_config0;
-	uint32_t lmfc_rate;
-	const char *status;
+
+	if (!jesd || !status)
+		return FAILURE;
 
 	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_STATE, &link_disabled);
 	axi_jesd204_tx_read(jesd, JESD204_TX_REG_LINK_STATUS, &link_status);
@@ -159,61 +162,84 @@ uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd)
 	axi_jesd204_tx_read(jesd, JESD204_TX_REG_SYSREF_CONF, &sysref_config);
 	axi_jesd204_tx_read(jesd, JESD204_TX_REG_CONF0, &link_config0);
 
+	status->link_disabled = link_disabled & 0x1;
+	status->ext_reset = link_disabled & 0x2;
+	status->link_state = link_status & 0x3;
+	status->sync_deasserted = link_status & 0x10;
+	status->sysref_enabled =
+		!(sysref_config & JESD204_TX_REG_SYSREF_CONF_SYSREF_DISABLE);
+	status->sysref_captured = status->sysref_enabled && (sysref_status & 1);
+	status->sysref_align_error = status->sysref_enabled &&
+				     (sysref_status & 2);
+	status->measured_link_clk_khz = clock_ratio ?
+					DIV_ROUND_CLOSEST_ULL(100000ULL * clock_ratio,
+							1ULL << 16) : 0;
+
+	status->lane_rate_khz = jesd->lane_clk_khz;
+	if (jesd->encoder == JESD204_TX_ENCODER_64B66B) {
+		status->link_rate_khz = DIV_ROUND_CLOSEST(jesd->lane_clk_khz, 66);
+		status->lmfc_rate_khz = (jesd->lane_clk_khz * 8) /
+					(66 * ((link_config0 & 0xFF) + 1));
+	} else {
+		status->link_rate_khz = DIV_ROUND_CLOSEST(jesd->lane_clk_khz, 40);
+		status->lmfc_rate_khz = jesd->lane_clk_khz /
+					(10 * ((link_config0 & 0xFF) + 1));
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief axi_jesd204_tx_status_read
+ */
+uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd)
+{
+	struct jesd204_tx_status status;
+	uint32_t clock_rate;
+
+	axi_jesd204_tx_status_get(jesd, &status);
+
 	printf("%s status:\n", jesd->name);
 
-	printf("\tLink is %s\n", (link_disabled & 0x1) ? "disabled" : "enabled");
+	printf("\tLink is %s\n", status.link_disabled ? "disabled" : "enabled");
 
-	if (clock_ratio == 0) {
+	clock_rate = status.measured_link_clk_khz;
+	if (clock_rate == 0)
 		printf("\tMeasured Link Clock: off\n");
-	} else {
-		clock_rate = DIV_ROUND_CLOSEST_ULL(100000ULL * clock_ratio,
-						   1ULL << 16);
+	else
 		printf("\tMeasured Link Clock: %"PRIu32".%.3"PRIu32" MHz\n",\
 		       clock_rate / 1000, clock_rate % 1000);
-	}
 
 	clock_rate = jesd->device_clk_khz;
 	printf("\tReported Link Clock: %"PRIu32".%.3"PRIu32" MHz\n",
 	       clock_rate / 1000, clock_rate % 1000);
 
-	if (!link_disabled) {
-		status = (link_status & 0x10) ?
-			 "\tSYNC~: deasserted\n" : "\tSYNC~: asserted\n";
-
-		clock_rate = jesd->lane_clk_khz;
-		if (jesd->encoder == JESD204_TX_ENCODER_64B66B) {
-			link_rate = DIV_ROUND_CLOSEST(clock_rate, 66);
-			lmfc_rate = (clock_rate * 8) /
-				    (66 * ((link_config0 & 0xFF) + 1));
-		} else {
-			link_rate = DIV_ROUND_CLOSEST(clock_rate, 40);
-			lmfc_rate = clock_rate /
-				    (10 * ((link_config0 & 0xFF) + 1));
-		}
+	if (!status.link_disabled) {
 		printf("\tLane rate: %"PRIu32".%.3"PRIu32" MHz\n"
 		       "\tLane rate / %d: %"PRIu32".%.3"PRIu32" MHz\n"
 		       "\t%s rate: %"PRIu32".%.3"PRIu32" MHz\n",
-		       clock_rate / 1000, clock_rate % 1000,
+		       status.lane_rate_khz / 1000, status.lane_rate_khz % 1000,
 		       (jesd->encoder == JESD204_TX_ENCODER_8B10B) ? 40 : 66,
-		       link_rate / 1000, link_rate % 1000,
+		       status.link_rate_khz / 1000, status.link_rate_khz % 1000,
 		       (jesd->encoder == JESD204_TX_ENCODER_8B10B) ? "LMFC" :
 		       "LEMC",
-		       lmfc_rate / 1000, lmfc_rate % 1000);
+		       status.lmfc_rate_khz / 1000, status.lmfc_rate_khz % 1000);
 
 		printf("%s"
 		       "\tLink status: %s\n"
 		       "\tSYSREF captured: %s\n"
 		       "\tSYSREF alignment error: %s\n",
 		       jesd->encoder == JESD204_TX_ENCODER_64B66B ? "" :
-		       status,
-		       axi_jesd204_tx_link_status_label[link_status & 0x3],
-		       (sysref_config & JESD204_TX_REG_SYSREF_CONF_SYSREF_DISABLE) ?
-		       "disabled" : (sysref_status & 1) ? "Yes" : "No",
-		       (sysref_config & JESD204_TX_REG_SYSREF_CONF_SYSREF_DISABLE) ?
-		       "disabled" : (sysref_status & 2) ? "Yes" : "No");
+		       status.sync_deasserted ?
+		       "\tSYNC~: deasserted\n" : "\tSYNC~: asserted\n",
+		       axi_jesd204_tx_link_status_label[status.link_state],
+		       !status.sysref_enabled ?
+		       "disabled" : status.sysref_captured ? "Yes" : "No",
+		       !status.sysref_enabled ?
+		       "disabled" : status.sysref_align_error ? "Yes" : "No");
 	} else {
 		printf("\tExternal reset is %s\n",
-		       (link_disabled & 0x2) ? "asserted" : "deasserted");
+		       status.ext_reset ? "asserted" : "deasserted");
 	}
 
 	return SUCCESS;
@@ -100,12 +100,38 @@ struct jesd204_tx_init {
 	uint32_t lane_clk_khz;
 };
 
+/**
+ * @struct jesd204_tx_status
+ * @brief Link status.
+ */
+struct jesd204_tx_status {
+	/** Link disabled by software */
+	bool link_disabled;
+	/** External reset asserted */
+	bool ext_reset;
+	/** WAIT, CGS, ILAS, DATA */
+	uint32_t link_state;
+	/** SYNC~ deasserted by the receiver (8b10b) */
+	bool sync_deasserted;
+	bool sysref_enabled;
+	bool sysref_captured;
+	bool sysref_align_error;
+	/** Measured link clock, 0 if off */
+	uint32_t measured_link_clk_khz;
+	uint32_t lane_rate_khz;
+	uint32_t link_rate_khz;
+	/** LMFC (8b10b) or LEMC (64b66b) rate */
+	uint32_t lmfc_rate_khz;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 int32_t axi_jesd204_tx_lane_clk_enable(struct axi_jesd204_tx *jesd);
 int32_t axi_jesd204_tx_lane_clk_disable(struct axi_jesd204_tx *jesd);
 uint32_t axi_jesd204_tx_status_read(struct axi_jesd204_tx *jesd);
+int32_t axi_jesd204_tx_status_get(struct axi_jesd204_tx *jesd,
+				  struct jesd204_tx_status *status);
 int32_t axi_jesd204_tx_init(struct axi_jesd204_tx **jesd204,
 			    const struct jesd204_tx_init *init);
 int32_t axi_jesd204_tx_remove(struct axi_jesd204_tx *jesd);
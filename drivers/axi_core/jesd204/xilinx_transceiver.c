@@ -46,6 +46,7 @@
 #include <inttypes.h>
 #include <xil_io.h>
 #include "util.h"
+#include "delay.h"
 #include "error.h"
 #include "axi_adxcvr.h"
 #include "xilinx_transceiver.h"
@@ -107,6 +108,36 @@
 #define TX_CLK25_DIV			0x6a
 #define TX_CLK25_DIV_MASK		0x1f
 
+#define PMA_RSV2_ADDR			0x82
+#define PMA_RSV2_EYESCAN_EN		0x0020
+
+#define ES_QUAL_MASK_ADDR(x)		(0x31 + (x))
+#define ES_SDATA_MASK_ADDR(x)		(0x36 + (x))
+
+#define ES_PRESCALE_VERT_ADDR		0x3b
+#define ES_PRESCALE(x)			(((x) & 0x1f) << 11)
+#define ES_PRESCALE_MASK		0xf800
+#define ES_VERT_OFFSET_MASK		0x01ff
+
+#define ES_HORZ_OFFSET_ADDR		0x3c
+#define ES_HORZ_OFFSET_MASK		0x0fff
+
+#define ES_CONTROL_ADDR			0x3d
+#define ES_CONTROL_RUN			0x0400
+#define ES_ERRDET_EN			0x0200
+#define ES_EYE_SCAN_EN			0x0100
+
+#define ES_ERROR_COUNT_ADDR		0x14f
+#define ES_SAMPLE_COUNT_ADDR		0x150
+#define ES_CONTROL_STATUS_ADDR		0x151
+#define ES_CONTROL_STATUS_DONE		0x0001
+
+#define ES_MAX_DATA_WIDTH		80
+
+#ifndef XILINX_XCVR_ES_TIMEOUT_US
+#define XILINX_XCVR_ES_TIMEOUT_US	1000000
+#endif
+
 /**
  * @brief xilinx_xcvr_write
  */
@@ -146,12 +177,60 @@ int32_t xilinx_xcvr_drp_read(struct xilinx_xcvr *xcvr,
 }
 
 /**
- * @brief xilinx_xcvr_drp_write
+ * @brief Get the ports reached by a DRP port: every lane, or every quad for
+ * common ports, when it is a broadcast port, itself otherwise.
  */
-int32_t xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
-			      uint32_t drp_port, uint32_t reg, uint32_t val)
+static void xilinx_xcvr_drp_ports(struct xilinx_xcvr *xcvr, uint32_t drp_port,
+				  uint32_t *first, uint32_t *last,
+				  uint32_t *step)
 {
+	if ((drp_port & 0xFF) == ADXCVR_BROADCAST) {
+		*first = drp_port & ~0xFF;
+		*last = *first + xcvr->ad_xcvr->num_lanes - 1;
+		/* One common port per quad */
+		*step = *first < ADXCVR_DRP_PORT_CHANNEL(0) ? 4 : 1;
+	} else {
+		*first = drp_port;
+		*last = drp_port;
+		*step = 1;
+	}
+}
+
+/**
+ * @brief Read back a DRP register and compare it with the written value.
+ *
+ * Broadcast writes are checked on every lane.
+ */
+static int32_t xilinx_xcvr_drp_verify(struct xilinx_xcvr *xcvr,
+				      uint32_t drp_port, uint32_t reg, uint32_t val)
+{
+	uint32_t first, last, step, port;
 	uint32_t read_val;
+	int32_t ret = SUCCESS;
+
+	xilinx_xcvr_drp_ports(xcvr, drp_port, &first, &last, &step);
+
+	for (port = first; port <= last; port += step) {
+		if (xilinx_xcvr_drp_read(xcvr, port, reg, &read_val) < 0)
+			return FAILURE;
+		if (read_val != val) {
+			printf("%s: read-write mismatch: port %"PRIu32", reg 0x%"PRIX32","
+			       "val 0x%4"PRIX32", expected val 0x%4"PRIX32"\n",
+			       __func__, port, reg, read_val, val);
+			ret = FAILURE;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Write a DRP register, optionally checking the written value.
+ */
+static int32_t xilinx_xcvr_drp_write_op(struct xilinx_xcvr *xcvr,
+					uint32_t drp_port, uint32_t reg,
+					uint32_t val, bool verify)
+{
 	int32_t ret;
 
 	ret = xilinx_xcvr_write(xcvr, drp_port, reg, val);
@@ -161,11 +240,53 @@ int32_t xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
 		return ret;
 	}
 
-	xilinx_xcvr_drp_read(xcvr, drp_port, reg, &read_val);
-	if (read_val != val)
-		printf("%s: read-write mismatch: reg 0x%"PRIX32","
-		       "val 0x%4"PRIX32", expected val 0x%4"PRIX32"\n",
-		       __func__, reg, val, read_val);
+	if (verify)
+		return xilinx_xcvr_drp_verify(xcvr, drp_port, reg, val);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief xilinx_xcvr_drp_write
+ */
+int32_t xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
+			      uint32_t drp_port, uint32_t reg, uint32_t val)
+{
+	return xilinx_xcvr_drp_write_op(xcvr, drp_port, reg, val,
+					xcvr->drp_verify);
+}
+
+/**
+ * @brief Update the masked bits of a DRP register, optionally checking the
+ * written value.
+ *
+ * A broadcast port can only be used as is for full register writes. The
+ * lanes may hold different values in the unmasked bits, so masked updates
+ * are read-modify-write on each lane.
+ */
+static int32_t xilinx_xcvr_drp_update_op(struct xilinx_xcvr *xcvr,
+		uint32_t drp_port, uint32_t reg,
+		uint32_t mask, uint32_t val, bool verify)
+{
+	uint32_t first, last, step, port;
+	uint32_t read_val;
+	int32_t ret;
+
+	if ((mask & XILINX_XCVR_DRP_MASK_ALL) == XILINX_XCVR_DRP_MASK_ALL)
+		return xilinx_xcvr_drp_write_op(xcvr, drp_port, reg, val, verify);
+
+	xilinx_xcvr_drp_ports(xcvr, drp_port, &first, &last, &step);
+
+	for (port = first; port <= last; port += step) {
+		ret = xilinx_xcvr_drp_read(xcvr, port, reg, &read_val);
+		if (ret < 0)
+			return ret;
+
+		ret = xilinx_xcvr_drp_write_op(xcvr, port, reg,
+					       val | (read_val & ~mask), verify);
+		if (ret < 0)
+			return ret;
+	}
 
 	return SUCCESS;
 }
@@ -176,16 +297,38 @@ int32_t xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
 int32_t xilinx_xcvr_drp_update(struct xilinx_xcvr *xcvr, uint32_t drp_port,
 			       uint32_t reg, uint32_t mask, uint32_t val)
 {
-	uint32_t read_val;
-	int32_t ret;
+	return xilinx_xcvr_drp_update_op(xcvr, drp_port, reg, mask, val,
+					 xcvr->drp_verify);
+}
 
-	ret = xilinx_xcvr_drp_read(xcvr, drp_port, reg, &read_val);
-	if (ret < 0)
-		return ret;
+/**
+ * @brief Execute a list of DRP operations.
+ *
+ * Operations with a partial mask are read-modify-write, on each lane for
+ * broadcast ports, the others are plain writes. Each operation is verified
+ * only if it asks for it.
+ * @param xcvr - The transceiver.
+ * @param ops - The operations, executed in order.
+ * @param nb_ops - Number of operations.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t xilinx_xcvr_drp_batch(struct xilinx_xcvr *xcvr,
+			      const struct xilinx_xcvr_drp_op *ops,
+			      uint32_t nb_ops)
+{
+	uint32_t i;
+	int32_t ret;
 
-	val |= read_val & ~mask;
+	for (i = 0; i < nb_ops; i++) {
+		ret = xilinx_xcvr_drp_update_op(xcvr, ops[i].drp_port,
+						ops[i].reg, ops[i].mask,
+						ops[i].val & ops[i].mask,
+						ops[i].verify);
+		if (ret < 0)
+			return ret;
+	}
 
-	return xilinx_xcvr_drp_write(xcvr, drp_port, reg, val);
+	return SUCCESS;
 }
 
 /**
@@ -291,14 +434,15 @@ int32_t xilinx_xcvr_gtx2_configure_cdr(struct xilinx_xcvr *xcvr,
 		}
 	}
 
-	xilinx_xcvr_drp_write(xcvr, drp_port, RXCDR_CFG0_ADDR, cfg0);
-	xilinx_xcvr_drp_write(xcvr, drp_port, RXCDR_CFG1_ADDR, cfg1);
-	xilinx_xcvr_drp_write(xcvr, drp_port, RXCDR_CFG2_ADDR, cfg2);
-	xilinx_xcvr_drp_write(xcvr, drp_port, RXCDR_CFG3_ADDR, cfg3);
-	xilinx_xcvr_drp_update(xcvr, drp_port, RXCDR_CFG4_ADDR,
-			       RXCDR_CFG4_MASK, cfg4);
+	const struct xilinx_xcvr_drp_op ops[] = {
+		{drp_port, RXCDR_CFG0_ADDR, XILINX_XCVR_DRP_MASK_ALL, cfg0, xcvr->drp_verify},
+		{drp_port, RXCDR_CFG1_ADDR, XILINX_XCVR_DRP_MASK_ALL, cfg1, xcvr->drp_verify},
+		{drp_port, RXCDR_CFG2_ADDR, XILINX_XCVR_DRP_MASK_ALL, cfg2, xcvr->drp_verify},
+		{drp_port, RXCDR_CFG3_ADDR, XILINX_XCVR_DRP_MASK_ALL, cfg3, xcvr->drp_verify},
+		{drp_port, RXCDR_CFG4_ADDR, RXCDR_CFG4_MASK, cfg4, xcvr->drp_verify},
+	};
 
-	return SUCCESS;
+	return xilinx_xcvr_drp_batch(xcvr, ops, ARRAY_SIZE(ops));
 }
 
 /**
@@ -1319,3 +1463,254 @@ int32_t xilinx_xcvr_write_tx_clk25_div(struct xilinx_xcvr *xcvr,
 
 	return xilinx_xcvr_drp_update(xcvr, drp_port, reg, mask, div);
 }
+
+/**
+ * @brief Enable the eye scan circuit of a lane and compare all the bits of
+ *        the data width.
+ *
+ * The PMA of the lane must be reset after PMA_RSV2 changes, with
+ * adxcvr_clk_disable() and adxcvr_clk_enable(), before the lane is scanned.
+ */
+int32_t xilinx_xcvr_eyescan_enable(struct xilinx_xcvr *xcvr,
+				   uint32_t drp_port, uint32_t data_width)
+{
+	uint32_t mask;
+	uint32_t i;
+	int32_t ret;
+
+	if (xcvr->type != XILINX_XCVR_TYPE_S7_GTX2 ||
+	    !data_width || data_width > ES_MAX_DATA_WIDTH)
+		return FAILURE;
+
+	ret = xilinx_xcvr_drp_update(xcvr, drp_port, PMA_RSV2_ADDR,
+				     PMA_RSV2_EYESCAN_EN, PMA_RSV2_EYESCAN_EN);
+	if (ret < 0)
+		return ret;
+
+	/*
+	 * The 80-bit masks are spread MSB first over 5 registers, only the
+	 * lower data_width bits are compared.
+	 */
+	for (i = 0; i < 5; i++) {
+		if (data_width >= 80 - i * 16)
+			mask = 0x0000;
+		else if (data_width <= 64 - i * 16)
+			mask = 0xffff;
+		else
+			mask = 0xffff << (data_width - (64 - i * 16));
+		xilinx_xcvr_drp_write(xcvr, drp_port, ES_SDATA_MASK_ADDR(i),
+				      mask & 0xffff);
+		xilinx_xcvr_drp_write(xcvr, drp_port, ES_QUAL_MASK_ADDR(i), 0xffff);
+	}
+
+	return xilinx_xcvr_drp_update(xcvr, drp_port, ES_CONTROL_ADDR,
+				      ES_CONTROL_RUN | ES_ERRDET_EN | ES_EYE_SCAN_EN,
+				      ES_ERRDET_EN | ES_EYE_SCAN_EN);
+}
+
+/**
+ * @brief Number of points scanned per lane.
+ */
+uint32_t xilinx_xcvr_eyescan_points(const struct xilinx_xcvr_eyescan *es)
+{
+	uint32_t nb_horz, nb_vert;
+
+	if (!es->horz_step || !es->vert_step ||
+	    es->horz_max < es->horz_min || es->vert_max < es->vert_min)
+		return 0;
+
+	nb_horz = (es->horz_max - es->horz_min) / es->horz_step + 1;
+	nb_vert = (es->vert_max - es->vert_min) / es->vert_step + 1;
+
+	return nb_horz * nb_vert;
+}
+
+/**
+ * @brief Number of bits compared for a point.
+ */
+uint64_t xilinx_xcvr_eyescan_bits(const struct xilinx_xcvr_eyescan *es,
+				  const struct xilinx_xcvr_es_point *point)
+{
+	return ((uint64_t)point->samples * es->data_width) <<
+	       (1 + point->prescale);
+}
+
+/**
+ * @brief Start a measurement on a lane.
+ */
+static int32_t xilinx_xcvr_eyescan_start(struct xilinx_xcvr *xcvr,
+		uint32_t drp_port, uint8_t prescale)
+{
+	int32_t ret;
+
+	ret = xilinx_xcvr_drp_update(xcvr, drp_port, ES_PRESCALE_VERT_ADDR,
+				     ES_PRESCALE_MASK, ES_PRESCALE(prescale));
+	if (ret < 0)
+		return ret;
+
+	return xilinx_xcvr_drp_update(xcvr, drp_port, ES_CONTROL_ADDR,
+				      ES_CONTROL_RUN, ES_CONTROL_RUN);
+}
+
+/**
+ * @brief Wait for the end of a measurement and collect the counters.
+ */
+static int32_t xilinx_xcvr_eyescan_collect(struct xilinx_xcvr *xcvr,
+		uint32_t drp_port, struct xilinx_xcvr_es_point *point)
+{
+	uint32_t timeout = XILINX_XCVR_ES_TIMEOUT_US / 10;
+	uint32_t val;
+	int32_t ret;
+
+	do {
+		ret = xilinx_xcvr_drp_read(xcvr, drp_port, ES_CONTROL_STATUS_ADDR,
+					   &val);
+		if (ret < 0)
+			return ret;
+		if (val & ES_CONTROL_STATUS_DONE)
+			break;
+		udelay(10);
+	} while (--timeout);
+
+	if (!timeout)
+		return FAILURE;
+
+	xilinx_xcvr_drp_read(xcvr, drp_port, ES_ERROR_COUNT_ADDR, &val);
+	point->errors = val;
+	xilinx_xcvr_drp_read(xcvr, drp_port, ES_SAMPLE_COUNT_ADDR, &val);
+	point->samples = val;
+
+	return xilinx_xcvr_drp_update(xcvr, drp_port, ES_CONTROL_ADDR,
+				      ES_CONTROL_RUN, 0);
+}
+
+/**
+ * @brief Statistical eye scan of several lanes.
+ *
+ * The lanes are scanned concurrently: each point is started on all the
+ * lanes before the results are collected. A point is first measured with
+ * prescale_start, and measured again with prescale_max only if it saw less
+ * than error_limit errors, so the points outside the eye cost a single
+ * short measurement.
+ *
+ * The scanned lanes must have been enabled by xilinx_xcvr_eyescan_enable()
+ * and reset afterwards, the scan does not reset the PMA itself as that would
+ * drop the link. Only the 7-series GTX2 is supported. On error, the
+ * measurement is stopped on all the scanned lanes.
+ * @param xcvr - The transceiver.
+ * @param es - The scan parameters. The map must hold
+ *             xilinx_xcvr_eyescan_points() entries for each scanned lane,
+ *             stored lane by lane, then row by row (vertical offset), from
+ *             the lowest offsets up.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t xilinx_xcvr_eyescan(struct xilinx_xcvr *xcvr,
+			    const struct xilinx_xcvr_eyescan *es)
+{
+	struct xilinx_xcvr_es_point *point;
+	uint32_t nb_points, nb_lanes;
+	uint32_t pending, lane, n;
+	int32_t horz, vert;
+	uint32_t idx = 0;
+	uint32_t val;
+	int32_t ret;
+
+	if (xcvr->type != XILINX_XCVR_TYPE_S7_GTX2)
+		return FAILURE;
+
+	nb_points = xilinx_xcvr_eyescan_points(es);
+	nb_lanes = hweight32(es->lane_mask);
+	if (!nb_points || !nb_lanes || !es->map ||
+	    es->prescale_start > es->prescale_max || es->prescale_max > 31)
+		return -EINVAL;
+
+	if (xcvr->ad_xcvr->num_lanes < 32 &&
+	    es->lane_mask >> xcvr->ad_xcvr->num_lanes)
+		return -EINVAL;
+
+	/* The vertical offset has a 7 bit magnitude */
+	if (es->vert_min < -127 || es->vert_max > 127)
+		return -EINVAL;
+
+	for (lane = 0; lane < 32; lane++) {
+		if (!(es->lane_mask & BIT(lane)))
+			continue;
+		ret = xilinx_xcvr_drp_read(xcvr, ADXCVR_DRP_PORT_CHANNEL(lane),
+					   PMA_RSV2_ADDR, &val);
+		if (ret < 0)
+			return ret;
+		if (!(val & PMA_RSV2_EYESCAN_EN)) {
+			printf("%s: eye scan not enabled on lane %"PRIu32"\n",
+			       __func__, lane);
+			return FAILURE;
+		}
+	}
+
+	for (vert = es->vert_min; vert <= es->vert_max; vert += es->vert_step) {
+		for (horz = es->horz_min; horz <= es->horz_max;
+		     horz += es->horz_step, idx++) {
+			/* Vertical offset is sign-magnitude, horizontal two's complement */
+			ret = xilinx_xcvr_drp_update(xcvr,
+						     ADXCVR_DRP_PORT_CHANNEL(ADXCVR_BROADCAST),
+						     ES_PRESCALE_VERT_ADDR, ES_VERT_OFFSET_MASK,
+						     (vert < 0 ? BIT(7) : 0) | (abs(vert) & 0x7f));
+			if (ret < 0)
+				goto err;
+
+			ret = xilinx_xcvr_drp_update(xcvr,
+						     ADXCVR_DRP_PORT_CHANNEL(ADXCVR_BROADCAST),
+						     ES_HORZ_OFFSET_ADDR, ES_HORZ_OFFSET_MASK,
+						     horz & ES_HORZ_OFFSET_MASK);
+			if (ret < 0)
+				goto err;
+
+			pending = es->lane_mask;
+			for (n = 0; n < nb_lanes; n++)
+				es->map[n * nb_points + idx].prescale = es->prescale_start;
+
+			while (pending) {
+				for (lane = 0, n = 0; lane < 32; lane++) {
+					if (!(es->lane_mask & BIT(lane)))
+						continue;
+					point = &es->map[n++ * nb_points + idx];
+					if (!(pending & BIT(lane)))
+						continue;
+					ret = xilinx_xcvr_eyescan_start(xcvr,
+									ADXCVR_DRP_PORT_CHANNEL(lane),
+									point->prescale);
+					if (ret < 0)
+						goto err;
+				}
+
+				for (lane = 0, n = 0; lane < 32; lane++) {
+					if (!(es->lane_mask & BIT(lane)))
+						continue;
+					point = &es->map[n++ * nb_points + idx];
+					if (!(pending & BIT(lane)))
+						continue;
+					ret = xilinx_xcvr_eyescan_collect(xcvr,
+									  ADXCVR_DRP_PORT_CHANNEL(lane),
+									  point);
+					if (ret < 0)
+						goto err;
+					if (point->errors >= es->error_limit ||
+					    point->prescale == es->prescale_max)
+						pending &= ~BIT(lane);
+					else
+						point->prescale = es->prescale_max;
+				}
+			}
+		}
+	}
+
+	return SUCCESS;
+
+err:
+	/* Don't leave a measurement running on any of the scanned lanes */
+	for (lane = 0; lane < 32; lane++)
+		if (es->lane_mask & BIT(lane))
+			xilinx_xcvr_drp_update(xcvr, ADXCVR_DRP_PORT_CHANNEL(lane),
+					       ES_CONTROL_ADDR, ES_CONTROL_RUN, 0);
+
+	return ret;
+}
@@ -148,6 +148,27 @@ struct xilinx_xcvr {
 	enum axi_fpga_speed_grade speed_grade;
 	enum axi_fpga_dev_pack dev_package;
 	uint32_t voltage;
+	/** Read back every DRP write, a mismatch fails the write */
+	bool drp_verify;
+};
+
+#define XILINX_XCVR_DRP_MASK_ALL	0xffff
+
+/**
+ * @struct xilinx_xcvr_drp_op
+ * @brief DRP operation, see xilinx_xcvr_drp_batch().
+ */
+struct xilinx_xcvr_drp_op {
+	/** DRP port, may be a broadcast port */
+	uint32_t drp_port;
+	/** Register address */
+	uint32_t reg;
+	/** Bits to be updated, XILINX_XCVR_DRP_MASK_ALL for a plain write */
+	uint32_t mask;
+	/** Register value */
+	uint32_t val;
+	/** Read back and check the written value */
+	bool verify;
 };
 
 struct xilinx_xcvr_cpll_config {
@@ -164,9 +185,50 @@ struct xilinx_xcvr_qpll_config {
 
 #define ENC_8B10B		810
 
+/**
+ * @struct xilinx_xcvr_es_point
+ * @brief Eye scan result of a point.
+ */
+struct xilinx_xcvr_es_point {
+	uint16_t errors;
+	uint16_t samples;
+	/** Prescale of the last measurement */
+	uint8_t prescale;
+};
+
+/**
+ * @struct xilinx_xcvr_eyescan
+ * @brief Eye scan parameters, see xilinx_xcvr_eyescan().
+ */
+struct xilinx_xcvr_eyescan {
+	/** Lanes to be scanned */
+	uint32_t lane_mask;
+	/** Compared bits per sample, 40 for 8b10b with a 4 byte interface */
+	uint32_t data_width;
+	/** Horizontal offsets, in UI / (32 * RXOUT_DIV) */
+	int32_t horz_min;
+	int32_t horz_max;
+	uint32_t horz_step;
+	/** Vertical offsets, -127 to 127 */
+	int32_t vert_min;
+	int32_t vert_max;
+	uint32_t vert_step;
+	/** Prescale of the first, short, measurement of a point */
+	uint8_t prescale_start;
+	/** Prescale of the second measurement of the points that passed */
+	uint8_t prescale_max;
+	/** Errors after which a point is considered failed */
+	uint16_t error_limit;
+	/** Results, lane by lane, see xilinx_xcvr_eyescan_points() */
+	struct xilinx_xcvr_es_point *map;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
+int32_t xilinx_xcvr_drp_batch(struct xilinx_xcvr *xcvr,
+			      const struct xilinx_xcvr_drp_op *ops,
+			      uint32_t nb_ops);
 int32_t xilinx_xcvr_configure_cdr(struct xilinx_xcvr *xcvr,
 				  uint32_t drp_port, uint32_t lane_rate, uint32_t out_div,
 				  bool lpm_enable);
@@ -200,4 +262,11 @@ int32_t xilinx_xcvr_write_rx_clk25_div(struct xilinx_xcvr *xcvr,
 				       uint32_t drp_port, uint32_t div);
 int32_t xilinx_xcvr_write_tx_clk25_div(struct xilinx_xcvr *xcvr,
 				       uint32_t drp_port, uint32_t div);
+int32_t xilinx_xcvr_eyescan_enable(struct xilinx_xcvr *xcvr,
+				   uint32_t drp_port, uint32_t data_width);
+uint32_t xilinx_xcvr_eyescan_points(const struct xilinx_xcvr_eyescan *es);
+uint64_t xilinx_xcvr_eyescan_bits(const struct xilinx_xcvr_eyescan *es,
+				  const struct xilinx_xcvr_es_point *point);
+int32_t xilinx_xcvr_eyescan(struct xilinx_xcvr *xcvr,
+			    const struct xilinx_xcvr_eyescan *es);
 #endif
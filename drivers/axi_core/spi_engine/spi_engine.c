@@ -54,6 +54,7 @@ significant delays */
 #include "axi_dmac.h"
 #include "axi_io.h"
 #include "error.h"
+#include "pool.h"
 #include "spi_engine.h"
 
 /**
@@ -236,7 +237,8 @@ static int32_t spi_engine_queue_new_cmd(struct spi_engine_cmd_queue **fifo,
 {
 	struct spi_engine_cmd_queue *local_fifo;
 
-	local_fifo = (spi_engine_cmd_queue*)malloc(sizeof(*local_fifo));
+	local_fifo = (spi_engine_cmd_queue*)pool_heap_calloc(1,
+			sizeof(*local_fifo));
 
 	if(!local_fifo)
 		return FAILURE;
@@ -310,9 +312,9 @@ static int32_t spi_engine_queue_get_cmd(struct spi_engine_cmd_queue **fifo,
 	*cmd = local_fifo->cmd;
 	if ((*fifo)->next) {
 		*fifo = local_fifo->next;
-		free(local_fifo);
+		pool_heap_free(local_fifo);
 	} else {
-		free(*fifo);
+		pool_heap_free(*fifo);
 		*fifo = NULL;
 	}
 
@@ -330,7 +332,7 @@ static int32_t spi_engine_queue_free(struct spi_engine_cmd_queue **fifo)
 	if(*fifo && (*fifo)->next)
 		spi_engine_queue_free(&(*fifo)->next);
 	if((*fifo) != NULL) {
-		free(*fifo);
+		pool_heap_free(*fifo);
 		*fifo = NULL;
 	}
 
@@ -703,12 +705,15 @@ int32_t spi_engine_write_and_read(struct spi_desc *desc,
 
 	words_number = spi_get_words_number(desc_extra, bytes_number);
 
-	msg.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*msg.cmds));
+	msg.cmds = (spi_engine_cmd_queue*)pool_heap_calloc(1,
+			sizeof(*msg.cmds));
 	if (!msg.cmds)
 		return FAILURE;
 
-	msg.tx_buf =(uint32_t*)calloc(words_number, sizeof(msg.tx_buf[0]));
-	msg.rx_buf =(uint32_t*)calloc(words_number, sizeof(msg.rx_buf[0]));
+	msg.tx_buf =(uint32_t*)pool_heap_calloc(words_number,
+			sizeof(msg.tx_buf[0]));
+	msg.rx_buf =(uint32_t*)pool_heap_calloc(words_number,
+			sizeof(msg.rx_buf[0]));
 	msg.length = words_number;
 
 	/* Get the length of transfered word */
@@ -735,8 +740,8 @@ int32_t spi_engine_write_and_read(struct spi_desc *desc,
 			       ((i) % word_len + 1) * 8);
 
 	spi_engine_queue_free(&msg.cmds);
-	free(msg.tx_buf);
-	free(msg.rx_buf);
+	pool_heap_free(msg.tx_buf);
+	pool_heap_free(msg.rx_buf);
 
 	return ret;
 }
@@ -810,7 +815,8 @@ int32_t spi_engine_offload_transfer(struct spi_desc *desc,
 	eng_desc->offload_tx_len = 0;
 	eng_desc->offload_rx_len = 0;
 
-	transfer.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*transfer.cmds));
+	transfer.cmds = (spi_engine_cmd_queue*)pool_heap_calloc(1,
+			sizeof(*transfer.cmds));
 
 	if (!transfer.cmds)
 		return FAILURE;
@@ -731,16 +731,8 @@ int32_t ad9528_remove(struct ad9528_dev *dev)
 uint32_t ad9528_calc_out_div(uint32_t rate,
 			     uint32_t parent_rate)
 {
-	uint32_t div;
-
-	div = DIV_ROUND_CLOSEST(parent_rate, rate);
-
-	div = clamp_t(unsigned int,
-		      div,
-		      AD9528_CLK_DIST_DIV_MIN,
-		      AD9528_CLK_DIST_DIV_MAX);
-
-	return div;
+	return closest_divider(parent_rate, rate, AD9528_CLK_DIST_DIV_MIN,
+			       AD9528_CLK_DIST_DIV_MAX, AD9528_CLK_DIST_DIV_MAX);
 }
 
 /***************************************************************************//**
@@ -769,11 +761,9 @@ uint32_t ad9528_clk_round_rate(struct ad9528_dev *dev, uint32_t chan,
 		div = ad9528_calc_out_div(rate, freq);
 	} else if (signal_source == AD9528_SYSREF) {
 		freq = dev->ad9528_st.vco_out_freq[AD9528_VCXO] / 2;
-		div = DIV_ROUND_CLOSEST(freq, rate);
-		div = clamp_t(unsigned int,
-			      div,
-			      AD9528_SYSREF_K_DIV_MIN,
-			      AD9528_SYSREF_K_DIV_MAX);
+		div = closest_divider(freq, rate, AD9528_SYSREF_K_DIV_MIN,
+				      AD9528_SYSREF_K_DIV_MAX,
+				      AD9528_SYSREF_K_DIV_MAX);
 	} else {
 		// oops, it seems channels were misconfigured.
 		return 0;
@@ -837,12 +827,10 @@ int32_t ad9528_clk_set_rate(struct ad9528_dev *dev, uint32_t chan,
 	// note that this affects all other SYSREF sourced channels
 	else if (signal_source == AD9528_SYSREF) {
 		// SYSREF Generator is sourced from VCXO with a fixed divider of 2 and a K divider
-		div = DIV_ROUND_CLOSEST(dev->ad9528_st.vco_out_freq[AD9528_VCXO] / 2, rate);
-
-		div = clamp_t(unsigned int,
-			      div,
-			      AD9528_SYSREF_K_DIV_MIN,
-			      AD9528_SYSREF_K_DIV_MAX);
+		div = closest_divider(dev->ad9528_st.vco_out_freq[AD9528_VCXO] / 2,
+				      rate, AD9528_SYSREF_K_DIV_MIN,
+				      AD9528_SYSREF_K_DIV_MAX,
+				      AD9528_SYSREF_K_DIV_MAX);
 
 		// apply the new K divider to hardware.
 		reg = div;
@@ -259,7 +259,7 @@ static int32_t adf4371_write(struct adf4371_dev *dev,
  */
 static int32_t adf4371_write_bulk(struct adf4371_dev *dev,
 				  uint16_t reg,
-				  uint8_t *val,
+				  const uint8_t *val,
 				  uint8_t size)
 {
 	uint8_t buf[10];
@@ -403,19 +403,25 @@ static void adf4371_pll_fract_n_compute(uint64_t vco,
 }
 
 /**
- * Set the output frequency for one channel.
+ * Compute the register image of an output frequency.
  * @param dev - The device structure.
  * @param freq - The output frequency.
  * @param channel - The selected channel.
+ * @param hop - The computed register image.
  * @return SUCCESS in case of success, negative error code otherwise.
  */
-static int32_t adf4371_set_freq(struct adf4371_dev *dev,
-				uint64_t freq,
-				uint32_t channel)
+static int32_t adf4371_hop_compute(struct adf4371_dev *dev,
+				   uint64_t freq,
+				   uint32_t channel,
+				   struct adf4371_hop *hop)
 {
 	uint32_t cp_bleed;
-	uint8_t int_mode = 0;
-	int32_t ret;
+	uint64_t cal_cycles;
+
+	hop->freq = freq;
+	hop->channel = channel;
+	/* RF16 and RF32 keep the RF8 divider, see adf4371_hop_apply() */
+	hop->rf_div_sel = dev->rf_div_sel;
 
 	switch (channel) {
 	case ADF4371_CH_RF8:
@@ -423,11 +429,10 @@ static int32_t adf4371_set_freq(struct adf4371_dev *dev,
 		if (ADF4371_CHECK_RANGE(freq, OUT_RF8_FREQ))
 			return FAILURE;
 
-		dev->rf_div_sel = 0;
-
+		hop->rf_div_sel = 0;
 		while (freq < ADF4371_MIN_VCO_FREQ) {
 			freq <<= 1;
-			dev->rf_div_sel++;
+			hop->rf_div_sel++;
 		}
 		break;
 	case ADF4371_CH_RF16:
@@ -448,59 +453,254 @@ static int32_t adf4371_set_freq(struct adf4371_dev *dev,
 		return FAILURE;
 	}
 
-	adf4371_pll_fract_n_compute(freq, dev->fpfd, &dev->integer, &dev->fract1,
-				    &dev->fract2, &dev->mod2);
-
-	dev->buf[0] = dev->integer >> 8;
-	dev->buf[1] = 0x40; /* REG12 default */
-	dev->buf[2] = 0x00;
-	dev->buf[3] = dev->fract1 & 0xFF;
-	dev->buf[4] = dev->fract1 >> 8;
-	dev->buf[5] = dev->fract1 >> 16;
-	dev->buf[6] = ADF4371_FRAC2WORD_L(dev->fract2 & 0x7F) |
-		      ADF4371_FRAC1WORD(dev->fract1 >> 24);
-	dev->buf[7] = ADF4371_FRAC2WORD_H(dev->fract2 >> 7);
-	dev->buf[8] = dev->mod2 & 0xFF;
-	dev->buf[9] = ADF4371_MOD2WORD(dev->mod2 >> 8);
-
-	ret = adf4371_write_bulk(dev, ADF4371_REG(0x11), dev->buf, 10);
-	if (ret < 0)
-		return ret;
+	adf4371_pll_fract_n_compute(freq, dev->fpfd, &hop->integer, &hop->fract1,
+				    &hop->fract2, &hop->mod2);
+
+	hop->regs[ADF4371_HOP_REG11 + 0] = hop->integer >> 8;
+	hop->regs[ADF4371_HOP_REG11 + 1] = 0x40; /* REG12 default */
+	hop->regs[ADF4371_HOP_REG11 + 2] = 0x00;
+	hop->regs[ADF4371_HOP_REG11 + 3] = hop->fract1 & 0xFF;
+	hop->regs[ADF4371_HOP_REG11 + 4] = hop->fract1 >> 8;
+	hop->regs[ADF4371_HOP_REG11 + 5] = hop->fract1 >> 16;
+	hop->regs[ADF4371_HOP_REG11 + 6] = ADF4371_FRAC2WORD_L(hop->fract2 & 0x7F) |
+					   ADF4371_FRAC1WORD(hop->fract1 >> 24);
+	hop->regs[ADF4371_HOP_REG11 + 7] = ADF4371_FRAC2WORD_H(hop->fract2 >> 7);
+	hop->regs[ADF4371_HOP_REG11 + 8] = hop->mod2 & 0xFF;
+	hop->regs[ADF4371_HOP_REG11 + 9] = ADF4371_MOD2WORD(hop->mod2 >> 8);
 	/*
 	 * The R counter allows the input reference frequency to be
 	 * divided down to produce the reference clock to the PFD
 	 */
-	ret = adf4371_write(dev, ADF4371_REG(0x1F), dev->ref_div_factor);
-	if (ret < 0)
-		return ret;
-
-	ret = adf4371_update(dev, ADF4371_REG(0x24),
-			     ADF4371_RF_DIV_SEL_MSK,
-			     ADF4371_RF_DIV_SEL(dev->rf_div_sel));
-	if (ret < 0)
-		return ret;
-
+	hop->regs[ADF4371_HOP_REG1F] = dev->ref_div_factor;
+	hop->regs[ADF4371_HOP_REG24] = ADF4371_RF_DIV_SEL(hop->rf_div_sel);
 	/*
 	 * The optimum bleed current is set by ((4/N) × ICP)/3.75,
 	 * where ICP is the charge pump current in μA
 	 */
-	cp_bleed = DIV_ROUND_UP(400 * dev->cp_settings.icp, dev->integer * 375);
-	cp_bleed = clamp(cp_bleed, 1U, 255U);
-	ret = adf4371_write(dev, ADF4371_REG(0x26), cp_bleed);
-	if (ret < 0)
-		return ret;
+	cp_bleed = DIV_ROUND_UP(400 * dev->cp_settings.icp, hop->integer * 375);
+	hop->regs[ADF4371_HOP_REG26] = clamp(cp_bleed, 1U, 255U);
 	/*
 	 * Set to 1 when in INT mode (when FRAC1 = FRAC2 = 0),
 	 * and set to 0 when in FRAC mode.
 	 */
-	if (dev->fract1 == 0 && dev->fract2 == 0)
-		int_mode = 0x01;
+	hop->regs[ADF4371_HOP_REG2B] = (hop->fract1 == 0 && hop->fract2 == 0);
+	hop->regs[ADF4371_HOP_REG10] = hop->integer & 0xFF;
+
+	/*
+	 * Autocalibration: 11 band selection steps of TIMEOUT PFD cycles,
+	 * followed by the synthesizer lock and the VCO ALC timeouts.
+	 */
+	cal_cycles = 11ULL * dev->timeout +
+		     ((uint64_t)dev->synth_timeout + dev->vco_alc_timeout) * 1024;
+	cal_cycles = cal_cycles * 1000000 + dev->fpfd - 1;
+	do_div(&cal_cycles, dev->fpfd);
+	hop->settle_us = cal_cycles;
 
-	ret = adf4371_write(dev, ADF4371_REG(0x2B), int_mode);
+	return SUCCESS;
+}
+
+/**
+ * Apply a register image, only the registers that changed since the last
+ * applied image are written.
+ * @param dev - The device structure.
+ * @param hop - The register image.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t adf4371_hop_apply(struct adf4371_dev *dev,
+				 const struct adf4371_hop *hop)
+{
+	static const uint16_t single_regs[] = {
+		[ADF4371_HOP_REG1F] = ADF4371_REG(0x1F),
+		[ADF4371_HOP_REG24] = ADF4371_REG(0x24),
+		[ADF4371_HOP_REG26] = ADF4371_REG(0x26),
+		[ADF4371_HOP_REG2B] = ADF4371_REG(0x2B),
+	};
+	uint8_t *shadow = dev->hop_shadow;
+	bool valid = dev->hop_valid;
+	int32_t first = -1, last = -1;
+	uint32_t rf_div_sel;
+	uint8_t val;
+	int32_t ret;
+	int32_t i;
+
+	/*
+	 * Only RF8 and RFAUX8 go through the RF divider, the other channels
+	 * keep the current one so the RF8 output is left untouched. It is
+	 * taken at apply time as a table may be computed before an RF8 hop.
+	 */
+	if (hop->channel == ADF4371_CH_RF8 || hop->channel == ADF4371_CH_RFAUX8)
+		rf_div_sel = hop->rf_div_sel;
+	else
+		rf_div_sel = dev->rf_div_sel;
+
+	if (!valid) {
+		ret = adf4371_read(dev, ADF4371_REG(0x24), &dev->reg24);
+		if (ret < 0)
+			return ret;
+	}
+
+	/* The shadow is only trusted again once the whole image is written */
+	dev->hop_valid = false;
+
+	/* The changed part of 0x11...0x1A in a single transaction */
+	for (i = ADF4371_HOP_REG11; i < ADF4371_HOP_REG11 + 10; i++) {
+		if (valid && hop->regs[i] == shadow[i])
+			continue;
+		if (first < 0)
+			first = i;
+		last = i;
+		shadow[i] = hop->regs[i];
+	}
+
+	if (first >= 0) {
+		ret = adf4371_write_bulk(dev,
+					 ADF4371_REG(0x11) + first - ADF4371_HOP_REG11,
+					 &hop->regs[first], last - first + 1);
+		if (ret < 0)
+			return ret;
+	}
+
+	for (i = ADF4371_HOP_REG1F; i <= ADF4371_HOP_REG2B; i++) {
+		val = hop->regs[i];
+		if (i == ADF4371_HOP_REG24) {
+			val = ADF4371_RF_DIV_SEL(rf_div_sel) |
+			      (dev->reg24 & ~ADF4371_RF_DIV_SEL_MSK);
+			dev->reg24 = val;
+		}
+		if (valid && val == shadow[i])
+			continue;
+
+		ret = adf4371_write(dev, single_regs[i], val);
+		if (ret < 0)
+			return ret;
+		shadow[i] = val;
+	}
+
+	/* Writing REG10 loads the double buffered registers and recalibrates */
+	ret = adf4371_write(dev, ADF4371_REG(0x10), hop->regs[ADF4371_HOP_REG10]);
 	if (ret < 0)
 		return ret;
 
-	return adf4371_write(dev, ADF4371_REG(0x10), dev->integer & 0xFF);
+	dev->integer = hop->integer;
+	dev->fract1 = hop->fract1;
+	dev->fract2 = hop->fract2;
+	dev->mod2 = hop->mod2;
+	dev->rf_div_sel = rf_div_sel;
+	dev->hop_valid = true;
+
+	return SUCCESS;
+}
+
+/**
+ * Precompute the register images of a list of output frequencies.
+ * @param dev - The device structure.
+ * @param table - The hop table.
+ * @param freqs - The output frequencies.
+ * @param nb_freqs - Number of frequencies.
+ * @param channel - The selected channel.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t adf4371_hop_table_init(struct adf4371_dev *dev,
+			       struct adf4371_hop_table **table,
+			       const uint64_t *freqs,
+			       uint32_t nb_freqs,
+			       uint32_t channel)
+{
+	struct adf4371_hop_table *tbl;
+	uint32_t i;
+	int32_t ret;
+
+	if (!dev || !table || !freqs || !nb_freqs)
+		return -EINVAL;
+
+	tbl = (struct adf4371_hop_table *)calloc(1, sizeof(*tbl));
+	if (!tbl)
+		return -ENOMEM;
+
+	tbl->hops = (struct adf4371_hop *)calloc(nb_freqs, sizeof(*tbl->hops));
+	if (!tbl->hops) {
+		free(tbl);
+		return -ENOMEM;
+	}
+	tbl->nb_hops = nb_freqs;
+
+	for (i = 0; i < nb_freqs; i++) {
+		ret = adf4371_hop_compute(dev, freqs[i], channel, &tbl->hops[i]);
+		if (ret < 0) {
+			adf4371_hop_table_remove(tbl);
+			return ret;
+		}
+	}
+
+	*table = tbl;
+
+	return SUCCESS;
+}
+
+/**
+ * Free the resources allocated by adf4371_hop_table_init().
+ * @param table - The hop table.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t adf4371_hop_table_remove(struct adf4371_hop_table *table)
+{
+	if (!table)
+		return -EINVAL;
+
+	free(table->hops);
+	free(table);
+
+	return SUCCESS;
+}
+
+/**
+ * Hop to an entry of a hop table.
+ * @param dev - The device structure.
+ * @param table - The hop table.
+ * @param index - The entry index.
+ * @param settle_us - The autocalibration time of the PLL, optional. The
+ *                    loop filter settling time must be added to it.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t adf4371_hop(struct adf4371_dev *dev,
+		    const struct adf4371_hop_table *table,
+		    uint32_t index,
+		    uint32_t *settle_us)
+{
+	int32_t ret;
+
+	if (!dev || !table || index >= table->nb_hops)
+		return -EINVAL;
+
+	ret = adf4371_hop_apply(dev, &table->hops[index]);
+	if (ret < 0)
+		return ret;
+
+	if (settle_us)
+		*settle_us = table->hops[index].settle_us;
+
+	return SUCCESS;
+}
+
+/**
+ * Set the output frequency for one channel.
+ * @param dev - The device structure.
+ * @param freq - The output frequency.
+ * @param channel - The selected channel.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t adf4371_set_freq(struct adf4371_dev *dev,
+				uint64_t freq,
+				uint32_t channel)
+{
+	struct adf4371_hop hop;
+	int32_t ret;
+
+	ret = adf4371_hop_compute(dev, freq, channel, &hop);
+	if (ret < 0)
+		return ret;
+
+	return adf4371_hop_apply(dev, &hop);
 }
 
 /**
@@ -674,6 +874,10 @@ static int32_t adf4371_setup(struct adf4371_dev *dev)
 		vco_alc_timeout++;
 	} while (vco_alc_timeout * 1024 - timeout <= 50 * tmp);
 
+	dev->timeout = timeout;
+	dev->synth_timeout = synth_timeout;
+	dev->vco_alc_timeout = vco_alc_timeout;
+
 	dev->buf[0] = vco_band_div;
 	dev->buf[1] = timeout & 0xFF;
 	dev->buf[2] = ADF4371_TIMEOUT(timeout >> 8) | 0x04;
@@ -63,6 +63,36 @@ struct adf4371_chan_spec {
 	uint64_t	power_up_frequency;
 };
 
+/* Register image of a hop, see struct adf4371_hop */
+enum adf4371_hop_reg {
+	ADF4371_HOP_REG11,
+	ADF4371_HOP_REG1F = ADF4371_HOP_REG11 + 10,
+	ADF4371_HOP_REG24,
+	ADF4371_HOP_REG26,
+	ADF4371_HOP_REG2B,
+	ADF4371_HOP_REG10,
+	ADF4371_HOP_NB_REGS
+};
+
+struct adf4371_hop {
+	uint64_t	freq;
+	uint32_t	channel;
+	uint32_t	integer;
+	uint32_t	fract1;
+	uint32_t	fract2;
+	uint32_t	mod2;
+	uint32_t	rf_div_sel;
+	/* 0x11...0x1A, 0x1F, 0x24 (RF_DIV_SEL field), 0x26, 0x2B, 0x10 */
+	uint8_t		regs[ADF4371_HOP_NB_REGS];
+	/* Autocalibration time */
+	uint32_t	settle_us;
+};
+
+struct adf4371_hop_table {
+	uint32_t	nb_hops;
+	struct adf4371_hop	*hops;
+};
+
 struct adf4371_dev {
 	spi_desc	*spi_desc;
 	bool		spi_3wire_en;
@@ -83,6 +113,13 @@ struct adf4371_dev {
 	uint32_t	fract2;
 	uint32_t	mod2;
 	uint32_t	rf_div_sel;
+	uint32_t	timeout;
+	uint32_t	synth_timeout;
+	uint32_t	vco_alc_timeout;
+	/* Last written frequency registers */
+	bool		hop_valid;
+	uint8_t		hop_shadow[ADF4371_HOP_NB_REGS];
+	uint8_t		reg24;
 	uint8_t		buf[10];
 };
 
@@ -122,4 +159,20 @@ int32_t adf4371_clk_round_rate(struct adf4371_dev *dev, uint64_t rate,
 int32_t adf4371_clk_set_rate(struct adf4371_dev *dev, uint32_t chan,
 			     uint64_t rate);
 
+/* Precompute the register images of a list of frequencies. */
+int32_t adf4371_hop_table_init(struct adf4371_dev *dev,
+			       struct adf4371_hop_table **table,
+			       const uint64_t *freqs,
+			       uint32_t nb_freqs,
+			       uint32_t channel);
+
+/* Free the hop table. */
+int32_t adf4371_hop_table_remove(struct adf4371_hop_table *table);
+
+/* Hop to an entry of a hop table. */
+int32_t adf4371_hop(struct adf4371_dev *dev,
+		    const struct adf4371_hop_table *table,
+		    uint32_t index,
+		    uint32_t *settle_us);
+
 #endif
@@ -303,20 +303,9 @@ int32_t hmc7044_read(struct hmc7044_dev *dev, uint16_t reg, uint8_t *val)
 uint32_t hmc7044_calc_out_div(uint32_t rate,
 			      uint32_t parent_rate)
 {
-	uint32_t div;
-
-	div = DIV_ROUND_CLOSEST(parent_rate, rate);
-
 	/* Supported odd divide ratios are 1, 3, and 5 */
-	if ((div != 1) && (div != 3) && (div != 5) && (div % 2))
-		div = DIV_ROUND_CLOSEST(parent_rate, rate * 2) * 2;
-
-	div = clamp_t(unsigned int,
-		      div,
-		      HMC7044_OUT_DIV_MIN,
-		      HMC7044_OUT_DIV_MAX);
-
-	return div;
+	return closest_divider(parent_rate, rate, HMC7044_OUT_DIV_MIN,
+			       HMC7044_OUT_DIV_MAX, 5);
 }
 
 /**
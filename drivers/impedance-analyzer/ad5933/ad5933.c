@@ -42,6 +42,8 @@
 /*****************************************************************************/
 #include <stdlib.h>
 #include "ad5933.h"
+#include "error.h"
+#include "util.h"
 #include <math.h>
 
 /******************************************************************************/
@@ -49,6 +51,12 @@
 /******************************************************************************/
 const int32_t pow_2_27 = 134217728ul;      // 2 to the power of 27
 
+/* atan(2^-i) in millidegrees, used by the CORDIC phase computation */
+static const int32_t ad5933_cordic_atan[] = {
+	45000, 26565, 14036, 7125, 3576, 1790, 895, 448,
+	224, 112, 56, 28, 14, 7, 3, 2
+};
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -386,6 +394,7 @@ double ad5933_calculate_gain_factor(struct ad5933_dev *dev,
 	double magnitude = 0;
 	signed short real_data = 0;
 	signed short imag_data = 0;
+	uint8_t data[4] = {0, 0, 0, 0};
 	uint8_t status = 0;
 
 	ad5933_set_register_value(dev,
@@ -400,12 +409,9 @@ double ad5933_calculate_gain_factor(struct ad5933_dev *dev,
 						   AD5933_REG_STATUS,
 						   1);
 	}
-	real_data = ad5933_get_register_value(dev,
-					      AD5933_REG_REAL_DATA,
-					      2);
-	imag_data = ad5933_get_register_value(dev,
-					      AD5933_REG_IMAG_DATA,
-					      2);
+	ad5933_block_read(dev, AD5933_REG_REAL_DATA, data, 4);
+	real_data = (data[0] << 8) | data[1];
+	imag_data = (data[2] << 8) | data[3];
 	magnitude = sqrt((real_data * real_data) + (imag_data * imag_data));
 	gain_factor = 1 / (magnitude * calibration_impedance);
 
@@ -431,6 +437,7 @@ double ad5933_calculate_impedance(struct ad5933_dev *dev,
 	signed short imag_data = 0;
 	double magnitude = 0;
 	double impedance = 0;
+	uint8_t data[4] = {0, 0, 0, 0};
 	uint8_t status = 0;
 
 	ad5933_set_register_value(dev,
@@ -445,15 +452,249 @@ double ad5933_calculate_impedance(struct ad5933_dev *dev,
 						   AD5933_REG_STATUS,
 						   1);
 	}
-	real_data = ad5933_get_register_value(dev,
-					      AD5933_REG_REAL_DATA,
-					      2);
-	imag_data = ad5933_get_register_value(dev,
-					      AD5933_REG_IMAG_DATA,
-					      2);
+	ad5933_block_read(dev, AD5933_REG_REAL_DATA, data, 4);
+	real_data = (data[0] << 8) | data[1];
+	imag_data = (data[2] << 8) | data[3];
 	magnitude = sqrt((real_data * real_data) + (imag_data * imag_data));
 
 	impedance =  1 / (magnitude * gain_factor);
 
 	return impedance;
 }
+
+/***************************************************************************//**
+ * @brief Reads consecutive registers with a single I2C block read.
+ *
+ * @param dev              - The device structure.
+ * @param register_address - Address of the first register.
+ * @param data             - Buffer receiving the register values.
+ * @param bytes_number     - Number of bytes to read.
+ *
+ * @return ret - The result of the I2C transfers.
+*******************************************************************************/
+int32_t ad5933_block_read(struct ad5933_dev *dev,
+			  uint8_t register_address,
+			  uint8_t *data,
+			  uint8_t bytes_number)
+{
+	uint8_t write_data[2];
+	int32_t ret;
+
+	/* Set the register pointer. */
+	write_data[0] = AD5933_ADDR_POINTER;
+	write_data[1] = register_address;
+	ret = i2c_write(dev->i2c_desc, write_data, 2, 1);
+	if (ret < 0)
+		return ret;
+
+	/* Block read command, followed by a repeated start. */
+	write_data[0] = AD5933_BLOCK_READ;
+	write_data[1] = bytes_number;
+	ret = i2c_write(dev->i2c_desc, write_data, 2, 0);
+	if (ret < 0)
+		return ret;
+
+	return i2c_read(dev->i2c_desc, data, bytes_number, 1);
+}
+
+/***************************************************************************//**
+ * @brief Integer square root.
+ *
+ * @param x - Input value.
+ *
+ * @return The floor of the square root of x.
+*******************************************************************************/
+static uint32_t ad5933_isqrt(uint64_t x)
+{
+	uint64_t res = 0;
+	uint64_t bit = 1ull << 62;
+
+	while (bit > x)
+		bit >>= 2;
+
+	while (bit) {
+		if (x >= res + bit) {
+			x -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t)res;
+}
+
+/***************************************************************************//**
+ * @brief Computes the magnitude and phase of a DFT result, using integer
+ *        arithmetic only.
+ *
+ * @param point - Sweep point; real and imag are inputs, magnitude and phase
+ *                are filled.
+ *
+ * @return None.
+*******************************************************************************/
+void ad5933_dft_to_polar(struct ad5933_sweep_point *point)
+{
+	int32_t x = point->real;
+	int32_t y = point->imag;
+	int32_t angle = 0;
+	int32_t tmp;
+	uint8_t i;
+
+	point->magnitude = ad5933_isqrt(((uint64_t)(x * x) +
+					 (uint64_t)(y * y)) << 16);
+
+	if (!x && !y) {
+		point->phase = 0;
+		return;
+	}
+
+	/* Rotate into the right half plane, then run the CORDIC vectoring. */
+	if (x < 0) {
+		angle = (y >= 0) ? 180000 : -180000;
+		x = -x;
+		y = -y;
+	}
+
+	x <<= 14;
+	y <<= 14;
+	for (i = 0; i < ARRAY_SIZE(ad5933_cordic_atan); i++) {
+		tmp = x;
+		if (y > 0) {
+			x += y >> i;
+			y -= tmp >> i;
+			angle += ad5933_cordic_atan[i];
+		} else {
+			x -= y >> i;
+			y += tmp >> i;
+			angle -= ad5933_cordic_atan[i];
+		}
+	}
+
+	point->phase = clamp(angle, -180000, 180000);
+}
+
+/***************************************************************************//**
+ * @brief Calculates the impedance from a calibration point, using integer
+ *        arithmetic only: Z = Zcal * |DFTcal| / |DFT|.
+ *
+ * @param magnitude     - Magnitude of the measured point.
+ * @param cal_magnitude - Magnitude measured on the calibration impedance.
+ * @param cal_impedance - The calibration impedance value.
+ *
+ * @return The impedance, in the unit of cal_impedance, 0 if magnitude is 0.
+*******************************************************************************/
+uint32_t ad5933_impedance_fixed(uint32_t magnitude,
+				uint32_t cal_magnitude,
+				uint32_t cal_impedance)
+{
+	if (!magnitude)
+		return 0;
+
+	return (uint32_t)(((uint64_t)cal_impedance * cal_magnitude +
+			   magnitude / 2) / magnitude);
+}
+
+/***************************************************************************//**
+ * @brief Starts a non-blocking sweep. The sweep must be configured with
+ *        ad5933_config_sweep() and is then advanced by ad5933_sweep_poll().
+ *
+ * @param dev        - The device structure.
+ * @param sweep      - Sweep engine state.
+ * @param points     - Buffer receiving the sweep points.
+ * @param max_points - Size of the points buffer.
+ *
+ * @return ret - The result of the I2C transfers.
+*******************************************************************************/
+int32_t ad5933_sweep_start(struct ad5933_dev *dev,
+			   struct ad5933_sweep *sweep,
+			   struct ad5933_sweep_point *points,
+			   uint16_t max_points)
+{
+	if (!points || !max_points)
+		return -1;
+
+	sweep->points = points;
+	sweep->max_points = max_points;
+	sweep->nr_points = 0;
+
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_STANDBY) |
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+	ad5933_reset(dev);
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_INIT_START_FREQ)|
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_START_SWEEP) |
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+
+	sweep->state = AD5933_SWEEP_RUNNING;
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Advances the sweep engine. Meant to be called from a periodic timer
+ *        or the main loop: every call costs a single status read unless a
+ *        new point is available, in which case the real and imaginary data
+ *        are fetched with one block read and the frequency is incremented.
+ *
+ * @param dev   - The device structure.
+ * @param sweep - Sweep engine state.
+ *
+ * @return ret - -EAGAIN while the sweep is in progress, 0 when the sweep is
+ *               complete (sweep->nr_points holds the number of points), or
+ *               a negative error code.
+*******************************************************************************/
+int32_t ad5933_sweep_poll(struct ad5933_dev *dev,
+			  struct ad5933_sweep *sweep)
+{
+	struct ad5933_sweep_point *point;
+	uint8_t data[4];
+	uint8_t status;
+	int32_t ret;
+
+	if (sweep->state == AD5933_SWEEP_DONE)
+		return 0;
+	if (sweep->state != AD5933_SWEEP_RUNNING)
+		return -1;
+
+	status = ad5933_get_register_value(dev, AD5933_REG_STATUS, 1);
+	if (!(status & AD5933_STAT_DATA_VALID))
+		return -EAGAIN;
+
+	ret = ad5933_block_read(dev, AD5933_REG_REAL_DATA, data, 4);
+	if (ret < 0)
+		return ret;
+
+	point = &sweep->points[sweep->nr_points++];
+	point->real = (int16_t)((data[0] << 8) | data[1]);
+	point->imag = (int16_t)((data[2] << 8) | data[3]);
+	ad5933_dft_to_polar(point);
+
+	if ((status & AD5933_STAT_SWEEP_DONE) ||
+	    (sweep->nr_points == sweep->max_points)) {
+		sweep->state = AD5933_SWEEP_DONE;
+		return 0;
+	}
+
+	ad5933_set_register_value(dev,
+				  AD5933_REG_CONTROL_HB,
+				  AD5933_CONTROL_FUNCTION(AD5933_FUNCTION_INC_FREQ) |
+				  AD5933_CONTROL_RANGE(dev->current_range) |
+				  AD5933_CONTROL_PGA_GAIN(dev->current_gain),
+				  1);
+
+	return -EAGAIN;
+}
@@ -108,6 +108,11 @@
 #define AD5933_INTERNAL_SYS_CLK     16000000ul      // 16MHz
 #define AD5933_MAX_INC_NUM          511             // Maximum increment number
 
+/* AD5933 Sweep Engine States */
+#define AD5933_SWEEP_IDLE           0
+#define AD5933_SWEEP_RUNNING        1
+#define AD5933_SWEEP_DONE           2
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -122,6 +127,29 @@ struct ad5933_dev {
 	uint8_t current_range;
 };
 
+/* One frequency point of a sweep. */
+struct ad5933_sweep_point {
+	/* Raw real data */
+	int16_t real;
+	/* Raw imaginary data */
+	int16_t imag;
+	/* DFT magnitude, fixed point with 8 fractional bits */
+	uint32_t magnitude;
+	/* DFT phase, in millidegrees (-180000 to 180000) */
+	int32_t phase;
+};
+
+struct ad5933_sweep {
+	/* Caller buffer receiving the sweep */
+	struct ad5933_sweep_point *points;
+	/* Size of the points buffer */
+	uint16_t max_points;
+	/* Number of points acquired */
+	uint16_t nr_points;
+	/* Sweep engine state */
+	uint8_t state;
+};
+
 struct ad5933_init_param {
 	/* I2C */
 	i2c_init_param	i2c_init;
@@ -189,4 +217,28 @@ double ad5933_calculate_impedance(struct ad5933_dev *dev,
 				  double gain_factor,
 				  uint8_t freq_function);
 
+/*! Reads consecutive registers with a single I2C block read. */
+int32_t ad5933_block_read(struct ad5933_dev *dev,
+			  uint8_t register_address,
+			  uint8_t *data,
+			  uint8_t bytes_number);
+
+/*! Starts a non-blocking sweep. */
+int32_t ad5933_sweep_start(struct ad5933_dev *dev,
+			   struct ad5933_sweep *sweep,
+			   struct ad5933_sweep_point *points,
+			   uint16_t max_points);
+
+/*! Advances the sweep engine, to be called periodically. */
+int32_t ad5933_sweep_poll(struct ad5933_dev *dev,
+			  struct ad5933_sweep *sweep);
+
+/*! Computes the fixed point magnitude and phase of a DFT result. */
+void ad5933_dft_to_polar(struct ad5933_sweep_point *point);
+
+/*! Calculates the impedance using a calibration point, no floating point. */
+uint32_t ad5933_impedance_fixed(uint32_t magnitude,
+				uint32_t cal_magnitude,
+				uint32_t cal_impedance);
+
 #endif /* __AD5933_H__ */
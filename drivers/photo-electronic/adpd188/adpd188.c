@@ -42,9 +42,11 @@
 /******************************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
 #include "adpd188.h"
 #include "error.h"
 #include "delay.h"
+#include "util.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -132,6 +134,9 @@ int32_t adpd188_remove(struct adpd188_dev *dev)
 {
 	int32_t ret;
 
+	if(dev->stream)
+		adpd188_fifo_stream_stop(dev);
+
 	if(dev->phy_opt == ADPD188_SPI)
 		ret = spi_remove(dev->phy_desc);
 	else if(dev->phy_opt == ADPD188_I2C)
@@ -331,6 +336,257 @@ int32_t adpd188_fifo_thresh_set(struct adpd188_dev *dev, uint8_t word_no)
 	return adpd188_reg_write(dev, ADPD188_REG_FIFO_THRESH, reg_data);
 }
 
+/**
+ * @brief Read a burst of 16 bit words from the FIFO in a single transaction.
+ * @param dev - The ADPD188 descriptor.
+ * @param data - Buffer receiving the words, in the order they were stored.
+ * @param word_no - Number of words to read.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_read(struct adpd188_dev *dev, uint16_t *data,
+			  uint8_t word_no)
+{
+	int32_t ret;
+	uint8_t buff[ADPD188_FIFO_DEPTH_WORDS * 2 + 1];
+	uint8_t reg_addr = ADPD188_REG_FIFO_ACCESS;
+	uint8_t i;
+
+	if(!word_no || word_no > ADPD188_FIFO_DEPTH_WORDS)
+		return FAILURE;
+
+	/* The FIFO access register is not auto-incremented on burst reads. */
+	if(dev->phy_opt == ADPD188_SPI) {
+		buff[0] = (reg_addr << 1) & 0xFE;
+		memset(buff + 1, 0, word_no * 2);
+		ret = spi_write_and_read(dev->phy_desc, buff, word_no * 2 + 1);
+	} else if(dev->phy_opt == ADPD188_I2C) {
+		ret = i2c_write(dev->phy_desc, &reg_addr, 1, 0);
+		if(ret != SUCCESS)
+			return FAILURE;
+		/* Keep the same layout as in the SPI case. */
+		ret = i2c_read(dev->phy_desc, (buff + 1), word_no * 2, 1);
+	} else {
+		ret = FAILURE;
+	}
+	if(ret != SUCCESS)
+		return FAILURE;
+
+	for(i = 0; i < word_no; i++)
+		data[i] = (buff[2 * i + 1] << 8) | buff[2 * i + 2];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the number of 16 bit words a slot stores in the FIFO for every
+ *        sample period.
+ * @param mode - Slot FIFO mode.
+ * @return Number of words.
+ */
+static uint8_t adpd188_fifo_mode_words(enum adpd188_slot_fifo_mode mode)
+{
+	switch(mode) {
+	case ADPD188_16BIT_SUM:
+		return 1;
+	case ADPD188_32BIT_SUM:
+		return 2;
+	case ADPD188_16BIT_4CHAN:
+		return 4;
+	case ADPD188_32BIT_4CHAN:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief Start streaming the FIFO content. The FIFO threshold is set to a
+ *        whole number of sample periods and the FIFO interrupt is enabled.
+ *        adpd188_fifo_stream_handler() must be registered, with the
+ *        descriptor as context, as the handler of the host interrupt wired
+ *        to the ADPD188 interrupt GPIO; the host can sleep between bursts.
+ * @param dev - The ADPD188 descriptor.
+ * @param config - Streaming configuration.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_stream_start(struct adpd188_dev *dev,
+				  struct adpd188_fifo_stream_config *config)
+{
+	struct adpd188_fifo_stream *stream;
+	uint8_t frame_words;
+	int32_t ret;
+
+	if(dev->stream || !config->periods_per_burst)
+		return FAILURE;
+
+	stream = (struct adpd188_fifo_stream *)calloc(1, sizeof(*stream));
+	if(!stream)
+		return FAILURE;
+
+	stream->slota_words = adpd188_fifo_mode_words(config->slota_mode);
+	stream->slotb_words = adpd188_fifo_mode_words(config->slotb_mode);
+	frame_words = stream->slota_words + stream->slotb_words;
+	if(!frame_words ||
+	    frame_words * config->periods_per_burst > ADPD188_FIFO_DEPTH_WORDS)
+		goto error_stream;
+
+	if(stream->slota_words) {
+		ret = cb_init(&stream->slota_cb, config->buff_words * 2);
+		if(ret != SUCCESS)
+			goto error_stream;
+	}
+	if(stream->slotb_words) {
+		ret = cb_init(&stream->slotb_cb, config->buff_words * 2);
+		if(ret != SUCCESS)
+			goto error_cb;
+	}
+
+	dev->stream = stream;
+
+	ret = adpd188_fifo_clear(dev);
+	if(ret != SUCCESS)
+		goto error_cb;
+	/* The interrupt fires when the FIFO holds more words than the threshold */
+	ret = adpd188_fifo_thresh_set(dev,
+				      frame_words * config->periods_per_burst - 1);
+	if(ret != SUCCESS)
+		goto error_cb;
+	ret = adpd188_interrupt_en(dev, ADPD188_FIFO_INT);
+	if(ret != SUCCESS)
+		goto error_cb;
+
+	return SUCCESS;
+
+error_cb:
+	dev->stream = NULL;
+	if(stream->slota_cb)
+		cb_remove(stream->slota_cb);
+	if(stream->slotb_cb)
+		cb_remove(stream->slotb_cb);
+error_stream:
+	free(stream);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Stop streaming: mask the FIFO interrupt and free the stream buffers.
+ * @param dev - The ADPD188 descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t adpd188_fifo_stream_stop(struct adpd188_dev *dev)
+{
+	struct adpd188_fifo_stream *stream = dev->stream;
+	int32_t ret;
+	uint16_t reg_data;
+
+	if(!stream)
+		return FAILURE;
+
+	ret = adpd188_reg_read(dev, ADPD188_REG_INT_MASK, &reg_data);
+	if(ret != SUCCESS)
+		return FAILURE;
+	reg_data |= ADPD188_INT_MASK_FIFO_INT_MASK_MASK;
+	ret = adpd188_reg_write(dev, ADPD188_REG_INT_MASK, reg_data);
+	if(ret != SUCCESS)
+		return FAILURE;
+
+	dev->stream = NULL;
+	if(stream->slota_cb)
+		cb_remove(stream->slota_cb);
+	if(stream->slotb_cb)
+		cb_remove(stream->slotb_cb);
+	free(stream);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Drain all the complete sample periods present in the FIFO with one
+ *        burst read and demultiplex them into the slot A and slot B streams.
+ *        Meant to be registered as the FIFO interrupt callback.
+ * @param ctx - The ADPD188 descriptor.
+ * @param event - Interrupt event (unused).
+ * @param extra - Platform specific data (unused).
+ * @return None.
+ */
+void adpd188_fifo_stream_handler(void *ctx, uint32_t event, void *extra)
+{
+	struct adpd188_dev *dev = ctx;
+	struct adpd188_fifo_stream *stream = dev->stream;
+	uint16_t words[ADPD188_FIFO_DEPTH_WORDS];
+	uint8_t bytes_no, frame_words, frames, i;
+	uint16_t *frame;
+
+	if(!stream)
+		return;
+
+	if(adpd188_fifo_status_get(dev, &bytes_no) != SUCCESS)
+		goto error;
+
+	frame_words = stream->slota_words + stream->slotb_words;
+	frames = (bytes_no / 2) / frame_words;
+	if(!frames)
+		return;
+
+	if(adpd188_fifo_read(dev, words, frames * frame_words) != SUCCESS)
+		goto error;
+
+	for(i = 0; i < frames; i++) {
+		frame = &words[i * frame_words];
+		if(stream->slota_words)
+			cb_write(stream->slota_cb, frame,
+				 stream->slota_words * 2);
+		if(stream->slotb_words)
+			cb_write(stream->slotb_cb, frame + stream->slota_words,
+				 stream->slotb_words * 2);
+	}
+
+	return;
+
+error:
+	stream->errors++;
+}
+
+/**
+ * @brief Read the samples streamed for one slot.
+ * @param dev - The ADPD188 descriptor.
+ * @param slot - The time slot.
+ * @param data - Buffer receiving the words.
+ * @param word_no - Maximum number of words to read.
+ * @return Number of words read, or FAILURE.
+ */
+int32_t adpd188_fifo_stream_read(struct adpd188_dev *dev,
+				 enum adpd188_slots slot, uint16_t *data,
+				 uint32_t word_no)
+{
+	struct circular_buffer *cb;
+	uint32_t size;
+	int32_t ret;
+
+	if(!dev->stream)
+		return FAILURE;
+
+	cb = (slot == ADPD188_SLOTA) ? dev->stream->slota_cb :
+	     dev->stream->slotb_cb;
+	if(!cb)
+		return FAILURE;
+
+	ret = cb_size(cb, &size);
+	if(ret != SUCCESS && ret != -EOVERRUN)
+		return FAILURE;
+
+	size = min(size / 2, word_no);
+	if(!size)
+		return 0;
+
+	ret = cb_read(cb, data, size * 2);
+	if(ret != SUCCESS && ret != -EOVERRUN)
+		return FAILURE;
+
+	return size;
+}
+
 /**
  * @brief Get the slot and FIFO interrupt flags.
  * @param dev - The ADPD188 descriptor.
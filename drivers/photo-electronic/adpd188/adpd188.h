@@ -49,6 +49,7 @@
 #include "i2c.h"
 #include "spi.h"
 #include "gpio.h"
+#include "circular_buffer.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -177,6 +178,7 @@
 #define ADPD188_FIFO_THRESH_FIFO_THRESH_MASK	0x3F00
 #define ADPD188_FIFO_THRESH_FIFO_THRESH_POS	8
 #define ADPD188_FIFO_THRESH_MAX_THRESHOLD	63
+#define ADPD188_FIFO_DEPTH_WORDS		64
 
 /* ADPD188_REG_DEVID */
 #define ADPD188_DEVID_REV_NUM_MASK	0xFF00
@@ -636,6 +638,38 @@ struct adpd188_slot_config {
 	enum adpd188_slot_fifo_mode sot_fifo_mode;
 };
 
+/**
+ * @struct adpd188_fifo_stream_config
+ * @brief FIFO streaming configuration structure.
+ */
+struct adpd188_fifo_stream_config {
+	/** Slot A FIFO mode, must match the one set with adpd188_slot_setup(). */
+	enum adpd188_slot_fifo_mode slota_mode;
+	/** Slot B FIFO mode, must match the one set with adpd188_slot_setup(). */
+	enum adpd188_slot_fifo_mode slotb_mode;
+	/** Number of sample periods gathered in the FIFO before an interrupt. */
+	uint8_t periods_per_burst;
+	/** Size of each slot stream buffer, in 16 bit words. */
+	uint32_t buff_words;
+};
+
+/**
+ * @struct adpd188_fifo_stream
+ * @brief FIFO streaming state.
+ */
+struct adpd188_fifo_stream {
+	/** Number of 16 bit words stored by slot A in a sample period. */
+	uint8_t slota_words;
+	/** Number of 16 bit words stored by slot B in a sample period. */
+	uint8_t slotb_words;
+	/** Slot A samples. */
+	struct circular_buffer *slota_cb;
+	/** Slot B samples. */
+	struct circular_buffer *slotb_cb;
+	/** Number of FIFO bursts that failed to be read. */
+	uint32_t errors;
+};
+
 /**
  * @struct adpd188_dev
  * @brief Driver descriptor structure.
@@ -649,6 +683,8 @@ struct adpd188_dev {
 	struct gpio_desc *gpio0;
 	/** GPIO 1 descriptor. */
 	struct gpio_desc *gpio1;
+	/** FIFO streaming state, NULL if streaming is not active. */
+	struct adpd188_fifo_stream *stream;
 };
 
 /**
@@ -703,6 +739,25 @@ int32_t adpd188_fifo_clear(struct adpd188_dev *dev);
  */
 int32_t adpd188_fifo_thresh_set(struct adpd188_dev *dev, uint8_t word_no);
 
+/* Read a burst of 16 bit words from the FIFO in a single transaction. */
+int32_t adpd188_fifo_read(struct adpd188_dev *dev, uint16_t *data,
+			  uint8_t word_no);
+
+/* Start streaming the FIFO content on the FIFO threshold interrupt. */
+int32_t adpd188_fifo_stream_start(struct adpd188_dev *dev,
+				  struct adpd188_fifo_stream_config *config);
+
+/* Stop streaming and free the stream buffers. */
+int32_t adpd188_fifo_stream_stop(struct adpd188_dev *dev);
+
+/* Drain the FIFO and demultiplex the samples, called on FIFO interrupt. */
+void adpd188_fifo_stream_handler(void *ctx, uint32_t event, void *extra);
+
+/* Read the samples streamed for one slot. */
+int32_t adpd188_fifo_stream_read(struct adpd188_dev *dev,
+				 enum adpd188_slots slot, uint16_t *data,
+				 uint32_t word_no);
+
 /* Get the slot and FIFO interrupt flags. */
 int32_t adpd188_interrupt_get(struct adpd188_dev *dev, uint8_t *flags);
 
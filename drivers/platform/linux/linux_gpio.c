@@ -43,64 +43,325 @@
 
 #include "error.h"
 #include "gpio.h"
+#include "linux_gpio.h"
 
+#include <dirent.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define LINUX_GPIO_CONSUMER	"no-OS"
+
+#define LINUX_GPIO_SYSFS	"/sys/class/gpio"
+
+#define LINUX_GPIO_EDGE_FLAGS	(GPIO_V2_LINE_FLAG_EDGE_RISING | \
+				 GPIO_V2_LINE_FLAG_EDGE_FALLING)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct linux_gpio_desc
+ * @brief Linux platform specific GPIO descriptor
+ */
+struct linux_gpio_desc {
+	/** Line request file descriptor, held open until gpio_remove() */
+	int line_fd;
+	/** Current line configuration flags */
+	uint64_t flags;
+};
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 /**
- * @brief Obtain the GPIO decriptor.
- * @param desc - The GPIO descriptor.
- * @param param - GPIO initialization parameters
+ * @brief Request lines of a GPIO chip, the chip is closed once the line
+ *        request file descriptor is obtained.
+ * @param chip_id - GPIO chip ID (/dev/gpiochip"chip_id").
+ * @param req - Line request, filled with the line file descriptor.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t gpio_get(struct gpio_desc **desc,
-		 const struct gpio_init_param *param)
+static int32_t linux_gpio_request(uint32_t chip_id,
+				  struct gpio_v2_line_request *req)
 {
-	gpio_desc *descriptor;
 	char path[64];
 	int fd;
-	int len;
 	int ret;
 
-	descriptor = (gpio_desc *)malloc(sizeof(*descriptor));
-	if (!descriptor)
+	snprintf(path, sizeof(path), "/dev/gpiochip%d", chip_id);
+	fd = open(path, O_RDWR | O_CLOEXEC);
+	if (fd < 0) {
+		printf("%s: Can't open %s\n\r", __func__, path);
 		return FAILURE;
+	}
 
-	descriptor->number = param->number;
+	strncpy(req->consumer, LINUX_GPIO_CONSUMER, sizeof(req->consumer) - 1);
+	ret = ioctl(fd, GPIO_V2_GET_LINE_IOCTL, req);
+	close(fd);
+	if (ret == -1) {
+		printf("%s: Can't request line\n\r", __func__);
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Read an unsigned number from a sysfs attribute.
+ * @param path - The attribute path.
+ * @param val - The value read.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_gpio_read_attr(const char *path, uint32_t *val)
+{
+	FILE *f;
+	int ret;
+
+	f = fopen(path, "r");
+	if (!f)
+		return FAILURE;
+
+	ret = fscanf(f, "%u", val);
+	fclose(f);
+
+	return ret == 1 ? SUCCESS : FAILURE;
+}
+
+/**
+ * @brief Find the character device of the chip registered in sysfs as
+ *        gpiochip"base". Depending on the kernel version, the "device" link
+ *        points either to the GPIO device itself or to its parent, which
+ *        then holds the gpiochipN directory.
+ * @param base - The sysfs base of the chip.
+ * @param chip_id - The chip ID (/dev/gpiochip"chip_id").
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_gpio_sysfs_chip_id(uint32_t base, uint32_t *chip_id)
+{
+	char path[PATH_MAX];
+	char real[PATH_MAX];
+	struct dirent *entry;
+	char *name;
+	DIR *dir;
+
+	snprintf(path, sizeof(path), LINUX_GPIO_SYSFS "/gpiochip%u/device",
+		 base);
+	if (!realpath(path, real))
+		return FAILURE;
+
+	name = strrchr(real, '/');
+	if (name && sscanf(name + 1, "gpiochip%u", chip_id) == 1)
+		return SUCCESS;
+
+	dir = opendir(real);
+	if (!dir)
+		return FAILURE;
+
+	while ((entry = readdir(dir))) {
+		if (sscanf(entry->d_name, "gpiochip%u", chip_id) == 1) {
+			closedir(dir);
+			return SUCCESS;
+		}
+	}
+	closedir(dir);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Translate a global (sysfs) GPIO number into a chip and line offset.
+ * @param number - The global GPIO number.
+ * @param chip_id - The chip ID (/dev/gpiochip"chip_id").
+ * @param offset - The line offset on that chip.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_gpio_sysfs_lookup(uint32_t number, uint32_t *chip_id,
+				       uint32_t *offset)
+{
+	char path[PATH_MAX];
+	struct dirent *entry;
+	uint32_t base;
+	uint32_t ngpio;
+	DIR *dir;
+
+	dir = opendir(LINUX_GPIO_SYSFS);
+	if (!dir) {
+		printf("%s: Can't open %s\n\r", __func__, LINUX_GPIO_SYSFS);
+		return FAILURE;
+	}
+
+	while ((entry = readdir(dir))) {
+		if (sscanf(entry->d_name, "gpiochip%u", &base) != 1)
+			continue;
+
+		snprintf(path, sizeof(path), LINUX_GPIO_SYSFS "/%s/ngpio",
+			 entry->d_name);
+		if (linux_gpio_read_attr(path, &ngpio) != SUCCESS)
+			continue;
+
+		if (number < base || number >= base + ngpio)
+			continue;
+
+		closedir(dir);
+		*offset = number - base;
+
+		return linux_gpio_sysfs_chip_id(base, chip_id);
+	}
+	closedir(dir);
+
+	printf("%s: GPIO %u not found\n\r", __func__, number);
+
+	return FAILURE;
+}
+
+/**
+ * @brief Get the current configuration flags of a line.
+ * @param chip_id - GPIO chip ID (/dev/gpiochip"chip_id").
+ * @param offset - The line offset.
+ * @param flags - The line flags.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_gpio_line_flags(uint32_t chip_id, uint32_t offset,
+				     uint64_t *flags)
+{
+	struct gpio_v2_line_info info;
+	char path[64];
+	int fd;
+	int ret;
 
-	fd = open("/sys/class/gpio/export", O_WRONLY);
+	snprintf(path, sizeof(path), "/dev/gpiochip%d", chip_id);
+	fd = open(path, O_RDWR | O_CLOEXEC);
 	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
-		free(descriptor);
+		printf("%s: Can't open %s\n\r", __func__, path);
 		return FAILURE;
 	}
 
-	len = sprintf(path, "%d", descriptor->number);
-	ret = write(fd, path, len);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		close(fd);
-		free(descriptor);
+	memset(&info, 0, sizeof(info));
+	info.offset = offset;
+	ret = ioctl(fd, GPIO_V2_GET_LINEINFO_IOCTL, &info);
+	close(fd);
+	if (ret == -1) {
+		printf("%s: Can't get line info\n\r", __func__);
 		return FAILURE;
 	}
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
-		free(descriptor);
+	*flags = info.flags;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Reconfigure a requested line.
+ * @param desc - The GPIO descriptor.
+ * @param flags - The new line flags.
+ * @param value - The output value, if flags selects an output.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t linux_gpio_set_config(struct gpio_desc *desc, uint64_t flags,
+				     uint8_t value)
+{
+	struct linux_gpio_desc *linux_desc = desc->extra;
+	struct gpio_v2_line_config config;
+	int ret;
+
+	memset(&config, 0, sizeof(config));
+	config.flags = flags;
+	if (flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+		/* Set the value in the same ioctl, without a glitch */
+		config.num_attrs = 1;
+		config.attrs[0].mask = 1;
+		config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		config.attrs[0].attr.values = value ? 1 : 0;
+	}
+
+	ret = ioctl(linux_desc->line_fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config);
+	if (ret == -1) {
+		printf("%s: Can't configure line\n\r", __func__);
 		return FAILURE;
 	}
 
+	linux_desc->flags = flags;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Obtain the GPIO decriptor.
+ * @param desc - The GPIO descriptor.
+ * @param param - GPIO initialization parameters
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_get(struct gpio_desc **desc,
+		 const struct gpio_init_param *param)
+{
+	struct linux_gpio_init_param *linux_init;
+	struct linux_gpio_desc *linux_desc;
+	struct gpio_v2_line_request req;
+	gpio_desc *descriptor;
+	uint32_t chip_id;
+	uint32_t offset;
+	int32_t ret;
+
+	descriptor = (gpio_desc *)malloc(sizeof(*descriptor));
+	if (!descriptor)
+		return FAILURE;
+
+	linux_desc = (struct linux_gpio_desc *)malloc(sizeof(*linux_desc));
+	if (!linux_desc)
+		goto free_desc;
+
+	descriptor->number = param->number;
+	descriptor->extra = linux_desc;
+
+	linux_init = param->extra;
+	if (linux_init) {
+		chip_id = linux_init->chip_id;
+		offset = param->number;
+	} else {
+		ret = linux_gpio_sysfs_lookup(param->number, &chip_id, &offset);
+		if (ret != SUCCESS)
+			goto free;
+	}
+
+	/* Request the line as-is, the direction is only set by
+	 * gpio_direction_input() and gpio_direction_output(). */
+	memset(&req, 0, sizeof(req));
+	req.offsets[0] = offset;
+	req.num_lines = 1;
+
+	ret = linux_gpio_request(chip_id, &req);
+	if (ret != SUCCESS)
+		goto free;
+
+	linux_desc->line_fd = req.fd;
+
+	ret = linux_gpio_line_flags(chip_id, offset, &linux_desc->flags);
+	if (ret != SUCCESS) {
+		close(req.fd);
+		goto free;
+	}
+
 	*desc = descriptor;
 
 	return SUCCESS;
+
+free:
+	free(linux_desc);
+free_desc:
+	free(descriptor);
+
+	return FAILURE;
 }
 
 /**
@@ -112,7 +373,13 @@ int32_t gpio_get(struct gpio_desc **desc,
 int32_t gpio_get_optional(struct gpio_desc **desc,
 			  const struct gpio_init_param *param)
 {
-	gpio_get(desc, param);
+	if (!param) {
+		*desc = NULL;
+		return SUCCESS;
+	}
+
+	if (gpio_get(desc, param) != SUCCESS)
+		*desc = NULL;
 
 	return SUCCESS;
 }
@@ -124,27 +391,17 @@ int32_t gpio_get_optional(struct gpio_desc **desc,
  */
 int32_t gpio_remove(struct gpio_desc *desc)
 {
-	char path[64];
-	int fd;
-	int len;
+	struct linux_gpio_desc *linux_desc;
 	int ret;
 
-	fd = open("/sys/class/gpio/unexport", O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
+	if (!desc)
 		return FAILURE;
-	}
 
-	len = sprintf(path, "%d", desc->number);
-	ret = write(fd, path, len);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		return FAILURE;
-	}
+	linux_desc = desc->extra;
 
-	ret = close(fd);
+	ret = close(linux_desc->line_fd);
 	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
+		printf("%s: Can't close line\n\r", __func__);
 		return FAILURE;
 	}
 
@@ -165,29 +422,16 @@ int32_t gpio_remove(struct gpio_desc *desc)
 int32_t gpio_set_value(struct gpio_desc *desc,
 		       uint8_t value)
 {
-	char path[64];
-	int fd;
+	struct linux_gpio_desc *linux_desc = desc->extra;
+	struct gpio_v2_line_values values;
 	int ret;
 
-	sprintf(path, "/sys/class/gpio/gpio%d/value", desc->number);
-	fd = open(path, O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
-		return FAILURE;
-	}
+	values.mask = 1;
+	values.bits = value ? 1 : 0;
 
-	if (value)
-		ret = write(fd, "1", 2);
-	else
-		ret = write(fd, "0", 2);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
-		return FAILURE;
-	}
-
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
+	ret = ioctl(linux_desc->line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &values);
+	if (ret == -1) {
+		printf("%s: Can't set value\n\r", __func__);
 		return FAILURE;
 	}
 
@@ -205,110 +449,262 @@ int32_t gpio_set_value(struct gpio_desc *desc,
 int32_t gpio_get_value(struct gpio_desc *desc,
 		       uint8_t *value)
 {
-	char path[64];
-	char data;
-	int fd;
+	struct linux_gpio_desc *linux_desc = desc->extra;
+	struct gpio_v2_line_values values;
 	int ret;
 
-	sprintf(path, "/sys/class/gpio/gpio%d/value", desc->number);
-	fd = open(path, O_RDONLY);
-	if (fd < 0) {
-		printf("%s: Can't open file\n\r", __func__);
-		return FAILURE;
-	}
+	values.mask = 1;
+	values.bits = 0;
 
-	ret = read(fd, &data, 1);
-	if (ret < 0) {
-		printf("%s: Can't read from file\n\r", __func__);
+	ret = ioctl(linux_desc->line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &values);
+	if (ret == -1) {
+		printf("%s: Can't get value\n\r", __func__);
 		return FAILURE;
 	}
 
-	if(data == '0')
-		*value = GPIO_LOW;
+	*value = (values.bits & 1) ? GPIO_HIGH : GPIO_LOW;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Enable the input direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_direction_input(struct gpio_desc *desc)
+{
+	return linux_gpio_set_config(desc, GPIO_V2_LINE_FLAG_INPUT, 0);
+}
+
+/**
+ * @brief Enable the output direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_direction_output(struct gpio_desc *desc,
+			      uint8_t value)
+{
+	return linux_gpio_set_config(desc, GPIO_V2_LINE_FLAG_OUTPUT, value);
+}
+
+/**
+ * @brief Get the direction of the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param direction - The direction.
+ *                    Example: GPIO_OUT
+ *                             GPIO_IN
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t gpio_get_direction(struct gpio_desc *desc,
+			   uint8_t *direction)
+{
+	struct linux_gpio_desc *linux_desc = desc->extra;
+
+	if (linux_desc->flags & GPIO_V2_LINE_FLAG_OUTPUT)
+		*direction = GPIO_OUT;
 	else
-		*value = GPIO_HIGH;
+		*direction = GPIO_IN;
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
+	return SUCCESS;
+}
+
+/**
+ * @brief Configure the line as an input reporting edge events on the file
+ *        descriptor returned by linux_gpio_get_event_fd().
+ * @param desc - The GPIO descriptor.
+ * @param edge - The edges to report.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t linux_gpio_set_edge(struct gpio_desc *desc, enum linux_gpio_edge edge)
+{
+	uint64_t flags = GPIO_V2_LINE_FLAG_INPUT;
+
+	if (edge == LINUX_GPIO_EDGE_RISING || edge == LINUX_GPIO_EDGE_BOTH)
+		flags |= GPIO_V2_LINE_FLAG_EDGE_RISING;
+	if (edge == LINUX_GPIO_EDGE_FALLING || edge == LINUX_GPIO_EDGE_BOTH)
+		flags |= GPIO_V2_LINE_FLAG_EDGE_FALLING;
+
+	return linux_gpio_set_config(desc, flags, 0);
+}
+
+/**
+ * @brief Get the file descriptor to poll() for line events.
+ * @param desc - The GPIO descriptor.
+ * @param fd - The line file descriptor, readable when an event is pending.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t linux_gpio_get_event_fd(struct gpio_desc *desc, int *fd)
+{
+	struct linux_gpio_desc *linux_desc = desc->extra;
+
+	if (!(linux_desc->flags & LINUX_GPIO_EDGE_FLAGS))
 		return FAILURE;
-	}
+
+	*fd = linux_desc->line_fd;
 
 	return SUCCESS;
 }
 
 /**
- * @brief Enable the input direction of the specified GPIO.
+ * @brief Read one line event, blocking until one is available.
  * @param desc - The GPIO descriptor.
+ * @param edge - The edge that generated the event.
+ * @param timestamp_ns - The event timestamp (CLOCK_MONOTONIC), in ns.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t gpio_direction_input(struct gpio_desc *desc)
+int32_t linux_gpio_read_event(struct gpio_desc *desc,
+			      enum linux_gpio_edge *edge,
+			      uint64_t *timestamp_ns)
 {
-	char path[64];
-	int fd;
-	int ret;
+	struct linux_gpio_desc *linux_desc = desc->extra;
+	struct gpio_v2_line_event event;
+	ssize_t ret;
 
-	sprintf(path, "/sys/class/gpio/gpio%d/direction", desc->number);
-	fd = open(path, O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
+	ret = read(linux_desc->line_fd, &event, sizeof(event));
+	if (ret != sizeof(event)) {
+		printf("%s: Can't read event\n\r", __func__);
 		return FAILURE;
 	}
 
-	ret = write(fd, "in", 3);
-	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
+	if (edge)
+		*edge = (event.id == GPIO_V2_LINE_EVENT_RISING_EDGE) ?
+			LINUX_GPIO_EDGE_RISING : LINUX_GPIO_EDGE_FALLING;
+	if (timestamp_ns)
+		*timestamp_ns = event.timestamp_ns;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Request several lines of a chip with one handle.
+ * @param desc - The bulk descriptor.
+ * @param chip_id - GPIO chip ID (/dev/gpiochip"chip_id").
+ * @param offsets - Line offsets within the chip.
+ * @param num_lines - Number of lines, at most LINUX_GPIO_BULK_MAX.
+ * @param output_mask - Lines to configure as outputs, the rest are inputs.
+ * @param values - Initial values of the output lines.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t linux_gpio_bulk_get(struct linux_gpio_bulk **desc, uint32_t chip_id,
+			    const uint32_t *offsets, uint32_t num_lines,
+			    uint64_t output_mask, uint64_t values)
+{
+	struct linux_gpio_bulk *descriptor;
+	struct gpio_v2_line_request req;
+	uint32_t i;
+	int32_t ret;
+
+	if (!num_lines || num_lines > LINUX_GPIO_BULK_MAX)
 		return FAILURE;
+
+	descriptor = (struct linux_gpio_bulk *)malloc(sizeof(*descriptor));
+	if (!descriptor)
+		return FAILURE;
+
+	memset(&req, 0, sizeof(req));
+	for (i = 0; i < num_lines; i++)
+		req.offsets[i] = offsets[i];
+	req.num_lines = num_lines;
+	req.config.flags = GPIO_V2_LINE_FLAG_INPUT;
+	if (output_mask) {
+		req.config.num_attrs = 2;
+		req.config.attrs[0].mask = output_mask;
+		req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_FLAGS;
+		req.config.attrs[0].attr.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+		req.config.attrs[1].mask = output_mask;
+		req.config.attrs[1].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		req.config.attrs[1].attr.values = values;
 	}
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
+	ret = linux_gpio_request(chip_id, &req);
+	if (ret != SUCCESS) {
+		free(descriptor);
 		return FAILURE;
 	}
 
+	descriptor->line_fd = req.fd;
+	descriptor->num_lines = num_lines;
+
+	*desc = descriptor;
+
 	return SUCCESS;
 }
 
 /**
- * @brief Enable the output direction of the specified GPIO.
- * @param desc - The GPIO descriptor.
- * @param value - The value.
- *                Example: GPIO_HIGH
- *                         GPIO_LOW
+ * @brief Free the resources allocated by linux_gpio_bulk_get().
+ * @param desc - The bulk descriptor.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t gpio_direction_output(struct gpio_desc *desc,
-			      uint8_t value)
+int32_t linux_gpio_bulk_remove(struct linux_gpio_bulk *desc)
 {
-	char path[64];
-	int fd;
 	int ret;
 
-	sprintf(path, "/sys/class/gpio/gpio%d/direction", desc->number);
-	fd = open(path, O_WRONLY);
-	if (fd < 0) {
-		printf("%s: Can't open device\n\r", __func__);
+	if (!desc)
 		return FAILURE;
-	}
 
-	ret = write(fd, "out", 4);
+	ret = close(desc->line_fd);
 	if (ret < 0) {
-		printf("%s: Can't write to file\n\r", __func__);
+		printf("%s: Can't close line\n\r", __func__);
 		return FAILURE;
 	}
 
-	ret = close(fd);
-	if (ret < 0) {
-		printf("%s: Can't close device\n\r", __func__);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the output lines selected by mask in a single ioctl.
+ * @param desc - The bulk descriptor.
+ * @param mask - Lines to set, bit n selects offsets[n].
+ * @param values - Line values, bit n is the value of offsets[n].
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t linux_gpio_bulk_set_values(struct linux_gpio_bulk *desc,
+				   uint64_t mask, uint64_t values)
+{
+	struct gpio_v2_line_values line_values;
+	int ret;
+
+	line_values.mask = mask;
+	line_values.bits = values;
+
+	ret = ioctl(desc->line_fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &line_values);
+	if (ret == -1) {
+		printf("%s: Can't set values\n\r", __func__);
 		return FAILURE;
 	}
 
-	ret = gpio_set_value(desc, value);
-	if (ret != SUCCESS) {
-		printf("%s: Can't set value\n\r", __func__);
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the lines selected by mask in a single ioctl.
+ * @param desc - The bulk descriptor.
+ * @param mask - Lines to get, bit n selects offsets[n].
+ * @param values - Line values, bit n is the value of offsets[n].
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t linux_gpio_bulk_get_values(struct linux_gpio_bulk *desc,
+				   uint64_t mask, uint64_t *values)
+{
+	struct gpio_v2_line_values line_values;
+	int ret;
+
+	line_values.mask = mask;
+	line_values.bits = 0;
+
+	ret = ioctl(desc->line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &line_values);
+	if (ret == -1) {
+		printf("%s: Can't get values\n\r", __func__);
 		return FAILURE;
 	}
 
+	*values = line_values.bits & mask;
+
 	return SUCCESS;
 }
@@ -0,0 +1,133 @@
+/*******************************************************************************
+ *   @file   linux/linux_gpio.h
+ *   @brief  Header containing extra types and functions used by the Linux
+ *           GPIO character device driver.
+ *   @author Dragos Bogdan (dragos.bogdan@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef LINUX_GPIO_H_
+#define LINUX_GPIO_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include "gpio.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Maximum number of lines requested through one bulk handle */
+#define LINUX_GPIO_BULK_MAX	64
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct linux_gpio_init_param
+ * @brief Structure holding the initialization parameters for Linux platform
+ * specific GPIO parameters. With it, gpio_init_param.number is a line offset
+ * on /dev/gpiochip"chip_id". Without it, gpio_init_param.number is the global
+ * GPIO number, as used by the sysfs interface, and is translated to a chip
+ * and line offset through /sys/class/gpio.
+ */
+struct linux_gpio_init_param {
+	/** GPIO chip ID (/dev/gpiochip"chip_id") */
+	uint32_t chip_id;
+};
+
+/**
+ * @enum linux_gpio_edge
+ * @brief Edges reported by the line event file descriptor.
+ */
+enum linux_gpio_edge {
+	/** No edge detection */
+	LINUX_GPIO_EDGE_NONE,
+	/** Rising edge */
+	LINUX_GPIO_EDGE_RISING,
+	/** Falling edge */
+	LINUX_GPIO_EDGE_FALLING,
+	/** Both edges */
+	LINUX_GPIO_EDGE_BOTH
+};
+
+/**
+ * @struct linux_gpio_bulk
+ * @brief Handle of several lines of the same chip, read and written with one
+ * ioctl. Bit n of the masks and values refers to offsets[n].
+ */
+struct linux_gpio_bulk {
+	/** Line request file descriptor */
+	int line_fd;
+	/** Number of lines */
+	uint32_t num_lines;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Request several lines of a chip as outputs or inputs. */
+int32_t linux_gpio_bulk_get(struct linux_gpio_bulk **desc, uint32_t chip_id,
+			    const uint32_t *offsets, uint32_t num_lines,
+			    uint64_t output_mask, uint64_t values);
+
+/* Free the resources allocated by linux_gpio_bulk_get(). */
+int32_t linux_gpio_bulk_remove(struct linux_gpio_bulk *desc);
+
+/* Set the output lines selected by mask in a single ioctl. */
+int32_t linux_gpio_bulk_set_values(struct linux_gpio_bulk *desc,
+				   uint64_t mask, uint64_t values);
+
+/* Get the lines selected by mask in a single ioctl. */
+int32_t linux_gpio_bulk_get_values(struct linux_gpio_bulk *desc,
+				   uint64_t mask, uint64_t *values);
+
+/* Configure the line as an input reporting edge events. */
+int32_t linux_gpio_set_edge(struct gpio_desc *desc, enum linux_gpio_edge edge);
+
+/* Get the file descriptor to poll() for line events. */
+int32_t linux_gpio_get_event_fd(struct gpio_desc *desc, int *fd);
+
+/* Read one line event, blocking until one is available. */
+int32_t linux_gpio_read_event(struct gpio_desc *desc,
+			      enum linux_gpio_edge *edge,
+			      uint64_t *timestamp_ns);
+
+#endif // LINUX_GPIO_H_
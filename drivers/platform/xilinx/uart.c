@@ -35,12 +35,13 @@
 #include <xparameters.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "error.h"
+#include "util.h"
 #include "uart.h"
 #include "uart_extra.h"
 #ifdef XPAR_XUARTPS_NUM_INSTANCES
 #include "irq.h"
-#include "fifo.h"
 #include <xil_exception.h>
 #include <xuartps.h>
 #endif
@@ -61,109 +62,153 @@
 
 #ifdef XUARTPS_H
 /**
- * @brief Save received data into fifo.
- * @param desc - Instance descriptor containing a fifo element.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @brief Point the driver receive at the free space of the ring.
+ *
+ * The XUartPs driver copies the received bytes straight into the ring. When
+ * the ring is full, the bytes go to a scratch buffer and are counted as lost.
+ * Called from the interrupt handler, or with the interrupt disabled.
+ * @param xil_uart_desc - Platform specific UART descriptor.
  */
-static int32_t uart_fifo_insert(struct uart_desc *desc)
+static void uart_rx_arm(struct xil_uart_desc *xil_uart_desc)
+{
+	uint32_t idx, len, received;
+
+	while (true) {
+		idx = xil_uart_desc->rx_head & (UART_RX_RING_SIZE - 1);
+		len = UART_RX_RING_SIZE -
+		      (xil_uart_desc->rx_head - xil_uart_desc->rx_tail);
+		len = min(len, UART_RX_RING_SIZE - idx);
+		if (!len) {
+			xil_uart_desc->rx_armed = false;
+			xil_uart_desc->total_error_count++;
+			XUartPs_Recv(xil_uart_desc->instance,
+				     (u8 *)xil_uart_desc->buff, UART_BUFF_LENGTH);
+			return;
+		}
+
+		xil_uart_desc->rx_armed = true;
+		received = XUartPs_Recv(xil_uart_desc->instance,
+					xil_uart_desc->rx_ring + idx, len);
+		/*
+		 * A receive completed on the spot raises no event, account
+		 * for it here and go on with the next span.
+		 */
+		if (received < len)
+			return;
+		xil_uart_desc->rx_head += received;
+	}
+}
+
+/**
+ * @brief Move the receive back to the ring once the reader made room.
+ * @param desc - Instance of UART.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t uart_rx_restart(struct uart_desc *desc)
 {
-	int32_t ret;
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
-	struct irq_ctrl_desc *irq_desc = xil_uart_desc->irq_desc;
-
-	if (xil_uart_desc->bytes_received > 0) {
-		ret = irq_disable(irq_desc, xil_uart_desc->irq_id);
-		if (ret < 0)
-			return ret;
-		ret = fifo_insert(&xil_uart_desc->fifo, xil_uart_desc->buff,
-				  xil_uart_desc->bytes_received);
-		if (ret < 0)
-			return ret;
-		xil_uart_desc->bytes_received = 0;
-		switch(xil_uart_desc->type) {
-		case UART_PS:
-			XUartPs_Recv(xil_uart_desc->instance, (u8*)(xil_uart_desc->buff),
-				     UART_BUFF_LENGTH);
-			break;
-		case UART_PL:
+	XUartPs *instance = xil_uart_desc->instance;
+	int32_t ret;
 
-			break;
-		default:
-			return FAILURE;
-			break;
-		}
-		ret = irq_enable(irq_desc, xil_uart_desc->irq_id);
-		if (ret < 0)
-			return ret;
+	ret = irq_disable(xil_uart_desc->irq_desc, xil_uart_desc->irq_id);
+	if (ret < 0)
+		return ret;
+
+	if (!xil_uart_desc->rx_armed) {
+		xil_uart_desc->rx_overflow +=
+			instance->ReceiveBuffer.RequestedBytes -
+			instance->ReceiveBuffer.RemainingBytes;
+		uart_rx_arm(xil_uart_desc);
 	}
 
-	return SUCCESS;
+	return irq_enable(xil_uart_desc->irq_desc, xil_uart_desc->irq_id);
 }
-#endif // XUARTPS_H
 
 /**
- * @brief Read byte from fifo.
- * @param desc - Instance descriptor containing a fifo element
- * @param data - read value.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @brief Read data from the receive ring, waiting until enough was received.
+ * @param desc - Instance of UART.
+ * @param data - Pointer to buffer containing data.
+ * @param bytes_number - Number of bytes to read.
+ * @return Number of bytes read, negative error code otherwise.
  */
-static int32_t uart_read_byte(struct uart_desc *desc, uint8_t *data)
+static int32_t uart_read_ring(struct uart_desc *desc, uint8_t *data,
+			      uint32_t bytes_number)
 {
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
-#ifdef XUARTLITE_H
-	XUartLite *instance = xil_uart_desc->instance;
-#endif
-#ifdef XUARTPS_H
+	uint32_t idx, len, remaining = bytes_number;
 	int32_t ret;
-#endif
 
-	switch(xil_uart_desc->type) {
-	case UART_PS:
-#ifdef XUARTPS_H
-		while (xil_uart_desc->fifo == NULL) {
-			/* nothing in fifo, wait until something is received */
-			ret = uart_fifo_insert(desc);
+	while (remaining) {
+		idx = xil_uart_desc->rx_tail & (UART_RX_RING_SIZE - 1);
+		len = xil_uart_desc->rx_head - xil_uart_desc->rx_tail;
+		len = min(len, UART_RX_RING_SIZE - idx);
+		len = min(len, remaining);
+		if (len) {
+			memcpy(data, xil_uart_desc->rx_ring + idx, len);
+			xil_uart_desc->rx_tail += len;
+			data += len;
+			remaining -= len;
+		}
+
+		if (!xil_uart_desc->rx_armed) {
+			ret = uart_rx_restart(desc);
 			if (ret < 0)
 				return ret;
 		}
+	}
 
-		*data = xil_uart_desc->fifo->data[xil_uart_desc->fifo_read_offset];
-		xil_uart_desc->fifo_read_offset++;
-
-		if (xil_uart_desc->fifo->len - xil_uart_desc->fifo_read_offset <= 0) {
-			xil_uart_desc->fifo_read_offset = 0;
-			xil_uart_desc->fifo = fifo_remove(xil_uart_desc->fifo);
-		}
+	return bytes_number;
+}
 #endif // XUARTPS_H
-		break;
-	case UART_PL:
+
 #ifdef XUARTLITE_H
-		while (!(Xil_In32(instance->RegBaseAddress + XUL_STATUS_REG_OFFSET) &
-			 XUL_SR_RX_FIFO_VALID_DATA));
-		*data = Xil_In32(instance->RegBaseAddress + XUL_RX_FIFO_OFFSET);
-#endif // XUARTLITE_H
-		break;
-	default:
-		break;
-	}
+/**
+ * @brief Read byte from the UART Lite receive FIFO.
+ * @param desc - Instance of UART.
+ * @param data - read value.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t uart_read_byte(struct uart_desc *desc, uint8_t *data)
+{
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
+	XUartLite *instance = xil_uart_desc->instance;
+
+	while (!(Xil_In32(instance->RegBaseAddress + XUL_STATUS_REG_OFFSET) &
+		 XUL_SR_RX_FIFO_VALID_DATA));
+	*data = Xil_In32(instance->RegBaseAddress + XUL_RX_FIFO_OFFSET);
 
 	return SUCCESS;
 }
+#endif // XUARTLITE_H
 
 /**
  * @brief Read data from UART device.
  * @param desc - Instance of UART.
  * @param data - Pointer to buffer containing data.
  * @param bytes_number - Number of bytes to read.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @return Number of bytes read in case of success, FAILURE otherwise.
  */
 int32_t uart_read(struct uart_desc *desc, uint8_t *data, uint32_t bytes_number)
 {
-	ssize_t ret;
-	for (uint32_t i = 0; i < bytes_number; i++) {
-		ret = uart_read_byte(desc, &data[i]);
-		if (ret < 0)
-			return ret;
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
+#ifdef XUARTLITE_H
+	uint32_t i;
+#endif
+
+	switch(xil_uart_desc->type) {
+	case UART_PS:
+#ifdef XUARTPS_H
+		return uart_read_ring(desc, data, bytes_number);
+#endif // XUARTPS_H
+		break;
+	case UART_PL:
+#ifdef XUARTLITE_H
+		for (i = 0; i < bytes_number; i++)
+			uart_read_byte(desc, &data[i]);
+#endif // XUARTLITE_H
+		break;
+	default:
+		return FAILURE;
 	}
 
 	return bytes_number;
@@ -242,7 +287,11 @@ static void uart_irq_handler(void *call_back_ref, uint32_t event,
 		 * timeout just indicates the data stopped for configured character time
 		 */
 		case XUARTPS_EVENT_RECV_TOUT:
-			xil_uart_desc->bytes_received = data_len;
+			if (xil_uart_desc->rx_armed)
+				xil_uart_desc->rx_head += data_len;
+			else
+				xil_uart_desc->rx_overflow += data_len;
+			uart_rx_arm(xil_uart_desc);
 			break;
 		/*
 		 * Data was received with an error, keep the data but determine
@@ -402,8 +451,7 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 
 		*desc = descriptor;
 
-		XUartPs_Recv(xil_uart_desc->instance, (u8*)xil_uart_desc->buff,
-			     UART_BUFF_LENGTH);
+		uart_rx_arm(xil_uart_desc);
 
 		break;
 #endif // XUARTPS_H
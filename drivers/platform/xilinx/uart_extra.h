@@ -44,11 +44,18 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include <stdbool.h>
+#include <stdint.h>
+
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
 #define UART_BUFF_LENGTH 256
+/* Size of the PS UART receive ring, a power of two */
+#ifndef UART_RX_RING_SIZE
+#define UART_RX_RING_SIZE 4096
+#endif
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -90,15 +97,19 @@ struct xil_uart_desc {
 	uint32_t			irq_id;
 	/** Interrupt Request Descriptor */
 	struct irq_ctrl_desc *irq_desc;
-	/** FIFO */
-	struct fifo_element	*fifo;
-	/** FIFO read offset */
-	uint32_t 			fifo_read_offset;
-	/** UART Buffer */
+	/** Receive ring, filled from the interrupt handler */
+	uint8_t				rx_ring[UART_RX_RING_SIZE];
+	/** Ring write position, free running */
+	volatile uint32_t		rx_head;
+	/** Ring read position, free running */
+	volatile uint32_t		rx_tail;
+	/** False while the ring is full and bytes go to buff */
+	volatile bool			rx_armed;
+	/** Number of bytes lost because the ring was full */
+	uint32_t			rx_overflow;
+	/** Scratch buffer for bytes received while the ring is full */
 	char 				buff[UART_BUFF_LENGTH];
-	/** Number of bytes received */
-	uint32_t 			bytes_received;
-	/** Total number of errors */
+	/** Total number of errors, ring overflows included */
 	uint32_t 			total_error_count;
 	/** UART Instance */
 	void				*instance;
@@ -59,6 +59,10 @@
 
 #define CMD0_RETRY_NUMBER		(5u)
 #define WAIT_RESP_TIMEOUT		(1000u) //1000ms
+/* Polls done back to back before backing off to one per millisecond */
+#define FAST_POLL_NUMBER		(1024u)
+/* Bytes clocked per busy poll */
+#define BUSY_POLL_LEN			(8u)
 
 #define R1_READY_STATE			(0x00u)
 #define R1_IDLE_STATE			(0x01u)
@@ -99,23 +103,39 @@
  */
 static int32_t wait_for_response(struct sd_desc *sd_desc, uint8_t *data_out)
 {
-	uint32_t	not_timeout;
-	int32_t		ret;
+	uint32_t	polls;
 
-	ret = FAILURE;
-	not_timeout = WAIT_RESP_TIMEOUT;
-	do {
+	/* Responses usually come within a few bytes, so poll without delay */
+	for (polls = 0; polls < FAST_POLL_NUMBER + WAIT_RESP_TIMEOUT; polls++) {
+		*data_out = 0xFF;
 		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc,
 						  data_out, 1))
-			break;
-		if (*data_out != 0xFF) {
-			ret = SUCCESS;
-			break;
-		}
-		mdelay(1);
-	} while (not_timeout--);
+			return FAILURE;
+		if (*data_out != 0xFF)
+			return SUCCESS;
+		if (polls >= FAST_POLL_NUMBER)
+			mdelay(1);
+	}
 
-	return ret;
+	return FAILURE;
+}
+
+/**
+ * Check once if the SD card is busy
+ * @param sd_desc	- Instance of the SD card
+ * @param busy		- true if the card still holds the data line low
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t poll_busy(struct sd_desc *sd_desc, bool *busy)
+{
+	/* Extra bytes clocked after the busy phase are ignored by the card */
+	memset(sd_desc->buff, 0xFF, BUSY_POLL_LEN);
+	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff,
+					  BUSY_POLL_LEN))
+		return FAILURE;
+	*busy = (sd_desc->buff[BUSY_POLL_LEN - 1] == 0x00);
+
+	return SUCCESS;
 }
 
 /**
@@ -125,24 +145,19 @@ static int32_t wait_for_response(struct sd_desc *sd_desc, uint8_t *data_out)
  */
 static int32_t wait_until_not_busy(struct sd_desc *sd_desc)
 {
-	uint32_t	not_timeout;
-	int32_t		ret;
-	uint8_t		data;
+	uint32_t	polls;
+	bool		busy;
 
-	ret = FAILURE;
-	not_timeout = WAIT_RESP_TIMEOUT;
-	do {
-		data = 0xFF;
-		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, &data, 1))
-			break;
-		if (data != 0x00) {
-			ret = SUCCESS;
-			break;
-		}
-		mdelay(1);
-	} while (not_timeout--);
+	for (polls = 0; polls < FAST_POLL_NUMBER + WAIT_RESP_TIMEOUT; polls++) {
+		if (SUCCESS != poll_busy(sd_desc, &busy))
+			return FAILURE;
+		if (!busy)
+			return SUCCESS;
+		if (polls >= FAST_POLL_NUMBER)
+			mdelay(1);
+	}
 
-	return ret;
+	return FAILURE;
 }
 
 /**
@@ -175,7 +190,8 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 		cmd_desc_local.response_len = R1_LEN;
 		if (SUCCESS != send_command(sd_desc, &cmd_desc_local))
 			return FAILURE;
-		if (cmd_desc_local.response[0] != R1_IDLE_STATE) {
+		/* The card is idle during initialization, ready after */
+		if (cmd_desc_local.response[0] & ~R1_IDLE_STATE) {
 			DEBUG_MSG("Not the expected response for CMD55\n");
 			return FAILURE;
 		}
@@ -211,14 +227,14 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 }
 
 /**
- * Send one block of data to the SD card
+ * Send one block of data to the SD card and check the data response
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to be written
  * @param nb_of_blocks	- Number of blocks written in the executing command
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
-			   uint32_t nb_of_blocks)
+static int32_t send_block(struct sd_desc *sd_desc, const uint8_t *data,
+			  uint32_t nb_of_blocks)
 {
 	/* Send start block token */
 	sd_desc->buff[0] = START_N_BLOCK_TOKEN;
@@ -228,8 +244,16 @@ static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
 		return FAILURE;
 
 	/* Send data with CRC */
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, data, DATA_BLOCK_LEN))
-		return FAILURE;
+	if (sd_desc->block_write) {
+		if (SUCCESS != sd_desc->block_write(sd_desc->block_write_ctx, data,
+						    DATA_BLOCK_LEN))
+			return FAILURE;
+	} else {
+		memcpy(sd_desc->tx_block, data, DATA_BLOCK_LEN);
+		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->tx_block,
+						  DATA_BLOCK_LEN))
+			return FAILURE;
+	}
 	*((uint16_t *)sd_desc->buff) = 0xFFFF;
 	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, CRC_LEN))
 		return FAILURE;
@@ -251,6 +275,22 @@ static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
 		DEBUG_MSG("Other problem\n");
 		return FAILURE;
 	}
+
+	return SUCCESS;
+}
+
+/**
+ * Send one block of data to the SD card
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data to be written
+ * @param nb_of_blocks	- Number of blocks written in the executing command
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
+			   uint32_t nb_of_blocks)
+{
+	if (SUCCESS != send_block(sd_desc, data, nb_of_blocks))
+		return FAILURE;
 	if (SUCCESS != wait_until_not_busy(sd_desc))
 		return FAILURE;
 
@@ -405,6 +445,41 @@ static int32_t read_multiple_blocks(struct sd_desc *sd_desc,
 	return SUCCESS;
 }
 
+/**
+ * Send the write command, preceded by a pre-erase hint for multiple blocks
+ * @param sd_desc	- Instance of the SD card
+ * @param address	- Address in memory where data will be written
+ * @param nb_of_blocks	- Number of blocks to be written
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t start_write(struct sd_desc *sd_desc, uint64_t address,
+			   uint32_t nb_of_blocks)
+{
+	struct cmd_desc	cmd_desc;
+
+	if (nb_of_blocks != 1) {
+		/* ACMD23 lets the card erase the blocks ahead of the data. It
+		 * is only a hint, so its response is not checked */
+		cmd_desc.cmd = ACMD(23);
+		cmd_desc.arg = nb_of_blocks & 0x7FFFFFu;
+		cmd_desc.response_len = R1_LEN;
+		if (SUCCESS != send_command(sd_desc, &cmd_desc))
+			return FAILURE;
+	}
+
+	cmd_desc.cmd = (nb_of_blocks == 1) ? CMD(24): CMD(25);
+	cmd_desc.arg = address >> DATA_BLOCK_BITS; //Address of first block
+	cmd_desc.response_len = R1_LEN;
+	if (SUCCESS != send_command(sd_desc, &cmd_desc))
+		return FAILURE;
+	if (cmd_desc.response[0] != R1_READY_STATE) {
+		DEBUG_MSG("Failed to write Data command\n");
+		return FAILURE;
+	}
+
+	return SUCCESS;
+}
+
 /**
  * Read data of size len from the specified address and store it in data.
  * This operation returns only when the read is complete
@@ -425,6 +500,9 @@ int32_t sd_read(struct sd_desc *sd_desc,
 	    address + len > sd_desc->memory_size)
 		return FAILURE;
 
+	if (SUCCESS != sd_async_wait(sd_desc))
+		return FAILURE;
+
 	/* Send read command */
 	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(17): CMD(18);
 	cmd_desc.arg = address >> DATA_BLOCK_BITS;;
@@ -451,6 +529,9 @@ int32_t sd_read(struct sd_desc *sd_desc,
 			DEBUG_MSG("Failed to send stop transmission command\n");
 			return FAILURE;
 		}
+		/* CMD12 has a R1b response */
+		if (SUCCESS != wait_until_not_busy(sd_desc))
+			return FAILURE;
 	}
 
 	return SUCCESS;
@@ -468,7 +549,6 @@ int32_t sd_read(struct sd_desc *sd_desc,
 int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 		 uint64_t len)
 {
-	struct cmd_desc	cmd_desc;
 	uint8_t		first_block[DATA_BLOCK_LEN] __attribute__ ((aligned));
 	uint8_t		last_block[DATA_BLOCK_LEN] __attribute__ ((aligned));
 
@@ -477,6 +557,9 @@ int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 	    len > sd_desc->memory_size || address + len > sd_desc->memory_size)
 		return FAILURE;
 
+	if (SUCCESS != sd_async_wait(sd_desc))
+		return FAILURE;
+
 	/* Read first and last block in memory if needed to be updated with user data and then written back                                                                        */
 	/* If not writing from the beginning of a block or */
 	if ((address & MASK_ADDR_IN_BLOCK) != 0 ||
@@ -491,15 +574,9 @@ int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 			DATA_BLOCK_LEN);
 
 	/* Send write command to SD */
-	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(24): CMD(25);
-	cmd_desc.arg = address >> DATA_BLOCK_BITS; //Address of first block
-	cmd_desc.response_len = R1_LEN;
-	if (SUCCESS != send_command(sd_desc, &cmd_desc))
+	if (SUCCESS != start_write(sd_desc, address,
+				   get_nb_of_blocks(address, len)))
 		return FAILURE;
-	if (cmd_desc.response[0] != R1_READY_STATE) {
-		DEBUG_MSG("Failed to write Data command\n");
-		return FAILURE;
-	}
 
 	/* Write blocks */
 	if (SUCCESS != write_multiple_blocks(sd_desc, data, address, len,
@@ -519,6 +596,150 @@ int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 	return SUCCESS;
 }
 
+/**
+ * Start writing whole blocks and return once the first one is sent. The
+ * write is carried on by sd_async_poll() and data must stay valid until it
+ * completes.
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data to write
+ * @param address	- Address in memory where data will be written, block
+ * 			  aligned
+ * @param len		- Length of data in bytes, multiple of the block length
+ * @return -EBUSY while the write is in progress, SUCCESS if it is already
+ * complete, FAILURE otherwise.
+ */
+int32_t sd_write_async(struct sd_desc *sd_desc, const uint8_t *data,
+		       uint64_t address, uint64_t len)
+{
+	uint32_t	nb_of_blocks;
+
+	/* Initial checks */
+	if (data == NULL || len == 0 || address > sd_desc->memory_size ||
+	    len > sd_desc->memory_size || address + len > sd_desc->memory_size ||
+	    (address & MASK_ADDR_IN_BLOCK) || (len & MASK_ADDR_IN_BLOCK))
+		return FAILURE;
+
+	if (sd_desc->async_state != SD_ASYNC_IDLE)
+		return -EBUSY;
+
+	nb_of_blocks = len >> DATA_BLOCK_BITS;
+	if (SUCCESS != start_write(sd_desc, address, nb_of_blocks))
+		return FAILURE;
+
+	sd_desc->async_data = data;
+	sd_desc->async_blocks = nb_of_blocks;
+	sd_desc->async_idx = 0;
+	sd_desc->async_state = SD_ASYNC_SEND;
+
+	return sd_async_poll(sd_desc);
+}
+
+/**
+ * Abort the asynchronous write. A multiple block write is closed with the
+ * stop transmission token, so the card leaves the receive data state before
+ * the next command.
+ * @param sd_desc	- Instance of the SD card
+ */
+static void async_abort(struct sd_desc *sd_desc)
+{
+	if (sd_desc->async_blocks > 1 &&
+	    sd_desc->async_state != SD_ASYNC_STOP) {
+		wait_until_not_busy(sd_desc);
+		sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
+		sd_desc->buff[1] = 0xFF;
+		spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2);
+	}
+	wait_until_not_busy(sd_desc);
+
+	sd_desc->async_state = SD_ASYNC_IDLE;
+}
+
+/**
+ * Advance the asynchronous write without waiting for the card. The next
+ * block is sent as soon as the card finishes programming the previous one.
+ * Sending a block does not return before the transfer ends, only the time
+ * the card spends programming is left to the caller.
+ * @param sd_desc	- Instance of the SD card
+ * @return -EBUSY while the write is in progress, SUCCESS once it is complete
+ * or if there is none, FAILURE otherwise.
+ */
+int32_t sd_async_poll(struct sd_desc *sd_desc)
+{
+	bool	busy;
+
+	switch (sd_desc->async_state) {
+	case SD_ASYNC_IDLE:
+		return SUCCESS;
+	case SD_ASYNC_SEND:
+		if (SUCCESS != send_block(sd_desc, sd_desc->async_data +
+					  sd_desc->async_idx * DATA_BLOCK_LEN,
+					  sd_desc->async_blocks))
+			goto failure;
+		sd_desc->async_state = SD_ASYNC_BUSY;
+		return -EBUSY;
+	case SD_ASYNC_BUSY:
+	case SD_ASYNC_STOP:
+		if (SUCCESS != poll_busy(sd_desc, &busy))
+			goto failure;
+		if (busy)
+			return -EBUSY;
+		break;
+	default:
+		goto failure;
+	}
+
+	if (sd_desc->async_state == SD_ASYNC_STOP ||
+	    sd_desc->async_blocks == 1) {
+		sd_desc->async_state = SD_ASYNC_IDLE;
+		return SUCCESS;
+	}
+
+	if (++sd_desc->async_idx < sd_desc->async_blocks) {
+		sd_desc->async_state = SD_ASYNC_SEND;
+		return sd_async_poll(sd_desc);
+	}
+
+	/* Send stop transmission token */
+	sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
+	sd_desc->buff[1] = 0xFF;
+	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2))
+		goto failure;
+	sd_desc->async_state = SD_ASYNC_STOP;
+
+	return -EBUSY;
+failure:
+	async_abort(sd_desc);
+	return FAILURE;
+}
+
+/**
+ * Wait for the asynchronous write to complete
+ * @param sd_desc	- Instance of the SD card
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sd_async_wait(struct sd_desc *sd_desc)
+{
+	uint32_t	polls;
+	uint32_t	idx;
+	int32_t		ret;
+
+	for (polls = 0; polls < FAST_POLL_NUMBER + WAIT_RESP_TIMEOUT; polls++) {
+		idx = sd_desc->async_idx;
+		ret = sd_async_poll(sd_desc);
+		if (ret != -EBUSY)
+			return ret;
+		/* The timeout applies to each block */
+		if (sd_desc->async_idx != idx)
+			polls = 0;
+		else if (polls >= FAST_POLL_NUMBER)
+			mdelay(1);
+	}
+
+	async_abort(sd_desc);
+
+	return FAILURE;
+}
+
 /**
  * Initialize an instance of SD card and stores it to the parameter desc
  * @param sd_desc	- Pointer where to store the instance of the SD
@@ -539,6 +760,9 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 	if (!local_desc)
 		return FAILURE;
 	local_desc->spi_desc = param->spi_desc;
+	local_desc->block_write = param->block_write;
+	local_desc->block_write_ctx = param->block_write_ctx;
+	local_desc->async_state = SD_ASYNC_IDLE;
 
 	/* Synchronize SD card frequency: Send 10 dummy bytes*/
 	memset(local_desc->buff, 0xFF, 10);
@@ -623,6 +847,10 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 	local_desc->memory_size = ((uint64_t)c_size + 1) *
 				  ((uint64_t)DATA_BLOCK_LEN << 10u);
 
+	/* Identification is done, the card accepts up to 25 MHz from now on */
+	if (param->high_speed_hz)
+		local_desc->spi_desc->max_speed_hz = param->high_speed_hz;
+
 	*sd_desc = local_desc;
 
 	return SUCCESS;
@@ -85,6 +85,32 @@
 struct sd_init_param {
 	/** Descriptor of an initialized SPI channel */
 	struct spi_desc *spi_desc;
+	/** SPI clock set once the card is initialized, 0 to keep the current
+	 *  one. The platform must apply spi_desc->max_speed_hz on transfer */
+	uint32_t high_speed_hz;
+	/** Optional transmit-only transfer used for the data blocks, e.g. a DMA
+	 *  transfer. It must not modify the data and must only return once the
+	 *  whole block is sent, it saves the copy made for spi_write_and_read()
+	 *  but does not run in the background. NULL to use
+	 *  spi_write_and_read() */
+	int32_t (*block_write)(void *ctx, const uint8_t *data, uint32_t len);
+	/** Context passed to block_write */
+	void *block_write_ctx;
+};
+
+/**
+ * @enum sd_async_state
+ * @brief State of an asynchronous write
+ */
+enum sd_async_state {
+	/** No write in progress */
+	SD_ASYNC_IDLE,
+	/** Next data block to be sent */
+	SD_ASYNC_SEND,
+	/** Card busy programming a data block */
+	SD_ASYNC_BUSY,
+	/** Card busy after the stop transmission token */
+	SD_ASYNC_STOP
 };
 
 /**
@@ -100,6 +126,21 @@ struct sd_desc {
 	uint8_t		high_capacity;
 	/** Buffer used for the driver implementation */
 	uint8_t		buff[18];
+	/** Transmit-only transfer for the data blocks, NULL if not used */
+	int32_t		(*block_write)(void *ctx, const uint8_t *data,
+				       uint32_t len);
+	/** Context passed to block_write */
+	void		*block_write_ctx;
+	/** Copy of the transmitted block, spi_write_and_read() overwrites it */
+	uint8_t		tx_block[DATA_BLOCK_LEN];
+	/** State of the asynchronous write */
+	enum sd_async_state	async_state;
+	/** Data of the asynchronous write */
+	const uint8_t	*async_data;
+	/** Number of blocks of the asynchronous write */
+	uint32_t	async_blocks;
+	/** Index of the block being written */
+	uint32_t	async_idx;
 };
 
 /**
@@ -132,6 +173,12 @@ int32_t sd_write(struct sd_desc *desc,
 		 uint8_t *data,
 		 uint64_t address,
 		 uint64_t len);
+int32_t sd_write_async(struct sd_desc *desc,
+		       const uint8_t *data,
+		       uint64_t address,
+		       uint64_t len);
+int32_t sd_async_poll(struct sd_desc *desc);
+int32_t sd_async_wait(struct sd_desc *desc);
 
 #endif /* __SD_H__ */
 
@@ -80,11 +80,37 @@ struct element_info {
 	bool ch_out;
 };
 
+/**
+ * @struct iio_attr_cache
+ * @brief Last value shown by a cached attribute of an interface.
+ */
+struct iio_attr_cache {
+	/** Cached attribute */
+	struct iio_attribute *attr;
+	/** Channel of the attribute, NULL for device attributes */
+	struct iio_channel *channel;
+	/** Last value, NULL terminated */
+	char *value;
+	/** Length of value */
+	size_t len;
+	/** Time the value was read at, in milliseconds */
+	uint32_t stamp;
+	/** Value can be returned without reading the device */
+	bool valid;
+	/** Next cached attribute of the interface */
+	struct iio_attr_cache *next;
+};
+
 /**
  * iio_read_attr(), iio_write_attr() functions, they need to know about iio_interfaces
  */
 static struct iio_interfaces *iio_interfaces = NULL;
 
+/**
+ * Millisecond time source used by the attribute cache
+ */
+static uint32_t (*iio_get_time_ms)(void) = NULL;
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -179,17 +205,152 @@ static struct iio_interface *iio_get_interface(const char *device_name,
 	return NULL;
 }
 
+/**
+ * @brief Get the cache entry of an attribute, creating it if needed.
+ * @param iface - Interface of the device.
+ * @param channel - Channel of the attribute, NULL for device attributes.
+ * @param attr - Attribute.
+ * @return Cache entry, NULL if it can't be allocated.
+ */
+static struct iio_attr_cache *iio_attr_cache_get(struct iio_interface *iface,
+		struct iio_channel *channel, struct iio_attribute *attr)
+{
+	struct iio_attr_cache *entry;
+
+	for (entry = iface->attr_cache; entry; entry = entry->next)
+		if (entry->attr == attr && entry->channel == channel)
+			return entry;
+
+	entry = (struct iio_attr_cache *)calloc(1, sizeof(*entry));
+	if (!entry)
+		return NULL;
+
+	entry->attr = attr;
+	entry->channel = channel;
+	entry->next = iface->attr_cache;
+	iface->attr_cache = entry;
+
+	return entry;
+}
+
+/**
+ * @brief Drop cached values of an interface.
+ * @param iface - Interface of the device.
+ * @param attr - Attribute to drop, NULL to drop all the attributes.
+ */
+static void iio_attr_cache_invalidate(struct iio_interface *iface,
+				      struct iio_attribute *attr)
+{
+	struct iio_attr_cache *entry;
+
+	for (entry = iface->attr_cache; entry; entry = entry->next)
+		if (!attr || entry->attr == attr)
+			entry->valid = false;
+}
+
+/**
+ * @brief Free the cache entries of an interface.
+ * @param iface - Interface of the device.
+ */
+static void iio_attr_cache_free(struct iio_interface *iface)
+{
+	struct iio_attr_cache *entry;
+
+	while (iface->attr_cache) {
+		entry = iface->attr_cache;
+		iface->attr_cache = entry->next;
+		free(entry->value);
+		free(entry);
+	}
+}
+
+/**
+ * @brief Show an attribute. Values of attributes with cache_ms set are reused
+ * for cache_ms when a time source was given to iio_init().
+ * @param iface - Interface of the device.
+ * @param channel - Channel of the attribute, NULL for device attributes.
+ * @param attr - Attribute.
+ * @param buf - Buffer where value is read.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param ch_info - Channel properties.
+ * @return Length of chars read or negative value in case of error.
+ */
+static ssize_t iio_attr_show(struct iio_interface *iface,
+			     struct iio_channel *channel,
+			     struct iio_attribute *attr, char *buf, size_t len,
+			     const struct iio_ch_info *ch_info)
+{
+	struct iio_attr_cache *entry;
+	uint32_t now;
+	ssize_t ret;
+	char *value;
+
+	if (!attr->cache_ms || !iio_get_time_ms)
+		return attr->show(iface->dev_instance, buf, len, ch_info);
+
+	now = iio_get_time_ms();
+	entry = iio_attr_cache_get(iface, channel, attr);
+	if (entry && entry->valid && now - entry->stamp < attr->cache_ms &&
+	    entry->len < len) {
+		memcpy(buf, entry->value, entry->len + 1);
+		return entry->len;
+	}
+
+	ret = attr->show(iface->dev_instance, buf, len, ch_info);
+	if (!entry)
+		return ret;
+
+	entry->valid = false;
+	if (IS_ERR_VALUE(ret) || (size_t)ret >= len)
+		return ret;
+
+	value = (char *)realloc(entry->value, ret + 1);
+	if (!value)
+		return ret;
+
+	memcpy(value, buf, ret);
+	value[ret] = '\0';
+	entry->value = value;
+	entry->len = ret;
+	entry->stamp = now;
+	entry->valid = true;
+
+	return ret;
+}
+
+/**
+ * @brief Store an attribute and drop its cached values.
+ * @param iface - Interface of the device.
+ * @param attr - Attribute.
+ * @param buf - Value to be written.
+ * @param len - Length of buf.
+ * @param ch_info - Channel properties.
+ * @return Length of chars written or negative value in case of error.
+ */
+static ssize_t iio_attr_store(struct iio_interface *iface,
+			      struct iio_attribute *attr, char *buf, size_t len,
+			      const struct iio_ch_info *ch_info)
+{
+	/* Stores can change other channels too, e.g. shared gain modes */
+	iio_attr_cache_invalidate(iface, attr);
+
+	return attr->store(iface->dev_instance, buf, len, ch_info);
+}
+
 /**
  * @brief Read all attributes from an attribute list.
- * @param device - Physical instance of a device.
+ * @param iface - Interface of the device.
+ * @param channel_desc - Channel of the attributes, NULL for device attributes.
  * @param buf - Buffer where values are read.
  * @param len - Maximum length of value to be stored in buf.
  * @param channel - Channel properties.
  * @param attributes - List of attributes to be read.
  * @return Number of bytes read or negative value in case of error.
  */
-static ssize_t iio_read_all_attr(void *device, char *buf, size_t len,
-				 const struct iio_ch_info *channel, struct iio_attribute **attributes)
+static ssize_t iio_read_all_attr(struct iio_interface *iface,
+				 struct iio_channel *channel_desc, char *buf,
+				 size_t len, const struct iio_ch_info *channel,
+				 struct iio_attribute **attributes)
 {
 	int16_t i = 0, j = 0;
 	char local_buf[256];
@@ -203,7 +364,8 @@ static ssize_t iio_read_all_attr(void *device, char *buf, size_t len,
 		return FAILURE;
 
 	while (attributes[i]) {
-		attr_length = attributes[i]->show(device, local_buf, len, channel);
+		attr_length = iio_attr_show(iface, channel_desc, attributes[i],
+					    local_buf, len, channel);
 		pattr_length = (uint32_t *)(buf + j);
 		*pattr_length = bswap_constant_32(attr_length);
 		j += 4;
@@ -221,15 +383,16 @@ static ssize_t iio_read_all_attr(void *device, char *buf, size_t len,
 
 /**
  * @brief Write all attributes from an attribute list.
- * @param device - Physical instance of a device.
+ * @param iface - Interface of the device.
  * @param buf - Values to be written.
  * @param len - Length of buf.
  * @param channel - Channel properties.
  * @param attributes - List of attributes to be written.
  * @return Number of written bytes or negative value in case of error.
  */
-static ssize_t iio_write_all_attr(void *device, char *buf, size_t len,
-				  const struct iio_ch_info *channel, struct iio_attribute **attributes)
+static ssize_t iio_write_all_attr(struct iio_interface *iface, char *buf,
+				  size_t len, const struct iio_ch_info *channel,
+				  struct iio_attribute **attributes)
 {
 	int16_t i = 0, j = 0;
 	int16_t attr_length;
@@ -243,7 +406,8 @@ static ssize_t iio_write_all_attr(void *device, char *buf, size_t len,
 	while (attributes[i]) {
 		attr_length = bswap_constant_32((uint32_t)(buf + j));
 		j += 4;
-		attributes[i]->store(device, (buf + j), attr_length, channel);
+		iio_attr_store(iface, attributes[i], (buf + j), attr_length,
+			       channel);
 		j += attr_length;
 		if (j & 0x3)
 			j = ((j >> 2) + 1) << 2;
@@ -278,22 +442,24 @@ static ssize_t iio_rd_wr_channel_attribute(struct element_info *el_info,
 	if (!strcmp(el_info->attribute_name, "")) {
 		/* read / write all channel attributes */
 		if (is_write)
-			return iio_write_all_attr(iface->dev_instance, buf, len, &channel_info,
+			return iio_write_all_attr(iface, buf, len, &channel_info,
 						  channel->attributes);
 		else
-			return iio_read_all_attr(iface->dev_instance, buf, len, &channel_info,
-						 channel->attributes);
+			return iio_read_all_attr(iface, channel, buf, len,
+						 &channel_info, channel->attributes);
 	} else {
 		/* read / write single channel attribute, if attribute found */
 		attribute_id = iio_get_attribute_id(el_info->attribute_name,
 						    channel->attributes);
 		if (attribute_id >= 0) {
 			if (is_write)
-				return channel->attributes[attribute_id]->store(iface->dev_instance,
-						(char*)buf, len, &channel_info);
+				return iio_attr_store(iface,
+						      channel->attributes[attribute_id],
+						      (char*)buf, len, &channel_info);
 			else
-				return channel->attributes[attribute_id]->show(iface->dev_instance, (char*)buf,
-						len, &channel_info);
+				return iio_attr_show(iface, channel,
+						     channel->attributes[attribute_id],
+						     (char*)buf, len, &channel_info);
 		}
 	}
 
@@ -328,10 +494,10 @@ static ssize_t iio_rd_wr_attribute(struct element_info *el_info, char *buf,
 		if (!strcmp(el_info->attribute_name, "")) {
 			/* read / write all device attributes */
 			if (is_write)
-				return iio_write_all_attr(iface->dev_instance, buf, len, NULL,
+				return iio_write_all_attr(iface, buf, len, NULL,
 							  iio_device->attributes);
 			else
-				return iio_read_all_attr(iface->dev_instance, buf, len, NULL,
+				return iio_read_all_attr(iface, NULL, buf, len, NULL,
 							 iio_device->attributes);
 		} else {
 			/* read / write single device attribute, if attribute found */
@@ -340,11 +506,13 @@ static ssize_t iio_rd_wr_attribute(struct element_info *el_info, char *buf,
 			if (attribute_id < 0)
 				return -ENOENT;
 			if (is_write)
-				return iio_device->attributes[attribute_id]->store(iface->dev_instance,
-						(char*)buf, len, NULL);
+				return iio_attr_store(iface,
+						      iio_device->attributes[attribute_id],
+						      (char*)buf, len, NULL);
 			else
-				return iio_device->attributes[attribute_id]->show(iface->dev_instance,
-						(char*)buf, len, NULL);
+				return iio_attr_show(iface, NULL,
+						     iio_device->attributes[attribute_id],
+						     (char*)buf, len, NULL);
 		}
 	} else {
 		/* it is attribute of a channel */
@@ -488,6 +656,34 @@ static ssize_t iio_ch_write_attr(const char *device, const char *channel,
 	return iio_rd_wr_attribute(&el_info, (char*)buf, len, iio_interface->iio, 1);
 }
 
+/**
+ * @brief Size of the channel mask of a device.
+ * @param num_ch - Number of channels of the device.
+ * @return Size in bytes, at least one word.
+ */
+static inline size_t iio_ch_mask_size(uint16_t num_ch)
+{
+	return max(IIO_CH_MASK_WORDS(num_ch), 1) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Count the enabled channels of a channel mask.
+ * @param mask - Channel mask.
+ * @param nb_ch - Number of channels of the device.
+ * @return Number of bits set among the first nb_ch.
+ */
+uint16_t iio_ch_mask_weight(const uint32_t *mask, uint16_t nb_ch)
+{
+	uint16_t i, weight = 0;
+
+	for (i = 0; i < nb_ch / 32; i++)
+		weight += hweight32(mask[i]);
+	if (nb_ch % 32)
+		weight += hweight32(mask[i] & ((1UL << (nb_ch % 32)) - 1));
+
+	return weight;
+}
+
 /**
  * @brief  Open device.
  * @param device - String containing device name.
@@ -499,18 +695,19 @@ static int32_t iio_open_dev(const char *device, size_t sample_size,
 			    uint32_t mask)
 {
 	struct iio_interface *iface;
-	uint32_t ch_mask;
+	uint16_t num_ch;
 
 	if (!iio_supported_dev(device))
 		return -ENODEV;
 
 	iface = iio_get_interface(device, iio_interfaces);
-	ch_mask = 0xFFFFFFFF >> (32 - iface->iio->num_ch);
-
-	if (mask & ~ch_mask)
+	num_ch = iface->iio->num_ch;
+	if (num_ch < 32 && (mask >> num_ch))
 		return -ENOENT;
 
-	iface->ch_mask = mask;
+	/* libtinyiiod only passes the first 32 channels */
+	memset(iface->ch_mask, 0, iio_ch_mask_size(num_ch));
+	iface->ch_mask[0] = mask;
 
 	return SUCCESS;
 }
@@ -527,7 +724,7 @@ static int32_t iio_close_dev(const char *device)
 	if (!iio_supported_dev(device))
 		return FAILURE;
 	iface = iio_get_interface(device, iio_interfaces);
-	iface->ch_mask = 0;
+	memset(iface->ch_mask, 0, iio_ch_mask_size(iface->iio->num_ch));
 
 	return SUCCESS;
 }
@@ -546,7 +743,7 @@ static int32_t iio_get_mask(const char *device, uint32_t *mask)
 		return -ENODEV;
 
 	iface = iio_get_interface(device, iio_interfaces);
-	*mask = iface->ch_mask;
+	*mask = iface->ch_mask[0];
 
 	return SUCCESS;
 }
@@ -716,6 +913,11 @@ ssize_t iio_register(struct iio_interface *iio_interface)
 
 	struct iio_interface **temp_interfaces;
 
+	iio_interface->ch_mask = (uint32_t *)calloc(1,
+				 iio_ch_mask_size(iio_interface->iio->num_ch));
+	if (!iio_interface->ch_mask)
+		return -ENOMEM;
+
 	if (!(iio_interfaces)) {
 		iio_interfaces = (struct iio_interfaces *)calloc(1,
 				 sizeof(struct iio_interfaces));
@@ -778,6 +980,11 @@ ssize_t iio_unregister(struct iio_interface *iio_interface)
 	interfaces->num_interfaces = iio_interfaces->num_interfaces - 1;
 	free(iio_interfaces);
 
+	if (deleted) {
+		iio_attr_cache_free(iio_interface);
+		free(iio_interface->ch_mask);
+	}
+
 	return deleted ? SUCCESS : FAILURE;
 }
 
@@ -815,6 +1022,8 @@ ssize_t iio_init(struct tinyiiod **iiod, struct iio_server_ops *iio_server_ops)
 	ops->write = iio_server_ops->write;
 	ops->get_xml = iio_get_xml;
 
+	iio_get_time_ms = iio_server_ops->get_time_ms;
+
 	*iiod = tinyiiod_create(ops);
 	if (!(*iiod)) {
 		free(ops);
@@ -833,8 +1042,11 @@ ssize_t iio_remove(struct tinyiiod *iiod)
 {
 	uint8_t i;
 
-	for (i = 0; i < iio_interfaces->num_interfaces; i++)
+	for (i = 0; i < iio_interfaces->num_interfaces; i++) {
+		iio_attr_cache_free(iio_interfaces->interfaces[i]);
+		free(iio_interfaces->interfaces[i]->ch_mask);
 		free(iio_interfaces->interfaces[i]);
+	}
 
 	free(iio_interfaces);
 	tinyiiod_destroy(iiod);
@@ -59,8 +59,9 @@
 struct iio_interface {
 	/** Device name */
 	const char *name;
-	/** Opened channels */
-	uint32_t ch_mask;
+	/** Opened channels, IIO_CH_MASK_WORDS(num_ch) words allocated by
+	 * iio_register() */
+	uint32_t *ch_mask;
 	/** Physical instance of a device */
 	void *dev_instance;
 	/** Device descriptor(describes channels and attributes) */
@@ -69,16 +70,18 @@ struct iio_interface {
 	ssize_t (*get_xml)(char **xml, struct iio_device *iio);
 	/** Transfer data from device into RAM */
 	ssize_t (*transfer_dev_to_mem)(void *dev_instance, size_t bytes_count,
-				       uint32_t ch_mask);
+				       const uint32_t *ch_mask);
 	/** Read data from RAM to pbuf. It should be called after "transfer_dev_to_mem" */
 	ssize_t (*read_data)(void *dev_instance, char *pbuf, size_t offset,
-			     size_t bytes_count, uint32_t ch_mask);
+			     size_t bytes_count, const uint32_t *ch_mask);
 	/** Transfer data from RAM to device */
 	ssize_t (*transfer_mem_to_dev)(void *dev_instance, size_t bytes_count,
-				       uint32_t ch_mask);
+				       const uint32_t *ch_mask);
 	/** Write data to RAM. It should be called before "transfer_mem_to_dev" */
 	ssize_t (*write_data)(void *dev_instance, char *pbuf, size_t offset,
-			      size_t bytes_count, uint32_t ch_mask);
+			      size_t bytes_count, const uint32_t *ch_mask);
+	/** Cached attribute values, managed by the iio core */
+	struct iio_attr_cache *attr_cache;
 };
 
 /******************************************************************************/
@@ -94,5 +97,7 @@ ssize_t iio_remove(struct tinyiiod *iiod);
 ssize_t iio_register(struct iio_interface *iio_interface);
 /* Unregister interface. */
 ssize_t iio_unregister(struct iio_interface *iio_interface);
+/* Count the enabled channels of a channel mask. */
+uint16_t iio_ch_mask_weight(const uint32_t *mask, uint16_t nb_ch);
 
 #endif /* IIO_H_ */
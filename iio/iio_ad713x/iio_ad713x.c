@@ -129,7 +129,7 @@ struct iio_device *iio_ad713x_create_device(const char *device_name,
  * return bytes_count or negative value in case of error.
  */
 ssize_t iio_ad713x_transfer_dev_to_mem(void *iio_inst, size_t bytes_count,
-				       uint32_t ch_mask)
+				       const uint32_t *ch_mask)
 {
 	struct iio_ad713x *iio_713x_inst;
 	ssize_t ret, bytes;
@@ -166,7 +166,7 @@ ssize_t iio_ad713x_transfer_dev_to_mem(void *iio_inst, size_t bytes_count,
  * @return bytes_count or negative value in case of error.
  */
 ssize_t iio_ad713x_read_dev(void *iio_inst, char *pbuf, size_t offset,
-			    size_t bytes_count, uint32_t ch_mask)
+			    size_t bytes_count, const uint32_t *ch_mask)
 {
 	struct iio_ad713x *iio_713x_inst;
 	uint32_t i, j = 0, current_ch = 0, offload_data;
@@ -178,13 +178,14 @@ ssize_t iio_ad713x_read_dev(void *iio_inst, char *pbuf, size_t offset,
 
 	iio_713x_inst = (struct iio_ad713x *)iio_inst;
 	pbuf16 = (uint16_t*)pbuf;
-	samples = (bytes_count * iio_713x_inst->num_channels) / hweight8(
-			  ch_mask);
+	samples = (bytes_count * iio_713x_inst->num_channels) /
+		  iio_ch_mask_weight(ch_mask, iio_713x_inst->num_channels);
 	samples /= 2; /* because of uint16_t *pbuf16 = (uint16_t*)pbuf; */
-	offset = (offset * iio_713x_inst->num_channels) / hweight8(ch_mask);
+	offset = (offset * iio_713x_inst->num_channels) /
+		 iio_ch_mask_weight(ch_mask, iio_713x_inst->num_channels);
 
 	for (i = 0; i < samples; i++) {
-		if (ch_mask & BIT(current_ch)) {
+		if (IIO_CH_MASK_TEST(ch_mask, current_ch)) {
 			offload_data = *(uint32_t*)(iio_713x_inst->spi_engine_offload_message->rx_addr +
 						    offset + i * 4);
 			offload_data <<= 1;
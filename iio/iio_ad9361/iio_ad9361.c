@@ -2179,6 +2179,7 @@ static struct iio_attribute iio_attr_rssi = {
 	.name = "rssi",
 	.show = get_rssi,
 	.store = set_rssi,
+	.cache_ms = 100,
 };
 
 static struct iio_attribute iio_attr_hardwaregain_available = {
@@ -2361,6 +2362,7 @@ static struct iio_attribute iio_attr_temp0_input = {
 	.name = "input",
 	.show = get_temp0_input,
 	.store = NULL,
+	.cache_ms = 1000,
 };
 
 struct iio_attribute *temp0_attributes[] = {
@@ -47,6 +47,7 @@
 #include "iio.h"
 #include "iio_axi_adc.h"
 #include "xml.h"
+#include "util.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -375,113 +376,53 @@ static struct iio_attribute *iio_voltage_attributes[] = {
  */
 static ssize_t iio_axi_adc_get_xml(char** xml, struct iio_device *iio_dev)
 {
-	struct xml_document *document = NULL;
-	struct xml_node *attribute = NULL;
-	struct xml_attribute *att = NULL;
-	struct xml_node *channel = NULL;
-	struct xml_node *device = NULL;
-	char buff[256];
+	struct xml_writer writer;
 	ssize_t ret;
 	uint16_t i;
+	uint8_t j;
 
 	if (!xml)
 		return FAILURE;
 	if (!iio_dev)
 		return FAILURE;
 
-	ret = xml_create_node(&device, "device");
+	/* Roughly 100 bytes per attribute line */
+	ret = xml_writer_init(&writer, 128 + iio_dev->num_ch *
+			      (128 + ARRAY_SIZE(iio_voltage_attributes) * 100));
 	if (ret < 0)
-		goto error;
-	ret = xml_create_attribute(&att, "id", iio_dev->name);
-	if (ret < 0)
-		goto error;
-	ret = xml_add_attribute(device, att);
-	if (ret < 0)
-		goto error;
-	ret = xml_create_attribute(&att, "name", iio_dev->name);
-	if (ret < 0)
-		goto error;
-	ret = xml_add_attribute(device, att);
-	if (ret < 0)
-		goto error;
-
-	for (i = 0; i < iio_dev->num_ch; i++) {
-		ret = xml_create_node(&channel, "channel");
-		if (ret < 0)
-			goto error;
-		ret = xml_create_attribute(&att, "id", iio_dev->channels[i]->name);
-		if (ret < 0)
-			goto error;
-		ret = xml_add_attribute(channel, att);
-		if (ret < 0)
-			goto error;
-		ret = xml_create_attribute(&att, "type", "input");
-		if (ret < 0)
-			goto error;
-		ret = xml_add_attribute(channel, att);
-		if (ret < 0)
-			goto error;
+		return ret;
 
-		ret = xml_create_node(&attribute, "scan-element");
-		if (ret < 0)
-			goto error;
-		sprintf(buff, "%d", i);
-		ret = xml_create_attribute(&att, "index", buff);
-		if (ret < 0)
-			goto error;
-		ret = xml_add_attribute(attribute, att);
-		if (ret < 0)
-			goto error;
-		ret = xml_create_attribute(&att, "format", "le:S16/16&gt;&gt;0");
-		if (ret < 0)
-			goto error;
-		ret = xml_add_attribute(attribute, att);
-		if (ret < 0)
-			goto error;
-		ret = xml_add_node(channel, attribute);
-		if (ret < 0)
-			goto error;
+	xml_writer_start_node(&writer, "device");
+	xml_writer_attribute(&writer, "id", "%s", iio_dev->name);
+	xml_writer_attribute(&writer, "name", "%s", iio_dev->name);
 
-		for (uint8_t j = 0; iio_voltage_attributes[j] != NULL; j++) {
-			ret = xml_create_node(&attribute, "attribute");
-			if (ret < 0)
-				goto error;
-			ret = xml_create_attribute(&att, "name",
-						   iio_voltage_attributes[j]->name);
-			if (ret < 0)
-				goto error;
-			ret = xml_add_attribute(attribute, att);
-			if (ret < 0)
-				goto error;
-			sprintf(buff, "in_voltage%d_%s", i, iio_voltage_attributes[j]->name);
-			ret = xml_create_attribute(&att, "filename", buff);
-			if (ret < 0)
-				goto error;
-			ret = xml_add_attribute(attribute, att);
-			if (ret < 0)
-				goto error;
-			ret = xml_add_node(channel, attribute);
-			if (ret < 0)
-				goto error;
+	for (i = 0; i < iio_dev->num_ch; i++) {
+		xml_writer_start_node(&writer, "channel");
+		xml_writer_attribute(&writer, "id", "%s",
+				     iio_dev->channels[i]->name);
+		xml_writer_attribute(&writer, "type", "input");
+
+		xml_writer_start_node(&writer, "scan-element");
+		xml_writer_attribute(&writer, "index", "%d", i);
+		xml_writer_attribute(&writer, "format", "le:S16/16&gt;&gt;0");
+		xml_writer_end_node(&writer, "scan-element");
+
+		for (j = 0; iio_voltage_attributes[j] != NULL; j++) {
+			xml_writer_start_node(&writer, "attribute");
+			xml_writer_attribute(&writer, "name", "%s",
+					     iio_voltage_attributes[j]->name);
+			xml_writer_attribute(&writer, "filename",
+					     "in_voltage%d_%s", i,
+					     iio_voltage_attributes[j]->name);
+			xml_writer_end_node(&writer, "attribute");
 		}
-		ret = xml_add_node(device, channel);
-		if (ret < 0)
-			goto error;
+		xml_writer_end_node(&writer, "channel");
 	}
+	xml_writer_end_node(&writer, "device");
 
-	ret = xml_create_document(&document, device);
-	if (ret < 0) {
-		if (document)
-			xml_delete_document(document);
-		goto error;
-	}
-	*xml = document->buff;
+	ret = xml_writer_finish(&writer, xml);
 
-error:
-	if (device)
-		xml_delete_node(device);
-
-	return ret;
+	return ret < 0 ? ret : SUCCESS;
 }
 
 /**
@@ -576,7 +517,7 @@ error:
  */
 static ssize_t iio_axi_adc_transfer_dev_to_mem(void *iio_inst,
 		size_t bytes_count,
-		uint32_t ch_mask)
+		const uint32_t *ch_mask)
 {
 	struct iio_axi_adc *iio_adc;
 	ssize_t ret, bytes;
@@ -585,7 +526,8 @@ static ssize_t iio_axi_adc_transfer_dev_to_mem(void *iio_inst,
 		return FAILURE;
 
 	iio_adc = (struct iio_axi_adc *)iio_inst;
-	bytes = (bytes_count * iio_adc->adc->num_channels) / hweight8(ch_mask);
+	bytes = (bytes_count * iio_adc->adc->num_channels) / iio_ch_mask_weight(ch_mask,
+			iio_adc->adc->num_channels);
 
 	iio_adc->dmac->flags = 0;
 	ret = axi_dmac_transfer(iio_adc->dmac,
@@ -613,7 +555,7 @@ static ssize_t iio_axi_adc_transfer_dev_to_mem(void *iio_inst,
  * @return bytes_count or negative value in case of error.
  */
 static ssize_t iio_axi_adc_read_dev(void *iio_inst, char *pbuf, size_t offset,
-				    size_t bytes_count, uint32_t ch_mask)
+				    size_t bytes_count, const uint32_t *ch_mask)
 {
 	struct iio_axi_adc *iio_adc;
 	uint32_t i, j = 0, current_ch = 0;
@@ -628,15 +570,16 @@ static ssize_t iio_axi_adc_read_dev(void *iio_inst, char *pbuf, size_t offset,
 
 	iio_adc = (struct iio_axi_adc *)iio_inst;
 	pbuf16 = (uint16_t*)pbuf;
-	samples = (bytes_count * iio_adc->adc->num_channels) / hweight8(
-			  ch_mask);
+	samples = (bytes_count * iio_adc->adc->num_channels) /
+		  iio_ch_mask_weight(ch_mask, iio_adc->adc->num_channels);
 
 	samples /= 2; /* because of uint16_t *pbuf16 = (uint16_t*)pbuf; */
-	offset = (offset * iio_adc->adc->num_channels) / hweight8(ch_mask);
+	offset = (offset * iio_adc->adc->num_channels) /
+		 iio_ch_mask_weight(ch_mask, iio_adc->adc->num_channels);
 
 	for (i = 0; i < samples; i++) {
 
-		if (ch_mask & BIT(current_ch)) {
+		if (IIO_CH_MASK_TEST(ch_mask, current_ch)) {
 			pbuf16[j] = *(uint16_t*)(iio_adc->adc_ddr_base + offset + i * 2);
 			j++;
 		}
@@ -47,6 +47,7 @@
 #include "iio.h"
 #include "iio_axi_dac.h"
 #include "xml.h"
+#include "util.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -540,14 +541,14 @@ static struct iio_attribute *iio_altvoltage_attributes[] = {
  */
 static ssize_t iio_axi_dac_transfer_mem_to_dev(void *iio_inst,
 		size_t bytes_count,
-		uint32_t ch_mask)
+		const uint32_t *ch_mask)
 {
 	struct iio_axi_dac *iio_dac = iio_inst;
 	ssize_t ret, i;
 
 	for (i = 0; i < iio_dac->dac->num_channels; i++) {
 		ret = axi_dac_set_datasel(iio_dac->dac, i,
-					  (BIT(i) & ch_mask) ? AXI_DAC_DATA_SEL_DMA : AXI_DAC_DATA_SEL_DDS);
+					  IIO_CH_MASK_TEST(ch_mask, i) ? AXI_DAC_DATA_SEL_DMA : AXI_DAC_DATA_SEL_DDS);
 		if(ret < 0)
 			return ret;
 	}
@@ -577,7 +578,7 @@ static ssize_t iio_axi_dac_transfer_mem_to_dev(void *iio_inst,
  * @return bytes_count or negative value in case of error.
  */
 static ssize_t iio_axi_dac_write_dev(void *iio_inst, char *buf,
-				     size_t offset,  size_t bytes_count, uint32_t ch_mask)
+				     size_t offset,  size_t bytes_count, const uint32_t *ch_mask)
 {
 	struct iio_axi_dac *iio_dac = iio_inst;
 
@@ -592,111 +593,54 @@ enum ch_type {
 };
 
 /**
- * @brief Fill device with channels.
- * @param device - Node to populate with channels.
+ * @brief Print the channels of a device.
+ * @param writer - Xml writer, inside the "device" element.
  * @param ch_no - Number of channels to be added to "device" element.
  * @param ch_t - Channel type.
  * @return SUCCESS in case of success or negative value otherwise.
  */
-static ssize_t iio_axi_dac_channel_xml(struct xml_node *device, uint8_t ch_no,
+static ssize_t iio_axi_dac_channel_xml(struct xml_writer *writer, uint8_t ch_no,
 				       enum ch_type ch_t)
 {
 	char *ch_id[] = {"voltage", "altvoltage"};
 	char *ch_name[] = {"_I_F", "_Q_F"};
 	struct iio_attribute **iio_attributes;
-	struct xml_node *attribute, *channel;
-	struct xml_attribute *att = NULL;
-	char buff[256];
 	uint8_t i, j;
-	ssize_t ret;
+
+	iio_attributes = (ch_t == CH_VOLTGE) ? iio_voltage_attributes :
+			 iio_altvoltage_attributes;
 
 	for (i = 0; i < ch_no; i++) {
-		ret = xml_create_node(&channel, "channel");
-		if (ret < 0)
-			return ret;
-		ret = sprintf(buff, "%s%d", ch_id[ch_t], i);
-		if (ret < 0)
-			return ret;
-		ret = xml_create_attribute(&att, "id", buff);
-		if (ret < 0)
-			return ret;
-		ret = xml_add_attribute(channel, att);
-		if (ret < 0)
-			return ret;
-		ret = xml_create_attribute(&att, "type", "output");
-		if (ret < 0)
-			return ret;
-		ret = xml_add_attribute(channel, att);
-		if (ret < 0)
-			return ret;
+		xml_writer_start_node(writer, "channel");
+		xml_writer_attribute(writer, "id", "%s%d", ch_id[ch_t], i);
+		xml_writer_attribute(writer, "type", "output");
 
 		if (ch_t == CH_VOLTGE) {
-			ret = xml_create_node(&attribute, "scan-element");
-			if (ret < 0)
-				return ret;
-			ret = sprintf(buff, "%d", i);
-			if (ret < 0)
-				return ret;
-			ret = xml_create_attribute(&att, "index", buff);
-			if (ret < 0)
-				return ret;
-			ret = xml_add_attribute(attribute, att);
-			if (ret < 0)
-				return ret;
-			ret = xml_create_attribute(&att, "format", "le:S16/16&gt;&gt;0");
-			if (ret < 0)
-				return ret;
-			ret = xml_add_attribute(attribute, att);
-			if (ret < 0)
-				return ret;
-			ret = xml_add_node(channel, attribute);
-			if (ret < 0)
-				return ret;
+			xml_writer_start_node(writer, "scan-element");
+			xml_writer_attribute(writer, "index", "%d", i);
+			xml_writer_attribute(writer, "format",
+					     "le:S16/16&gt;&gt;0");
+			xml_writer_end_node(writer, "scan-element");
 		} else {
 			/* CH_ALTVOLTGE */
-			ret = sprintf(buff, "TX%d%s%d", (i / 4) + 1, ch_name[(i % 4) / 2], (i % 2) + 1);
-			if (ret < 0)
-				return ret;
-			ret = xml_create_attribute(&att, "name", buff);
-			if (ret < 0)
-				return ret;
-			ret = xml_add_attribute(channel, att);
-			if (ret < 0)
-				return ret;
+			xml_writer_attribute(writer, "name", "TX%d%s%d",
+					     (i / 4) + 1, ch_name[(i % 4) / 2],
+					     (i % 2) + 1);
 		}
-		iio_attributes = (ch_t == CH_VOLTGE) ? iio_voltage_attributes :
-				 iio_altvoltage_attributes;
 
 		for (j = 0; iio_attributes[j] != NULL; j++) {
-			ret = xml_create_node(&attribute, "attribute");
-			if (ret < 0)
-				return ret;
-			ret = xml_create_attribute(&att, "name",
-						   iio_attributes[j]->name);
-			if (ret < 0)
-				return ret;
-			ret = xml_add_attribute(attribute, att);
-			if (ret < 0)
-				return ret;
-			ret = sprintf(buff, "out_%s%d_%s", ch_id[ch_t], i, iio_attributes[j]->name);
-			if (ret < 0)
-				return ret;
-			ret = xml_create_attribute(&att, "filename", buff);
-			if (ret < 0)
-				return ret;
-			ret = xml_add_attribute(attribute, att);
-			if (ret < 0)
-				return ret;
-			ret = xml_add_node(channel, attribute);
-			if (ret < 0)
-				return ret;
+			xml_writer_start_node(writer, "attribute");
+			xml_writer_attribute(writer, "name", "%s",
+					     iio_attributes[j]->name);
+			xml_writer_attribute(writer, "filename", "out_%s%d_%s",
+					     ch_id[ch_t], i,
+					     iio_attributes[j]->name);
+			xml_writer_end_node(writer, "attribute");
 		}
-		ret = xml_add_node(device, channel);
-		if (ret < 0)
-			return ret;
+		xml_writer_end_node(writer, "channel");
 	}
 
-	return SUCCESS;
+	return writer->error;
 }
 
 /**
@@ -707,45 +651,27 @@ static ssize_t iio_axi_dac_channel_xml(struct xml_node *device, uint8_t ch_no,
  */
 static ssize_t iio_axi_dac_get_xml(char** xml, struct iio_device *iio_dev)
 {
-	struct xml_document *document = NULL;
-	struct xml_attribute *att;
-	struct xml_node *device;
+	struct xml_writer writer;
 	ssize_t ret;
 
-	ret = xml_create_node(&device, "device");
-	if (ret < 0)
-		goto error;
-	ret = xml_create_attribute(&att, "id", iio_dev->name);
-	if (ret < 0)
-		goto error;
-	ret = xml_add_attribute(device, att);
-	if (ret < 0)
-		goto error;
-	ret = xml_create_attribute(&att, "name", iio_dev->name);
-	if (ret < 0)
-		goto error;
-	ret = xml_add_attribute(device, att);
-	if (ret < 0)
-		goto error;
-	ret = iio_axi_dac_channel_xml(device, iio_dev->num_ch, CH_VOLTGE);
+	/* One voltage and two altvoltage channels per DAC channel, roughly
+	 * 100 bytes per attribute line */
+	ret = xml_writer_init(&writer, 128 + iio_dev->num_ch *
+			      (ARRAY_SIZE(iio_voltage_attributes) +
+			       2 * ARRAY_SIZE(iio_altvoltage_attributes) + 3) * 100);
 	if (ret < 0)
-		goto error;
-	ret = iio_axi_dac_channel_xml(device, iio_dev->num_ch * 2, CH_ALTVOLTGE);
-	if (ret < 0)
-		goto error;
-	ret = xml_create_document(&document, device);
-	if (ret < 0) {
-		if (document)
-			xml_delete_document(document);
-		goto error;
-	}
-	*xml = document->buff;
+		return ret;
 
-error:
-	if (device)
-		xml_delete_node(device);
+	xml_writer_start_node(&writer, "device");
+	xml_writer_attribute(&writer, "id", "%s", iio_dev->name);
+	xml_writer_attribute(&writer, "name", "%s", iio_dev->name);
+	iio_axi_dac_channel_xml(&writer, iio_dev->num_ch, CH_VOLTGE);
+	iio_axi_dac_channel_xml(&writer, iio_dev->num_ch * 2, CH_ALTVOLTGE);
+	xml_writer_end_node(&writer, "device");
 
-	return ret;
+	ret = xml_writer_finish(&writer, xml);
+
+	return ret < 0 ? ret : SUCCESS;
 }
 
 /**
@@ -48,6 +48,7 @@
 #include "demo_dev.h"
 #include "error.h"
 #include "util.h"
+#include "iio_format.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -181,7 +182,7 @@ ssize_t set_demo_global_attr(void *device, char *buf, size_t len,
  */
 ssize_t iio_demo_transfer_mem_to_dev(void *iio_inst,
 				     size_t bytes_count,
-				     uint32_t ch_mask)
+				     const uint32_t *ch_mask)
 {
 	struct iio_demo_device *demo_device;
 	demo_device = (struct iio_demo_device *)iio_inst;
@@ -200,7 +201,7 @@ ssize_t iio_demo_transfer_mem_to_dev(void *iio_inst,
  */
 ssize_t iio_demo_transfer_dev_to_mem(void *iio_inst,
 				     size_t bytes_count,
-				     uint32_t ch_mask)
+				     const uint32_t *ch_mask)
 {
 	struct iio_demo_device *demo_device;
 	demo_device = (struct iio_demo_device *)iio_inst;
@@ -228,7 +229,7 @@ ssize_t iio_demo_transfer_dev_to_mem(void *iio_inst,
  * @return bytes_count or negative value in case of error.
  */
 ssize_t iio_demo_write_dev(void *iio_inst, char *buf,
-			   size_t offset,  size_t bytes_count, uint32_t ch_mask)
+			   size_t offset,  size_t bytes_count, const uint32_t *ch_mask)
 {
 	struct iio_demo_desc *demo_device;
 	uint32_t index, addr;
@@ -267,7 +268,7 @@ ssize_t iio_demo_write_dev(void *iio_inst, char *buf,
  * @return bytes_count or negative value in case of error.
  */
 ssize_t iio_demo_read_dev(void *iio_inst, char *pbuf, size_t offset,
-			  size_t bytes_count, uint32_t ch_mask)
+			  size_t bytes_count, const uint32_t *ch_mask)
 {
 	struct iio_demo_desc *demo_device;
 	uint32_t i, j = 0, current_ch = 0;
@@ -282,14 +283,15 @@ ssize_t iio_demo_read_dev(void *iio_inst, char *pbuf, size_t offset,
 
 	demo_device = (struct iio_demo_desc*)iio_inst;
 	pbuf16 = (uint16_t*)pbuf;
-	samples = (bytes_count * DEMO_NUM_CHANNELS) / hweight8(
-			  ch_mask);
+	samples = (bytes_count * DEMO_NUM_CHANNELS) /
+		  iio_ch_mask_weight(ch_mask, DEMO_NUM_CHANNELS);
 	samples /= 2; /* because of uint16_t *pbuf16 = (uint16_t*)pbuf; */
-	offset = (offset * DEMO_NUM_CHANNELS) / hweight8(ch_mask);
+	offset = (offset * DEMO_NUM_CHANNELS) /
+		 iio_ch_mask_weight(ch_mask, DEMO_NUM_CHANNELS);
 
 	for (i = 0; i < samples; i++) {
 
-		if (ch_mask & BIT(current_ch)) {
+		if (IIO_CH_MASK_TEST(ch_mask, current_ch)) {
 			pbuf16[j] = *(uint16_t*)(demo_device->ddr_base_addr +
 						 (offset + i * 2) % demo_device->ddr_base_size);
 
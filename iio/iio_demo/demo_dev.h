@@ -109,14 +109,14 @@ ssize_t set_demo_reg_attr(void *device, char *buf, size_t len,
 
 ssize_t iio_demo_transfer_mem_to_dev(void *iio_inst,
 				     size_t bytes_count,
-				     uint32_t ch_mask);
+				     const uint32_t *ch_mask);
 ssize_t iio_demo_transfer_dev_to_mem(void *iio_inst,
 				     size_t bytes_count,
-				     uint32_t ch_mask);
+				     const uint32_t *ch_mask);
 ssize_t iio_demo_write_dev(void *iio_inst, char *buf,
-			   size_t offset,  size_t bytes_count, uint32_t ch_mask);
+			   size_t offset,  size_t bytes_count, const uint32_t *ch_mask);
 ssize_t iio_demo_read_dev(void *iio_inst, char *pbuf, size_t offset,
-			  size_t bytes_count, uint32_t ch_mask);
+			  size_t bytes_count, const uint32_t *ch_mask);
 
 /* Init function. */
 int32_t iio_demo_dev_init(struct iio_demo_desc **desc,
@@ -47,6 +47,16 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Number of 32-bit words of a channel mask. Bit n of word n / 32 stands for
+ * channel n of the device */
+#define IIO_CH_MASK_WORDS(nb_ch)	(((nb_ch) + 31) / 32)
+/* True if channel ch is set in a channel mask */
+#define IIO_CH_MASK_TEST(mask, ch)	(((mask)[(ch) / 32] >> ((ch) % 32)) & 1)
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -75,6 +85,9 @@ struct iio_attribute {
 	/** Store function pointer */
 	ssize_t (*store)(void *device, char *buf, size_t len,
 			 const struct iio_ch_info *channel);
+	/** Time, in milliseconds, a show result is reused for before the
+	 * device is read again. Any store drops it. 0 disables caching */
+	uint32_t cache_ms;
 };
 
 /**
@@ -114,6 +127,9 @@ struct iio_server_ops {
 	ssize_t (*read)(char *buf, size_t len);
 	/** Write to a peripheral device (UART, USB, NETWORK) */
 	ssize_t (*write)(const char *buf, size_t len);
+	/** Millisecond time source for attribute caching. Optional, caching
+	 * is disabled without it */
+	uint32_t (*get_time_ms)(void);
 };
 
 #endif /* IIO_TYPES_H_ */
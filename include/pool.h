@@ -0,0 +1,122 @@
+/***************************************************************************//**
+ *   @file   pool.h
+ *   @brief  Fixed-block pool and arena allocators header
+ *   @author Mihail Chindris (mihail.chindris@analog.com)
+********************************************************************************
+ *   @copyright
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+#ifndef POOL_H
+#define POOL_H
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct pool
+ * @brief Fixed-block pool descriptor
+ */
+struct pool;
+
+/**
+ * @struct arena
+ * @brief Arena descriptor
+ */
+struct arena;
+
+/**
+ * @struct pool_stats
+ * @brief Usage statistics of a pool
+ */
+struct pool_stats {
+	/** Size of a block in bytes */
+	uint32_t	block_size;
+	/** Number of blocks */
+	uint32_t	nb_blocks;
+	/** Blocks currently allocated */
+	uint32_t	used;
+	/** Highest number of blocks allocated at once */
+	uint32_t	peak;
+	/** Allocations that found the pool empty */
+	uint32_t	failures;
+};
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/*
+ * Allocator of the driver and utility hot paths. With ENABLE_POOL_ALLOC,
+ * small blocks come from fixed-block pools of a few size classes and larger
+ * ones from the heap. Otherwise it is the C library allocator.
+ */
+#ifdef ENABLE_POOL_ALLOC
+void *pool_heap_calloc(size_t nb, size_t size);
+void pool_heap_free(void *ptr);
+int32_t pool_heap_get_stats(uint32_t index, struct pool_stats *stats);
+#else
+#define pool_heap_calloc(nb, size)	calloc(nb, size)
+#define pool_heap_free(ptr)		free(ptr)
+#endif
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+int32_t pool_init(struct pool **desc, uint32_t block_size, uint32_t nb_blocks,
+		  void *mem);
+int32_t pool_remove(struct pool *desc);
+void *pool_alloc(struct pool *desc);
+int32_t pool_free(struct pool *desc, void *block);
+bool pool_owns(struct pool *desc, const void *ptr);
+int32_t pool_get_stats(struct pool *desc, struct pool_stats *stats);
+
+int32_t arena_init(struct arena **desc, uint32_t size, void *mem);
+int32_t arena_remove(struct arena *desc);
+void *arena_alloc(struct arena *desc, uint32_t size);
+int32_t arena_reset(struct arena *desc);
+int32_t arena_get_usage(struct arena *desc, uint32_t *used, uint32_t *peak);
+
+#endif
@@ -0,0 +1,95 @@
+/***************************************************************************//**
+ *   @file   ring_buffer.h
+ *   @brief  Lock-free ring buffer library header
+ *   @author Mihail Chindris (mihail.chindris@analog.com)
+********************************************************************************
+ *   @copyright
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct ring_buffer
+ * @brief Ring buffer descriptor
+ */
+struct ring_buffer;
+
+/**
+ * @struct rb_span
+ * @brief Contiguous region of a ring buffer, reserved by a producer or
+ * peeked by the consumer
+ */
+struct rb_span {
+	/** Start of the region */
+	void		*buff;
+	/** Size of the region in bytes */
+	uint32_t	len;
+	/** Position of the region in the ring */
+	uint32_t	pos;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+int32_t rb_init(struct ring_buffer **desc, uint32_t size, bool multi_producer);
+int32_t rb_remove(struct ring_buffer *desc);
+int32_t rb_size(struct ring_buffer *desc, uint32_t *size);
+int32_t rb_space(struct ring_buffer *desc, uint32_t *space);
+
+int32_t rb_write(struct ring_buffer *desc, const void *data, uint32_t len);
+int32_t rb_read(struct ring_buffer *desc, void *data, uint32_t len);
+
+int32_t rb_reserve(struct ring_buffer *desc, uint32_t len,
+		   struct rb_span *span);
+int32_t rb_commit(struct ring_buffer *desc, const struct rb_span *span);
+
+int32_t rb_peek(struct ring_buffer *desc, uint32_t len, struct rb_span *span);
+int32_t rb_consume(struct ring_buffer *desc, const struct rb_span *span);
+
+#endif
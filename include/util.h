@@ -130,8 +130,16 @@ void rational_best_approximation(uint32_t given_numerator,
 				 uint32_t max_denominator,
 				 uint32_t *best_numerator,
 				 uint32_t *best_denominator);
+/* Find the divider whose output is closest to the desired rate. */
+uint32_t closest_divider(uint64_t parent_rate,
+			 uint64_t rate,
+			 uint32_t div_min,
+			 uint32_t div_max,
+			 uint32_t odd_max);
 /* Calculate the number of set bits. */
 uint32_t hweight8(uint32_t word);
+/* Calculate the number of set bits in a 32-bit word. */
+uint32_t hweight32(uint32_t word);
 /* Calculate the quotient and the remainder of an integer division. */
 uint64_t do_div(uint64_t* n,
 		uint64_t base);
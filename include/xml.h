@@ -45,6 +45,9 @@
 /******************************************************************************/
 
 #include "stdio.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -87,6 +90,26 @@ struct xml_document {
 	char *buff;
 	/** Buffer length */
 	uint32_t index;
+	/** Allocated buffer size */
+	uint32_t size;
+};
+
+/**
+ * @struct xml_writer
+ * @brief Structure holding the state of a streaming XML writer. Nodes are
+ * printed as they are started, without building a tree.
+ */
+struct xml_writer {
+	/** XML Document buffer */
+	char *buff;
+	/** Allocated buffer size */
+	uint32_t size;
+	/** Document length */
+	uint32_t index;
+	/** The start tag of the last started node is not closed yet */
+	bool tag_open;
+	/** First error encountered, later calls are ignored */
+	ssize_t error;
 };
 
 /******************************************************************************/
@@ -120,4 +143,20 @@ ssize_t xml_create_document(struct xml_document **document,
 /* Delete xml document. */
 ssize_t xml_delete_document(struct xml_document *document);
 
+/* Initialize a streaming xml writer. */
+ssize_t xml_writer_init(struct xml_writer *writer, uint32_t size_hint);
+
+/* Start a node, its attributes and children follow. */
+ssize_t xml_writer_start_node(struct xml_writer *writer, const char *name);
+
+/* Print an attribute of the last started node, the value is a format. */
+ssize_t xml_writer_attribute(struct xml_writer *writer, const char *name,
+			     const char *fmt, ...);
+
+/* End the last started node. */
+ssize_t xml_writer_end_node(struct xml_writer *writer, const char *name);
+
+/* Get the document, the caller frees it. */
+ssize_t xml_writer_finish(struct xml_writer *writer, char **buff);
+
 #endif // ___XML_H__
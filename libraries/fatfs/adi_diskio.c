@@ -47,6 +47,8 @@
 #include "sd.h"
 #include "error.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -57,9 +59,54 @@
 #define DEV_USB		2	/* Example: Map USB MSD to physical drive 2 */
 
 #define ERASE_SECTOR_SIZE	1u
+
+/* Sectors cached in front of the SD card, 0 disables the cache */
+#ifndef SD_CACHE_SECTORS
+#define SD_CACHE_SECTORS	8u
+#endif
+
+/*
+ * Size of the RAM disk in sectors, 0 leaves the drive out. On a Linux host,
+ * RAM_DISK_FILE can name an image file loaded at initialization and
+ * updated on CTRL_SYNC.
+ */
+#ifndef RAM_DISK_SECTORS
+#define RAM_DISK_SECTORS	0u
+#endif
+#define RAM_DISK_SECTOR_SIZE	FF_MIN_SS
+
 uint8_t			sd_init_var = false;
 extern struct sd_desc	*sd_desc;
 
+#if RAM_DISK_SECTORS
+static BYTE		*ram_disk;
+#ifdef RAM_DISK_FILE
+/* Range of sectors written since the last CTRL_SYNC */
+static LBA_t		ram_disk_dirty_min = RAM_DISK_SECTORS;
+static LBA_t		ram_disk_dirty_max;
+#endif
+#endif
+
+#if SD_CACHE_SECTORS
+/*
+ * Single sector accesses, which FatFs uses for the FAT and directory
+ * sectors, are cached. Writes are kept until the sector is evicted or the
+ * drive is synchronized, so repeated FAT updates reach the card once.
+ */
+struct sd_cache_line {
+	LBA_t		sector;
+	uint32_t	stamp;
+	bool		valid;
+	bool		dirty;
+	BYTE		data[DATA_BLOCK_LEN] __attribute__ ((aligned));
+};
+
+static struct sd_cache_line	sd_cache[SD_CACHE_SECTORS];
+static uint32_t			sd_cache_stamp;
+/* Card the cached sectors belong to */
+static struct sd_desc		*sd_cache_desc;
+#endif
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -67,7 +114,13 @@ extern struct sd_desc	*sd_desc;
 DSTATUS SD_disk_status();
 DSTATUS SD_disk_initialize();
 DRESULT SD_disk_read(BYTE *buff, LBA_t sector, UINT count);
-DRESULT SD_disk_write(BYTE *buff, LBA_t sector, UINT count);
+DRESULT SD_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+DRESULT SD_disk_sync();
+DSTATUS RAM_disk_status();
+DSTATUS RAM_disk_initialize();
+DRESULT RAM_disk_read(BYTE *buff, LBA_t sector, UINT count);
+DRESULT RAM_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+DRESULT RAM_disk_ioctl(BYTE cmd, void *buff);
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
@@ -80,7 +133,7 @@ DSTATUS disk_status (
 	case DEV_SD :
 		return SD_disk_status();;
 	case DEV_RAM :
-		return STA_NODISK;
+		return RAM_disk_status();
 	case DEV_USB :
 		return STA_NODISK;
 	default:
@@ -100,7 +153,7 @@ DSTATUS disk_initialize (
 	case DEV_SD :
 		return SD_disk_initialize();
 	case DEV_RAM :
-		return STA_NODISK;
+		return RAM_disk_initialize();
 	case DEV_USB :
 		return STA_NODISK;
 	}
@@ -122,7 +175,7 @@ DRESULT disk_read (
 	case DEV_SD :
 		return SD_disk_read(buff, sector, count);
 	case DEV_RAM :
-		return RES_NOTRDY;
+		return RAM_disk_read(buff, sector, count);
 	case DEV_USB :
 		return RES_NOTRDY;
 	}
@@ -146,7 +199,7 @@ DRESULT disk_write (
 	case DEV_SD:
 		return SD_disk_write(buff, sector, count);
 	case DEV_RAM :
-		return RES_NOTRDY;
+		return RAM_disk_write(buff, sector, count);
 	case DEV_USB :
 		return RES_NOTRDY;
 	}
@@ -168,7 +221,7 @@ DRESULT disk_ioctl (
 	switch(pdrv) {
 	case DEV_SD:
 		switch (cmd){
-		case CTRL_SYNC: return RES_OK;
+		case CTRL_SYNC: return SD_disk_sync();
 		case GET_SECTOR_COUNT:
 			*(LBA_t *)buff = sd_desc->memory_size / DATA_BLOCK_LEN;
 			return RES_OK;
@@ -186,7 +239,7 @@ DRESULT disk_ioctl (
 		}
 		return RES_PARERR;
 	case DEV_RAM:
-		return RES_NOTRDY;
+		return RAM_disk_ioctl(cmd, buff);
 	case DEV_USB:
 		return RES_NOTRDY;
 	}
@@ -205,29 +258,345 @@ DSTATUS SD_disk_initialize()
 
 	if (sd_desc == 0)
 		return STA_NOINIT;
+
+#if SD_CACHE_SECTORS
+	/*
+	 * The cached sectors must not be served from another card. Dirty ones
+	 * are written back first if the card is the same, they are lost
+	 * otherwise.
+	 */
+	if (sd_init_var && sd_cache_desc == sd_desc &&
+	    SD_disk_sync() != RES_OK)
+		return STA_NOINIT;
+	memset(sd_cache, 0, sizeof(sd_cache));
+	sd_cache_stamp = 0;
+	sd_cache_desc = sd_desc;
+#endif
 	sd_init_var = true;
 
 	return 0;
 }
 
+#if SD_CACHE_SECTORS
+static struct sd_cache_line *SD_cache_find(LBA_t sector)
+{
+	uint32_t i;
+
+	for (i = 0; i < SD_CACHE_SECTORS; i++)
+		if (sd_cache[i].valid && sd_cache[i].sector == sector)
+			return &sd_cache[i];
+
+	return NULL;
+}
+
+static DRESULT SD_cache_writeback(struct sd_cache_line *line)
+{
+	if (!line->dirty)
+		return RES_OK;
+	if (SUCCESS != sd_write(sd_desc, line->data,
+				(uint64_t)line->sector * DATA_BLOCK_LEN,
+				DATA_BLOCK_LEN))
+		return RES_ERROR;
+	line->dirty = false;
+
+	return RES_OK;
+}
+
+/* Get a free line, evicting the least recently used one if needed */
+static struct sd_cache_line *SD_cache_alloc(LBA_t sector)
+{
+	struct sd_cache_line *line = &sd_cache[0];
+	uint32_t i;
+
+	for (i = 0; i < SD_CACHE_SECTORS; i++) {
+		if (!sd_cache[i].valid) {
+			line = &sd_cache[i];
+			break;
+		}
+		if (sd_cache[i].stamp < line->stamp)
+			line = &sd_cache[i];
+	}
+
+	if (line->valid && SD_cache_writeback(line) != RES_OK)
+		return NULL;
+
+	line->sector = sector;
+	line->valid = true;
+	line->dirty = false;
+
+	return line;
+}
+#endif
+
+DRESULT SD_disk_sync()
+{
+#if SD_CACHE_SECTORS
+	struct sd_cache_line *line;
+	uint32_t i;
+
+	if (!sd_init_var)
+		return RES_NOTRDY;
+
+	/* Write back in ascending sector order */
+	while (true) {
+		line = NULL;
+		for (i = 0; i < SD_CACHE_SECTORS; i++)
+			if (sd_cache[i].valid && sd_cache[i].dirty &&
+			    (!line || sd_cache[i].sector < line->sector))
+				line = &sd_cache[i];
+		if (!line)
+			break;
+		if (SD_cache_writeback(line) != RES_OK)
+			return RES_ERROR;
+	}
+#endif
+
+	return RES_OK;
+}
+
 DRESULT SD_disk_read(BYTE *buff, LBA_t sector, UINT count)
 {
+#if SD_CACHE_SECTORS
+	struct sd_cache_line *line;
+	uint32_t i;
+#endif
+
 	if (!sd_init_var)
 		return RES_NOTRDY;
+
+#if SD_CACHE_SECTORS
+	if (count == 1) {
+		line = SD_cache_find(sector);
+		if (!line) {
+			line = SD_cache_alloc(sector);
+			if (!line)
+				return RES_ERROR;
+			if (SUCCESS != sd_read(sd_desc, line->data,
+					       (uint64_t)sector * DATA_BLOCK_LEN,
+					       DATA_BLOCK_LEN)) {
+				line->valid = false;
+				return RES_ERROR;
+			}
+		}
+		line->stamp = ++sd_cache_stamp;
+		memcpy(buff, line->data, DATA_BLOCK_LEN);
+
+		return RES_OK;
+	}
+#endif
+
 	if (SUCCESS != sd_read(sd_desc, buff, (uint64_t)sector * 512, (uint64_t)count * 512))
 		return RES_ERROR;
 
+#if SD_CACHE_SECTORS
+	/* Cached sectors not written back yet are newer than the card */
+	for (i = 0; i < SD_CACHE_SECTORS; i++)
+		if (sd_cache[i].valid && sd_cache[i].dirty &&
+		    sd_cache[i].sector >= sector &&
+		    sd_cache[i].sector < sector + count)
+			memcpy(buff + (sd_cache[i].sector - sector) * DATA_BLOCK_LEN,
+			       sd_cache[i].data, DATA_BLOCK_LEN);
+#endif
+
 	return RES_OK;
 }
 
-DRESULT SD_disk_write(BYTE *buff, LBA_t sector, UINT count)
+DRESULT SD_disk_write(const BYTE *buff, LBA_t sector, UINT count)
 {
+#if SD_CACHE_SECTORS
+	struct sd_cache_line *line;
+	uint32_t i;
+#endif
+
 	if (!sd_init_var)
 		return RES_NOTRDY;
-	if (SUCCESS != sd_write(sd_desc, buff, (uint64_t)sector * 512, (uint64_t)count * 512))
+
+#if SD_CACHE_SECTORS
+	if (count == 1) {
+		line = SD_cache_find(sector);
+		if (!line) {
+			line = SD_cache_alloc(sector);
+			if (!line)
+				return RES_ERROR;
+		}
+		memcpy(line->data, buff, DATA_BLOCK_LEN);
+		line->dirty = true;
+		line->stamp = ++sd_cache_stamp;
+
+		return RES_OK;
+	}
+#endif
+
+	if (SUCCESS != sd_write(sd_desc, (uint8_t *)buff, (uint64_t)sector * 512,
+				(uint64_t)count * 512))
 		return RES_ERROR;
 
+#if SD_CACHE_SECTORS
+	/* Keep the cached copies of the written sectors up to date */
+	for (i = 0; i < SD_CACHE_SECTORS; i++) {
+		if (sd_cache[i].valid && sd_cache[i].sector >= sector &&
+		    sd_cache[i].sector < sector + count) {
+			memcpy(sd_cache[i].data,
+			       buff + (sd_cache[i].sector - sector) * DATA_BLOCK_LEN,
+			       DATA_BLOCK_LEN);
+			sd_cache[i].dirty = false;
+		}
+	}
+#endif
+
 	return RES_OK;
 }
 
+DSTATUS RAM_disk_status()
+{
+#if RAM_DISK_SECTORS
+	if (ram_disk)
+		return 0;
+	return STA_NOINIT;
+#else
+	return STA_NODISK;
+#endif
+}
+
+DSTATUS RAM_disk_initialize()
+{
+#if RAM_DISK_SECTORS
+#ifdef RAM_DISK_FILE
+	size_t nb_read;
+	bool failed;
+	FILE *f;
+#endif
+
+	if (ram_disk)
+		return 0;
+
+	ram_disk = calloc(RAM_DISK_SECTORS, RAM_DISK_SECTOR_SIZE);
+	if (!ram_disk)
+		return STA_NOINIT;
+
+#ifdef RAM_DISK_FILE
+	/* A missing or short image leaves the rest of the disk blank */
+	f = fopen(RAM_DISK_FILE, "rb");
+	if (f) {
+		nb_read = fread(ram_disk, RAM_DISK_SECTOR_SIZE, RAM_DISK_SECTORS, f);
+		/* Only the end of the image may stop the load early */
+		failed = nb_read < RAM_DISK_SECTORS && !feof(f);
+		fclose(f);
+		if (failed) {
+			free(ram_disk);
+			ram_disk = NULL;
+			return STA_NOINIT;
+		}
+	}
+#endif
+
+	return 0;
+#else
+	return STA_NODISK;
+#endif
+}
+
+DRESULT RAM_disk_read(BYTE *buff, LBA_t sector, UINT count)
+{
+#if RAM_DISK_SECTORS
+	if (!ram_disk)
+		return RES_NOTRDY;
+	if (sector >= RAM_DISK_SECTORS || count > RAM_DISK_SECTORS - sector)
+		return RES_PARERR;
+
+	memcpy(buff, ram_disk + (size_t)sector * RAM_DISK_SECTOR_SIZE,
+	       (size_t)count * RAM_DISK_SECTOR_SIZE);
+
+	return RES_OK;
+#else
+	return RES_NOTRDY;
+#endif
+}
 
+DRESULT RAM_disk_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+#if RAM_DISK_SECTORS
+	if (!ram_disk)
+		return RES_NOTRDY;
+	if (sector >= RAM_DISK_SECTORS || count > RAM_DISK_SECTORS - sector)
+		return RES_PARERR;
+
+	memcpy(ram_disk + (size_t)sector * RAM_DISK_SECTOR_SIZE, buff,
+	       (size_t)count * RAM_DISK_SECTOR_SIZE);
+
+#ifdef RAM_DISK_FILE
+	if (sector < ram_disk_dirty_min)
+		ram_disk_dirty_min = sector;
+	if (sector + count > ram_disk_dirty_max)
+		ram_disk_dirty_max = sector + count;
+#endif
+
+	return RES_OK;
+#else
+	return RES_NOTRDY;
+#endif
+}
+
+#if RAM_DISK_SECTORS && defined(RAM_DISK_FILE)
+/* Write the sectors changed since the last call back to the image file */
+static DRESULT RAM_disk_sync()
+{
+	size_t len;
+	FILE *f;
+
+	if (ram_disk_dirty_min >= ram_disk_dirty_max)
+		return RES_OK;
+
+	f = fopen(RAM_DISK_FILE, "r+b");
+	if (!f)
+		f = fopen(RAM_DISK_FILE, "wb");
+	if (!f)
+		return RES_ERROR;
+
+	len = (size_t)(ram_disk_dirty_max - ram_disk_dirty_min) *
+	      RAM_DISK_SECTOR_SIZE;
+	if (fseek(f, (long)ram_disk_dirty_min * RAM_DISK_SECTOR_SIZE, SEEK_SET) ||
+	    fwrite(ram_disk + (size_t)ram_disk_dirty_min * RAM_DISK_SECTOR_SIZE,
+		   1, len, f) != len) {
+		fclose(f);
+		return RES_ERROR;
+	}
+	if (fclose(f))
+		return RES_ERROR;
+
+	ram_disk_dirty_min = RAM_DISK_SECTORS;
+	ram_disk_dirty_max = 0;
+
+	return RES_OK;
+}
+#endif
+
+DRESULT RAM_disk_ioctl(BYTE cmd, void *buff)
+{
+#if RAM_DISK_SECTORS
+	if (!ram_disk)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+	case CTRL_SYNC:
+#ifdef RAM_DISK_FILE
+		return RAM_disk_sync();
+#else
+		return RES_OK;
+#endif
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = RAM_DISK_SECTORS;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = RAM_DISK_SECTOR_SIZE;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = ERASE_SECTOR_SIZE;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+#else
+	return RES_NOTRDY;
+#endif
+}
@@ -49,7 +49,6 @@
 #include "ctype.h"
 #include "tinyiiod.h"
 #include "util.h"
-#include "list.h"
 #include "delay.h"
 #include "error.h"
 #include "uart.h"
@@ -62,6 +61,7 @@
 
 #define IIOD_PORT		30431
 #define MAX_SOCKET_TO_HANDLE	4
+#define ATTR_BUFF_SIZE		256
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -99,22 +99,79 @@ struct attr_fun_params {
 	struct iio_ch_info	*ch_info;
 };
 
+/**
+ * @struct iio_attr_cache
+ * @brief Last value shown by an attribute and its subscriber.
+ */
+struct iio_attr_cache {
+	/** Last value, NULL terminated */
+	char			*value;
+	/** Length of value */
+	size_t			len;
+	/** Time the value was read at, in milliseconds */
+	uint32_t		stamp;
+	/** Value can be returned without reading the device */
+	bool			valid;
+	/** Subscriber, called when the value changes */
+	iio_attr_notify		notify;
+	/** Subscriber context */
+	void			*ctx;
+};
+
+/**
+ * @struct iio_attr_index
+ * @brief Attribute list sorted by name at registration, searched with bsearch.
+ */
+struct iio_attr_index {
+	/** Attributes, sorted by name */
+	struct iio_attribute	**attrs;
+	/** Number of attributes */
+	uint16_t		num;
+	/** Cache entries, parallel to attrs. NULL if no attribute is cached
+	 * or subscribed */
+	struct iio_attr_cache	*cache;
+};
+
 /**
  * @struct iio_interface
  * @brief Links a physical device instance "void *dev_instance"
  * with a "iio_device *iio" that describes capabilities of the device.
  */
 struct iio_interface {
-	/** Will be: device[0...n] n beeing the count of registerd devices */
-	const char		dev_id[10];
 	/** Device name */
 	const char		*name;
-	/** Opened channels */
-	uint32_t		ch_mask;
+	/** Opened channels, IIO_CH_MASK_WORDS(num_ch) words */
+	uint32_t		*ch_mask;
 	/** Physical instance of a device */
 	void			*dev_instance;
 	/** Device descriptor(describes channels and attributes) */
 	struct iio_device	*dev_descriptor;
+	/** Number of entries in dev_descriptor->channels */
+	uint16_t		num_ch;
+	/** Device attributes index */
+	struct iio_attr_index	attrs;
+	/** Debug attributes index */
+	struct iio_attr_index	debug_attrs;
+	/** Buffer attributes index */
+	struct iio_attr_index	buffer_attrs;
+	/** Attributes index of each channel */
+	struct iio_attr_index	*ch_attrs;
+	/** Xml of the device, from after the device id to the device end */
+	char			*xml;
+	/** Length of xml */
+	uint32_t		xml_size;
+};
+
+/**
+ * @struct iio_batch_req
+ * @brief Batch request written to IIO_BATCH_ATTR by a client, run when the
+ * same client reads the attribute.
+ */
+struct iio_batch_req {
+	/** Client that wrote the request, NULL if the entry is free */
+	void	*client;
+	/** Request, NULL terminated */
+	char	*req;
 };
 
 struct iio_desc {
@@ -122,10 +179,13 @@ struct iio_desc {
 	struct tinyiiod_ops	*iiod_ops;
 	enum pysical_link_type	phy_type;
 	void			*phy_desc;
-	struct list_desc	*interfaces_list;
+	/* Registered interfaces, indexed by device id */
+	struct iio_interface	**interfaces;
+	/* Context xml, assembled from the device xml segments on request */
 	char			*xml_desc;
 	uint32_t		xml_size;
-	uint32_t		xml_size_to_last_dev;
+	/* A device was registered or unregistered since the xml was built */
+	bool			xml_outdated;
 	uint32_t		dev_count;
 	struct uart_desc	*uart_desc;
 	/* FIFO for socket descriptors */
@@ -134,6 +194,12 @@ struct iio_desc {
 	struct tcp_socket_desc	*current_sock;
 	/* Instance of server socket */
 	struct tcp_socket_desc	*server;
+	/* Batch requests waiting to be read, one per client */
+	struct iio_batch_req	batch[MAX_SOCKET_TO_HANDLE + 1];
+	/* Millisecond time source, caching is disabled without it */
+	uint32_t		(*get_time_ms)(void);
+	/* Number of subscribed attributes */
+	uint32_t		nb_subscriptions;
 };
 
 static struct iio_desc			*g_desc;
@@ -202,6 +268,51 @@ static int32_t _get_next_socket(struct iio_desc *desc)
 	return SUCCESS;
 }
 
+/**
+ * @brief Get the client of the command being executed.
+ * @return The client socket, or the UART descriptor.
+ */
+static inline void *iio_current_client(void)
+{
+	if (g_desc->phy_type == USE_UART)
+		return g_desc->uart_desc;
+
+	return g_desc->current_sock;
+}
+
+/**
+ * @brief Find the batch request of a client.
+ * @param client - The client.
+ * @return The request entry, NULL if the client has none.
+ */
+static struct iio_batch_req *iio_batch_find(void *client)
+{
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(g_desc->batch); i++)
+		if (g_desc->batch[i].client == client)
+			return &g_desc->batch[i];
+
+	return NULL;
+}
+
+/**
+ * @brief Drop the batch request of a client, if any.
+ * @param client - The client.
+ */
+static void iio_batch_release(void *client)
+{
+	struct iio_batch_req *entry;
+
+	entry = iio_batch_find(client);
+	if (!entry)
+		return;
+
+	free(entry->req);
+	entry->req = NULL;
+	entry->client = NULL;
+}
+
 static int32_t network_read(const void *data, uint32_t len)
 {
 	uint32_t	i;
@@ -231,6 +342,7 @@ static int32_t network_read(const void *data, uint32_t len)
 	if (ret == -ENOTCONN) {
 		/* A socket connection is disconnected, so we release
 		 * the resources and don't add it again in the list */
+		iio_batch_release(g_desc->current_sock);
 		socket_remove(g_desc->current_sock);
 		g_desc->current_sock = (void *)-1;
 	}
@@ -261,27 +373,6 @@ static ssize_t iio_phy_write(const char *buf, size_t len)
 	return -EINVAL;
 }
 
-/**
- * @brief Get channel number.
- * @param ch - String containing channel name + channel number.
- * @return - Channel number. Ex: for "altvoltage0" return 0, for "voltage2"
- * return 2.
- */
-static int32_t iio_get_channel_number(const char *ch)
-{
-	char *p = (char*)ch;
-	int32_t ch_num = FAILURE;
-
-	while (*p) {
-		if (isdigit(*p))
-			ch_num = strtol(p, &p, 10);
-		else
-			p++;
-	}
-
-	return ch_num;
-}
-
 /* Get string for channel id from channel type */
 static char *get_channel_id(enum iio_chan_type type)
 {
@@ -303,48 +394,226 @@ static inline void _print_ch_id(char *buff, enum iio_chan_type type, int32_t id)
 }
 
 /**
- * @brief Get channel ID from a list of channels.
- * @param channel - Channel name.
- * @param channels - List of channels.
+ * @brief Get channel index from a channel id. Channel ids are printed by
+ * _print_ch_id() from the position in the channel list, so the number in the
+ * id indexes the list directly.
+ * @param iface - Interface of the device.
+ * @param channel - Channel id. Ex: "altvoltage0", "voltage2".
  * @param ch_out - If "true" is output channel, if "false" is input channel.
- * @return Channel ID, or negative value if attribute is not found.
+ * @return Channel index, or negative value if channel is not found.
  */
-static inline struct iio_channel *iio_get_channel(const char *channel,
-		struct iio_channel **channels, bool ch_out)
+static int32_t iio_get_channel(struct iio_interface *iface,
+			       const char *channel, bool ch_out)
 {
-	int16_t i = 0;
-	char	ch_id[20];
+	struct iio_channel	*ch;
+	const char		*type;
+	const char		*p;
+	char			*end;
+	long			i;
+
+	for (p = channel; *p && !isdigit(*p); p++)
+		;
+	if (!*p)
+		return -ENOENT;
 
-	while (channels[i]) {
-		_print_ch_id(ch_id, channels[i]->ch_type, i);
-		if (!strcmp(channel, ch_id) && (channels[i]->ch_out == ch_out))
-			return channels[i];
-		i++;
-	}
+	i = strtol(p, &end, 10);
+	if (*end || i >= iface->num_ch)
+		return -ENOENT;
 
-	return NULL;
+	ch = iface->dev_descriptor->channels[i];
+	type = get_channel_id(ch->ch_type);
+	if (ch->ch_out != ch_out || strlen(type) != (size_t)(p - channel) ||
+	    strncmp(channel, type, p - channel))
+		return -ENOENT;
+
+	return i;
 }
 
 /**
  * @brief Find interface with "device_name".
- * @param device_name - Device name.
- * @param iio_interfaces - List of interfaces.
+ * @param device_name - Device id, as in the context xml: "device<n>".
  * @return Interface pointer if interface is found, NULL otherwise.
  */
 static struct iio_interface *iio_get_interface(const char *device_name)
 {
-	struct iio_interface	*interface;
-	struct iio_interface	cmp_val;
-	int32_t					ret;
+	char	*end;
+	long	id;
 
-	strcpy(cmp_val.dev_id, device_name);
+	if (strncmp(device_name, "device", 6))
+		return NULL;
 
-	ret = list_read_find(g_desc->interfaces_list,
-			     (void **)&interface, &cmp_val);
-	if (IS_ERR_VALUE(ret))
+	id = strtol(device_name + 6, &end, 10);
+	if (end == device_name + 6 || *end || id < 0 || id >= g_desc->dev_count)
 		return NULL;
 
-	return interface;
+	return g_desc->interfaces[id];
+}
+
+static int iio_attr_cmp(const void *a, const void *b)
+{
+	const struct iio_attribute *attr_a = *(struct iio_attribute **)a;
+	const struct iio_attribute *attr_b = *(struct iio_attribute **)b;
+
+	return strcmp(attr_a->name, attr_b->name);
+}
+
+/**
+ * @brief Find attribute by name.
+ * @param index - Attribute index.
+ * @param attr_name - Attribute name.
+ * @return Position of the attribute in the index, or negative value if
+ * attribute is not found.
+ */
+static int32_t iio_find_attr(struct iio_attr_index *index,
+			     const char *attr_name)
+{
+	struct iio_attribute	key;
+	struct iio_attribute	*pkey = &key;
+	struct iio_attribute	**attr;
+
+	if (!index->num)
+		return -ENOENT;
+
+	key.name = attr_name;
+	attr = bsearch(&pkey, index->attrs, index->num, sizeof(*index->attrs),
+		       iio_attr_cmp);
+	if (!attr)
+		return -ENOENT;
+
+	return attr - index->attrs;
+}
+
+/**
+ * @brief Build a sorted index of a NULL terminated attribute list.
+ * @param index - Attribute index to build.
+ * @param attributes - List of attributes, may be NULL.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_build_attr_index(struct iio_attr_index *index,
+				    struct iio_attribute **attributes)
+{
+	uint16_t num = 0;
+	uint16_t i;
+
+	index->attrs = NULL;
+	index->num = 0;
+
+	if (!attributes)
+		return SUCCESS;
+
+	while (attributes[num])
+		num++;
+	if (!num)
+		return SUCCESS;
+
+	index->attrs = (struct iio_attribute **)malloc(num * sizeof(*attributes));
+	if (!index->attrs)
+		return -ENOMEM;
+
+	memcpy(index->attrs, attributes, num * sizeof(*attributes));
+	qsort(index->attrs, num, sizeof(*attributes), iio_attr_cmp);
+	index->num = num;
+	index->cache = NULL;
+
+	for (i = 0; i < num; i++)
+		if (attributes[i]->cache_ms)
+			break;
+	if (i == num)
+		return SUCCESS;
+
+	index->cache = (struct iio_attr_cache *)calloc(index->num,
+			sizeof(*index->cache));
+	if (!index->cache)
+		return -ENOMEM;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free an attribute index and its cache entries.
+ * @param index - Attribute index.
+ */
+static void iio_free_attr_index(struct iio_attr_index *index)
+{
+	uint16_t i;
+
+	if (index->cache) {
+		for (i = 0; i < index->num; i++) {
+			if (index->cache[i].notify)
+				g_desc->nb_subscriptions--;
+			free(index->cache[i].value);
+		}
+		free(index->cache);
+	}
+	free(index->attrs);
+}
+
+/**
+ * @brief Free an interface and its attribute indexes.
+ * @param iface - Interface to free.
+ */
+static void iio_free_interface(struct iio_interface *iface)
+{
+	uint16_t i;
+
+	if (iface->ch_attrs) {
+		for (i = 0; i < iface->num_ch; i++)
+			iio_free_attr_index(&iface->ch_attrs[i]);
+		free(iface->ch_attrs);
+	}
+	iio_free_attr_index(&iface->attrs);
+	iio_free_attr_index(&iface->debug_attrs);
+	iio_free_attr_index(&iface->buffer_attrs);
+	free(iface->xml);
+	free(iface->ch_mask);
+	free(iface);
+}
+
+/**
+ * @brief Build the channel and attribute indexes of an interface, so that
+ * commands are dispatched without scanning names.
+ * @param iface - Interface to index.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_build_interface_index(struct iio_interface *iface)
+{
+	struct iio_device	*dev = iface->dev_descriptor;
+	int32_t			ret;
+	uint16_t		i;
+
+	ret = iio_build_attr_index(&iface->attrs, dev->attributes);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	ret = iio_build_attr_index(&iface->debug_attrs, dev->debug_attributes);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	ret = iio_build_attr_index(&iface->buffer_attrs,
+				   dev->buffer_attributes);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	iface->num_ch = 0;
+	if (!dev->channels)
+		return SUCCESS;
+
+	while (dev->channels[iface->num_ch])
+		iface->num_ch++;
+	if (!iface->num_ch)
+		return SUCCESS;
+
+	iface->ch_attrs = (struct iio_attr_index *)calloc(iface->num_ch,
+			  sizeof(*iface->ch_attrs));
+	if (!iface->ch_attrs)
+		return -ENOMEM;
+
+	for (i = 0; i < iface->num_ch; i++) {
+		ret = iio_build_attr_index(&iface->ch_attrs[i],
+					   dev->channels[i]->attributes);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	return SUCCESS;
 }
 
 /**
@@ -411,35 +680,224 @@ static ssize_t iio_write_all_attr(struct attr_fun_params *params,
 	return params->len;
 }
 
+/**
+ * @brief Store a value shown by an attribute in its cache entry and notify
+ * the subscriber if the value changed.
+ * @param cache - Cache entry.
+ * @param buf - Value shown.
+ * @param len - Length of the value.
+ * @param now - Current time, in milliseconds.
+ */
+static void iio_attr_cache_update(struct iio_attr_cache *cache,
+				  const char *buf, size_t len, uint32_t now)
+{
+	bool	changed;
+	char	*value;
+
+	changed = !cache->value || cache->len != len ||
+		  memcmp(cache->value, buf, len);
+	if (changed) {
+		value = realloc(cache->value, len + 1);
+		if (!value) {
+			cache->valid = false;
+			return;
+		}
+		memcpy(value, buf, len);
+		value[len] = '\0';
+		cache->value = value;
+		cache->len = len;
+	}
+
+	cache->stamp = now;
+	cache->valid = true;
+
+	if (changed && cache->notify)
+		cache->notify(cache->ctx, cache->value, cache->len);
+}
+
+/**
+ * @brief Show an attribute, from its cache entry while the entry is valid
+ * and younger than attr->cache_ms.
+ * @param params - Structure describing parameters for the show function.
+ * @param attributes - Index of attributes.
+ * @param i - Position of the attribute in the index.
+ * @return Length of chars read or negative value in case of error.
+ */
+static ssize_t iio_attr_show(struct attr_fun_params *params,
+			     struct iio_attr_index *attributes, uint16_t i)
+{
+	struct iio_attribute	*attr = attributes->attrs[i];
+	struct iio_attr_cache	*cache;
+	uint32_t		now = 0;
+	ssize_t			ret;
+
+	if (!attributes->cache)
+		return attr->show(params->dev_instance, params->buf,
+				  params->len, params->ch_info);
+
+	cache = &attributes->cache[i];
+	if (attr->cache_ms && g_desc->get_time_ms) {
+		now = g_desc->get_time_ms();
+		if (cache->valid && now - cache->stamp < attr->cache_ms &&
+		    cache->len < params->len) {
+			memcpy(params->buf, cache->value, cache->len + 1);
+			return cache->len;
+		}
+	}
+
+	ret = attr->show(params->dev_instance, params->buf, params->len,
+			 params->ch_info);
+	if (IS_ERR_VALUE(ret) || (size_t)ret >= params->len) {
+		cache->valid = false;
+		return ret;
+	}
+
+	iio_attr_cache_update(cache, params->buf, ret, now);
+	if (!attr->cache_ms || !g_desc->get_time_ms)
+		cache->valid = false;
+
+	return ret;
+}
+
+/**
+ * @brief Invalidate all cache entries of an index.
+ * @param attributes - Index of attributes.
+ */
+static void iio_attr_cache_invalidate(struct iio_attr_index *attributes)
+{
+	uint16_t i;
+
+	if (!attributes->cache)
+		return;
+
+	for (i = 0; i < attributes->num; i++)
+		attributes->cache[i].valid = false;
+}
+
 /**
  * @brief Read/write attribute.
  * @param params - Structure describing parameters for store and show functions
- * @param attributes - Array of attributes.
+ * @param attributes - Index of attributes.
  * @param attr_name - Attribute name to be modified
  * @param is_write -If it has value "1", writes attribute, otherwise reads
  * 		attribute.
  * @return Length of chars written/read or negative value in case of error.
  */
 static ssize_t iio_rd_wr_attribute(struct attr_fun_params *params,
-				   struct iio_attribute **attributes,
-				   char *attr_name,
+				   struct iio_attr_index *attributes,
+				   const char *attr_name,
 				   bool is_write)
 {
-	struct iio_attribute *attr;
+	struct iio_attribute	*attr;
+	struct iio_attr_cache	*cache;
+	char			buf[ATTR_BUFF_SIZE];
+	struct attr_fun_params	show_params;
+	int32_t			i;
+	ssize_t			ret;
 
-	/* Search attribute */
-	for (attr = attributes[0]; attr; attr++)
-		if (!strcmp(attr_name, attr->name))
-			break;
-	if (!attr)
+	i = iio_find_attr(attributes, attr_name);
+	if (IS_ERR_VALUE(i))
+		return i;
+
+	attr = attributes->attrs[i];
+
+	if (!is_write)
+		return iio_attr_show(params, attributes, i);
+
+	ret = attr->store(params->dev_instance, params->buf,
+			  params->len, params->ch_info);
+	if (IS_ERR_VALUE(ret) || !attributes->cache)
+		return ret;
+
+	cache = &attributes->cache[i];
+	cache->valid = false;
+
+	/* Push the value the device settled on to the subscriber */
+	if (cache->notify) {
+		show_params = *params;
+		show_params.buf = buf;
+		show_params.len = sizeof(buf);
+		iio_attr_show(&show_params, attributes, i);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Store a batch request written to IIO_BATCH_ATTR, replacing the
+ * previous request of the same client.
+ * @param buf - Request.
+ * @param len - Length of the request.
+ * @return Number of bytes written or negative value in case of error.
+ */
+static ssize_t iio_batch_store(const char *buf, size_t len)
+{
+	struct iio_batch_req	*entry;
+	void			*client;
+	char			*req;
+
+	client = iio_current_client();
+	entry = iio_batch_find(client);
+	if (!entry)
+		entry = iio_batch_find(NULL);
+	if (!entry)
+		return -EBUSY;
+
+	req = (char *)malloc(len + 1);
+	if (!req)
+		return -ENOMEM;
+
+	memcpy(req, buf, len);
+	req[len] = '\0';
+
+	free(entry->req);
+	entry->req = req;
+	entry->client = client;
+
+	return len;
+}
+
+/**
+ * @brief Run the batch request stored by iio_batch_store() for the same
+ * client, when IIO_BATCH_ATTR is read. The request is consumed.
+ * @param buf - Response buffer.
+ * @param len - Size of the response buffer.
+ * @return Size of the response or negative value in case of error.
+ */
+static ssize_t iio_batch_run(char *buf, size_t len)
+{
+	struct iio_batch_req	*entry;
+	struct iio_batch_attr	*attrs;
+	uint32_t		max_attrs = 1;
+	char			*req;
+	ssize_t			ret;
+
+	entry = iio_batch_find(iio_current_client());
+	if (!entry)
 		return -ENOENT;
 
-	if (is_write)
-		return attr->store(params->dev_instance, params->buf,
-				   params->len, params->ch_info);
-	else
-		return attr->show(params->dev_instance, params->buf,
-				  params->len, params->ch_info);
+	req = entry->req;
+	entry->req = NULL;
+	entry->client = NULL;
+
+	for (ret = 0; req[ret]; ret++)
+		if (req[ret] == '\n')
+			max_attrs++;
+
+	attrs = (struct iio_batch_attr *)calloc(max_attrs, sizeof(*attrs));
+	if (!attrs) {
+		free(req);
+		return -ENOMEM;
+	}
+
+	ret = iio_batch_parse(req, attrs, max_attrs);
+	if (!IS_ERR_VALUE(ret))
+		ret = iio_batch(g_desc, attrs, ret, buf, len);
+
+	free(attrs);
+	free(req);
+
+	return ret;
 }
 
 /**
@@ -456,25 +914,26 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 {
 	struct iio_interface	*dev;
 	struct attr_fun_params	params;
-	struct iio_attribute	**attributes;
 
 	dev = iio_get_interface(device_id);
 	if (!dev)
 		return FAILURE;
 
+	if (debug && !strcmp(attr, IIO_BATCH_ATTR))
+		return iio_batch_run(buf, len);
+
 	params.buf = buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = NULL;
-	if (debug)
-		attributes = dev->dev_descriptor->debug_attributes;
-	else
-		attributes = dev->dev_descriptor->attributes;
 
 	if (!strcmp(attr, ""))
-		return iio_read_all_attr(&params, attributes);
+		return iio_read_all_attr(&params, debug ?
+					 dev->dev_descriptor->debug_attributes :
+					 dev->dev_descriptor->attributes);
 	else
-		return iio_rd_wr_attribute(&params,attributes, attr, 0);
+		return iio_rd_wr_attribute(&params, debug ? &dev->debug_attrs :
+					   &dev->attrs, attr, 0);
 }
 
 /**
@@ -492,25 +951,28 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 {
 	struct iio_interface	*dev;
 	struct attr_fun_params	params;
-	struct iio_attribute	**attributes;
 
 	dev = iio_get_interface(device_id);
 	if (!dev)
 		return -ENODEV;
 
+	if (debug && !strcmp(attr, IIO_BATCH_ATTR))
+		return iio_batch_store(buf, len);
+
 	params.buf = (char *)buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = NULL;
-	if (debug)
-		attributes = dev->dev_descriptor->debug_attributes;
-	else
-		attributes = dev->dev_descriptor->attributes;
 
-	if (!strcmp(attr, ""))
-		return iio_write_all_attr(&params, attributes);
-	else
-		return iio_rd_wr_attribute(&params, attributes, attr, 1);
+	if (!strcmp(attr, "")) {
+		iio_attr_cache_invalidate(debug ? &dev->debug_attrs :
+					  &dev->attrs);
+		return iio_write_all_attr(&params, debug ?
+					  dev->dev_descriptor->debug_attributes :
+					  dev->dev_descriptor->attributes);
+	} else
+		return iio_rd_wr_attribute(&params, debug ? &dev->debug_attrs :
+					   &dev->attrs, attr, 1);
 }
 
 /**
@@ -528,30 +990,29 @@ static ssize_t iio_ch_read_attr(const char *device_id, const char *channel,
 {
 	struct iio_interface	*dev;
 	struct iio_ch_info	ch_info;
-	struct iio_channel	*ch;
 	struct attr_fun_params	params;
+	int32_t			ch;
 
 	dev = iio_get_interface(device_id);
 	if (!dev)
 		return FAILURE;
 
-	ch_info.ch_out = ch_out;
-	ch_info.ch_num = iio_get_channel_number(channel);
-	if (ch_info.ch_num == FAILURE)
-		return FAILURE;
+	ch = iio_get_channel(dev, channel, ch_out);
+	if (IS_ERR_VALUE(ch))
+		return ch;
 
-	ch = iio_get_channel(channel, dev->dev_descriptor->channels, ch_out);
-	if (!ch)
-		return -ENOENT;
+	ch_info.ch_out = ch_out;
+	ch_info.ch_num = ch;
 
 	params.buf = buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = &ch_info;
 	if (!strcmp(attr, ""))
-		return iio_read_all_attr(&params, ch->attributes);
+		return iio_read_all_attr(&params,
+				 dev->dev_descriptor->channels[ch]->attributes);
 	else
-		return iio_rd_wr_attribute(&params, ch->attributes, attr, 0);
+		return iio_rd_wr_attribute(&params, &dev->ch_attrs[ch], attr, 0);
 }
 
 /**
@@ -569,30 +1030,233 @@ static ssize_t iio_ch_write_attr(const char *device_id, const char *channel,
 {
 	struct iio_interface	*dev;
 	struct iio_ch_info	ch_info;
-	struct iio_channel	*ch;
 	struct attr_fun_params	params;
+	int32_t			ch;
 
 	dev = iio_get_interface(device_id);
 	if (!dev)
 		return -ENOENT;
 
-	ch_info.ch_out = ch_out;
-	ch_info.ch_num = iio_get_channel_number(channel);
-	if (ch_info.ch_num == FAILURE)
-		return FAILURE;
+	ch = iio_get_channel(dev, channel, ch_out);
+	if (IS_ERR_VALUE(ch))
+		return ch;
 
-	ch = iio_get_channel(channel, dev->dev_descriptor->channels, ch_out);
-	if (!ch)
-		return -ENOENT;
+	ch_info.ch_out = ch_out;
+	ch_info.ch_num = ch;
 
 	params.buf = (char *)buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = &ch_info;
-	if (!strcmp(attr, ""))
-		return iio_write_all_attr(&params, ch->attributes);
-	else
-		return iio_rd_wr_attribute(&params, ch->attributes, attr, 1);
+	if (!strcmp(attr, "")) {
+		iio_attr_cache_invalidate(&dev->ch_attrs[ch]);
+		return iio_write_all_attr(&params,
+				 dev->dev_descriptor->channels[ch]->attributes);
+	} else
+		return iio_rd_wr_attribute(&params, &dev->ch_attrs[ch], attr, 1);
+}
+
+/**
+ * @brief Execute a batch of attribute accesses, see iio_batch_parse() for the
+ * request format. Clients reach it through the IIO_BATCH_ATTR debug attribute
+ * of any device: a WRITE with the request followed by a READ returning the
+ * response. Requests are kept per client, and a client sending both commands
+ * back to back gets the whole batch in one network round trip. The response
+ * holds, for each access, a big endian 32 bit length (negative error code on
+ * failure) followed, for reads, by the value padded to a multiple of 4 bytes,
+ * like a read of all attributes.
+ * @param desc - iio descriptor.
+ * @param attrs - Attribute accesses.
+ * @param nb_attrs - Number of accesses.
+ * @param buf - Response buffer.
+ * @param len - Size of the response buffer.
+ * @return Size of the response or negative value in case of error.
+ */
+ssize_t iio_batch(struct iio_desc *desc, struct iio_batch_attr *attrs,
+		  uint32_t nb_attrs, char *buf, size_t len)
+{
+	struct iio_batch_attr	*a;
+	uint32_t		*plength;
+	ssize_t			ret;
+	size_t			j = 0;
+	uint32_t		i;
+
+	if (!desc || !attrs || !buf)
+		return -EINVAL;
+
+	for (i = 0; i < nb_attrs; i++) {
+		a = &attrs[i];
+		if (len - j < 4)
+			return -ENOMEM;
+
+		if (a->value && a->channel)
+			ret = iio_ch_write_attr(a->device, a->channel, a->ch_out,
+						a->attr, a->value,
+						strlen(a->value));
+		else if (a->value)
+			ret = iio_write_attr(a->device, a->attr, a->value,
+					     strlen(a->value), a->debug);
+		else if (a->channel)
+			ret = iio_ch_read_attr(a->device, a->channel, a->ch_out,
+					       a->attr, buf + j + 4,
+					       len - j - 4);
+		else
+			ret = iio_read_attr(a->device, a->attr, buf + j + 4,
+					    len - j - 4, a->debug);
+
+		plength = (uint32_t *)(buf + j);
+		*plength = bswap_constant_32((uint32_t)ret);
+		j += 4;
+		if (!a->value && ret > 0) {
+			if ((size_t)ret > len - j)
+				return -ENOMEM;
+			/* Values are padded to a multiple of 4 */
+			j += (ret + 3) & ~0x3;
+			if (j > len)
+				j = len;
+		}
+	}
+
+	return j;
+}
+
+/**
+ * @brief Parse a batch request in place. The request holds one access per
+ * line: "<R|W> <device> <in|out|debug|-> <channel|-> <attribute>[ <value>]".
+ * Device attributes use "-" as channel and "-" or "debug" as direction, the
+ * value of a write is the rest of the line.
+ * @param req - NULL terminated request, modified to terminate each field.
+ * @param attrs - Parsed accesses, pointing into req.
+ * @param max_attrs - Size of attrs.
+ * @return Number of accesses or negative value in case of error.
+ */
+int32_t iio_batch_parse(char *req, struct iio_batch_attr *attrs,
+			uint32_t max_attrs)
+{
+	struct iio_batch_attr	*a;
+	char			*field[5];
+	char			*line;
+	char			*end;
+	uint32_t		n = 0;
+	uint32_t		k;
+
+	for (line = req; *line; line = end) {
+		end = strchr(line, '\n');
+		if (end)
+			*end++ = '\0';
+		else
+			end = line + strlen(line);
+		if (!*line)
+			continue;
+		if (n == max_attrs)
+			return -ENOMEM;
+
+		for (k = 0; k < 5; k++) {
+			field[k] = line;
+			line = strchr(line, ' ');
+			if (!line) {
+				if (k < 4)
+					return -EINVAL;
+				break;
+			}
+			*line++ = '\0';
+		}
+
+		a = &attrs[n++];
+		a->device = field[1];
+		a->ch_out = !strcmp(field[2], "out");
+		a->debug = !strcmp(field[2], "debug");
+		a->channel = strcmp(field[3], "-") ? field[3] : NULL;
+		a->attr = field[4];
+		if (field[0][0] == 'W' && line)
+			a->value = line;
+		else if (field[0][0] == 'R' && !line)
+			a->value = NULL;
+		else
+			return -EINVAL;
+	}
+
+	return n;
+}
+
+/**
+ * @brief Format a batch request, for clients.
+ * @param attrs - Attribute accesses.
+ * @param nb_attrs - Number of accesses.
+ * @param buf - Request buffer.
+ * @param len - Size of the request buffer.
+ * @return Size of the request, without the NULL terminator, or negative value
+ * in case of error.
+ */
+ssize_t iio_batch_format(const struct iio_batch_attr *attrs, uint32_t nb_attrs,
+			 char *buf, size_t len)
+{
+	const struct iio_batch_attr	*a;
+	size_t				j = 0;
+	uint32_t			i;
+	int				n;
+
+	for (i = 0; i < nb_attrs; i++) {
+		a = &attrs[i];
+		n = snprintf(buf + j, len - j, "%c %s %s %s %s%s%s\n",
+			     a->value ? 'W' : 'R', a->device,
+			     a->channel ? (a->ch_out ? "out" : "in") :
+			     (a->debug ? "debug" : "-"),
+			     a->channel ? a->channel : "-", a->attr,
+			     a->value ? " " : "", a->value ? a->value : "");
+		if (n < 0 || (size_t)n >= len - j)
+			return -ENOMEM;
+		j += n;
+	}
+
+	return j;
+}
+
+/**
+ * @brief Get the result of one access from a batch response, for clients.
+ * @param attrs - Attribute accesses the request was formatted from.
+ * @param resp - Response returned by iio_batch().
+ * @param len - Size of the response.
+ * @param index - Index of the access in attrs.
+ * @param value - Set to the value read, not NULL terminated. May be NULL.
+ * @return Length of the value, bytes written or negative error code of the
+ * access.
+ */
+ssize_t iio_batch_get(const struct iio_batch_attr *attrs, const char *resp,
+		      size_t len, uint32_t index, const char **value)
+{
+	int32_t		length;
+	size_t		j = 0;
+	uint32_t	i;
+
+	for (i = 0; i <= index; i++) {
+		if (j + 4 > len)
+			return -ENOENT;
+
+		length = (int32_t)bswap_constant_32(*(uint32_t *)(resp + j));
+		j += 4;
+		if (i == index)
+			break;
+
+		/* Only reads carry a value */
+		if (!attrs[i].value && length > 0)
+			j += (length + 3) & ~0x3;
+	}
+
+	if (value)
+		*value = resp + j;
+
+	return length;
+}
+
+/**
+ * @brief Size of the channel mask of a device.
+ * @param num_ch - Number of channels of the device.
+ * @return Size in bytes, at least one word.
+ */
+static inline size_t iio_ch_mask_size(uint16_t num_ch)
+{
+	return max(IIO_CH_MASK_WORDS(num_ch), 1) * sizeof(uint32_t);
 }
 
 /**
@@ -606,18 +1270,19 @@ static int32_t iio_open_dev(const char *device, size_t sample_size,
 			    uint32_t mask)
 {
 	struct iio_interface *iface;
-	uint32_t ch_mask;
+	uint16_t num_ch;
 
 	iface = iio_get_interface(device);
 	if (!iface)
 		return -ENODEV;
 
-	ch_mask = 0xFFFFFFFF >> (32 - iface->dev_descriptor->num_ch);
-
-	if (mask & ~ch_mask)
+	num_ch = iface->dev_descriptor->num_ch;
+	if (num_ch < 32 && (mask >> num_ch))
 		return -ENOENT;
 
-	iface->ch_mask = mask;
+	/* libtinyiiod only passes the first 32 channels */
+	memset(iface->ch_mask, 0, iio_ch_mask_size(num_ch));
+	iface->ch_mask[0] = mask;
 
 	return SUCCESS;
 }
@@ -634,7 +1299,8 @@ static int32_t iio_close_dev(const char *device)
 	iface = iio_get_interface(device);
 	if (!iface)
 		return FAILURE;
-	iface->ch_mask = 0;
+	memset(iface->ch_mask, 0,
+	       iio_ch_mask_size(iface->dev_descriptor->num_ch));
 
 	return SUCCESS;
 }
@@ -653,7 +1319,7 @@ static int32_t iio_get_mask(const char *device, uint32_t *mask)
 	if (!iface)
 		return -ENODEV;
 
-	*mask = iface->ch_mask;
+	*mask = iface->ch_mask[0];
 
 	return SUCCESS;
 }
@@ -668,6 +1334,9 @@ static ssize_t iio_transfer_dev_to_mem(const char *device, size_t bytes_count)
 {
 	struct iio_interface *iio_interface = iio_get_interface(device);
 
+	if (!iio_interface)
+		return -ENODEV;
+
 	if (iio_interface->dev_descriptor->transfer_dev_to_mem)
 		return iio_interface->dev_descriptor->transfer_dev_to_mem(
 			       iio_interface->dev_instance,
@@ -692,6 +1361,9 @@ static ssize_t iio_read_dev(const char *device, char *pbuf, size_t offset,
 {
 	struct iio_interface *iio_interface = iio_get_interface(device);
 
+	if (!iio_interface)
+		return -ENODEV;
+
 	if (iio_interface->dev_descriptor->read_data)
 		return iio_interface->dev_descriptor->read_data(
 			       iio_interface->dev_instance,
@@ -711,6 +1383,9 @@ static ssize_t iio_transfer_mem_to_dev(const char *device, size_t bytes_count)
 {
 	struct iio_interface *iio_interface = iio_get_interface(device);
 
+	if (!iio_interface)
+		return -ENODEV;
+
 	if (iio_interface->dev_descriptor->transfer_mem_to_dev)
 		return iio_interface->dev_descriptor->transfer_mem_to_dev(
 			       iio_interface->dev_instance,
@@ -734,7 +1409,11 @@ static ssize_t iio_write_dev(const char *device, const char *buf,
 			     size_t offset, size_t bytes_count)
 {
 	struct iio_interface *iio_interface = iio_get_interface(device);
-	if(iio_interface->dev_descriptor->write_data)
+
+	if (!iio_interface)
+		return -ENODEV;
+
+	if (iio_interface->dev_descriptor->write_data)
 		return iio_interface->dev_descriptor->write_data(
 			       iio_interface->dev_instance,
 			       (char*)buf, offset, bytes_count,
@@ -744,20 +1423,259 @@ static ssize_t iio_write_dev(const char *device, const char *buf,
 }
 
 /**
- * @brief Get a merged xml containing all devices.
+ * @brief Assemble the context xml from the header and the device segments.
+ * Device ids are given here, from the position in the interfaces array.
+ * @param desc - iio descriptor
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_build_context_xml(struct iio_desc *desc)
+{
+	struct iio_interface	*iface;
+	uint32_t		size;
+	uint32_t		id;
+	char			*xml;
+	char			*p;
+
+	size = sizeof(header) + sizeof(header_end) - 1;
+	for (id = 0; id < desc->dev_count; id++)
+		size += desc->interfaces[id]->xml_size +
+			snprintf(NULL, 0, "<device id=\"device%d\"", (int)id);
+
+	xml = realloc(desc->xml_desc, size);
+	if (!xml)
+		return -ENOMEM;
+
+	p = xml;
+	memcpy(p, header, sizeof(header) - 1);
+	p += sizeof(header) - 1;
+	for (id = 0; id < desc->dev_count; id++) {
+		iface = desc->interfaces[id];
+		p += sprintf(p, "<device id=\"device%d\"", (int)id);
+		memcpy(p, iface->xml, iface->xml_size);
+		p += iface->xml_size;
+	}
+	memcpy(p, header_end, sizeof(header_end));
+
+	desc->xml_desc = xml;
+	desc->xml_size = size;
+	desc->xml_outdated = false;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get a merged xml containing all devices. The xml is only rebuilt
+ * when devices were registered or unregistered since the last request.
  * @param outxml - Generated xml.
  * @return SUCCESS in case of success or negative value otherwise.
  */
 static ssize_t iio_get_xml(char **outxml)
 {
+	int32_t ret;
+
 	if (!outxml)
 		return FAILURE;
 
+	if (g_desc->xml_outdated) {
+		ret = iio_build_context_xml(g_desc);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
 	*outxml = g_desc->xml_desc;
 
 	return g_desc->xml_size;
 }
 
+/**
+ * @brief Refresh the expired subscribed attributes of an index, notifying the
+ * subscribers of the values that changed.
+ * @param iface - Interface of the device.
+ * @param attributes - Index of attributes.
+ * @param ch_info - Channel of the attributes, NULL for device attributes.
+ */
+static void iio_refresh_attr_index(struct iio_interface *iface,
+				   struct iio_attr_index *attributes,
+				   struct iio_ch_info *ch_info)
+{
+	struct attr_fun_params	params;
+	char			buf[ATTR_BUFF_SIZE];
+	uint16_t		i;
+
+	if (!attributes->cache)
+		return;
+
+	params.dev_instance = iface->dev_instance;
+	params.ch_info = ch_info;
+	for (i = 0; i < attributes->num; i++) {
+		/* Only cached attributes are polled, others notify on store */
+		if (!attributes->cache[i].notify || !attributes->attrs[i]->cache_ms)
+			continue;
+		params.buf = buf;
+		params.len = sizeof(buf);
+		iio_attr_show(&params, attributes, i);
+	}
+}
+
+/**
+ * @brief Refresh all the expired subscribed attributes.
+ * @param desc - iio descriptor
+ */
+static void iio_refresh_subscriptions(struct iio_desc *desc)
+{
+	struct iio_interface	*iface;
+	struct iio_ch_info	ch_info;
+	uint32_t		id;
+	uint16_t		ch;
+
+	for (id = 0; id < desc->dev_count; id++) {
+		iface = desc->interfaces[id];
+		iio_refresh_attr_index(iface, &iface->attrs, NULL);
+		iio_refresh_attr_index(iface, &iface->debug_attrs, NULL);
+		for (ch = 0; ch < iface->num_ch; ch++) {
+			ch_info.ch_num = ch;
+			ch_info.ch_out = iface->dev_descriptor->channels[ch]->ch_out;
+			iio_refresh_attr_index(iface, &iface->ch_attrs[ch],
+					       &ch_info);
+		}
+	}
+}
+
+/**
+ * @brief Subscribe to an attribute. The subscriber is an in-process callback,
+ * notified when a store changes the value and, for cached attributes, when a
+ * refresh done from iio_step() finds a new value. Network and UART clients are
+ * not notified, they still read the attribute to get its value.
+ * @param desc - iio descriptor
+ * @param device - Device id.
+ * @param channel - Channel id, NULL for device attributes.
+ * @param ch_out - Channel type input/output.
+ * @param attr - Attribute name.
+ * @param notify - Called with the new value.
+ * @param ctx - Passed to notify.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_subscribe(struct iio_desc *desc, const char *device,
+		      const char *channel, bool ch_out, const char *attr,
+		      iio_attr_notify notify, void *ctx)
+{
+	struct iio_interface	*iface;
+	struct iio_attr_index	*attributes;
+	int32_t			i;
+
+	if (!desc || !notify)
+		return -EINVAL;
+
+	iface = iio_get_interface(device);
+	if (!iface)
+		return -ENODEV;
+
+	if (channel) {
+		i = iio_get_channel(iface, channel, ch_out);
+		if (IS_ERR_VALUE(i))
+			return i;
+		attributes = &iface->ch_attrs[i];
+	} else {
+		attributes = &iface->attrs;
+	}
+
+	i = iio_find_attr(attributes, attr);
+	if (IS_ERR_VALUE(i))
+		return i;
+
+	if (!attributes->cache) {
+		attributes->cache = (struct iio_attr_cache *)calloc(
+					    attributes->num,
+					    sizeof(*attributes->cache));
+		if (!attributes->cache)
+			return -ENOMEM;
+	}
+
+	if (!attributes->cache[i].notify)
+		desc->nb_subscriptions++;
+	attributes->cache[i].notify = notify;
+	attributes->cache[i].ctx = ctx;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Remove a subscription made with iio_subscribe().
+ * @param desc - iio descriptor
+ * @param device - Device id.
+ * @param channel - Channel id, NULL for device attributes.
+ * @param ch_out - Channel type input/output.
+ * @param attr - Attribute name.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_unsubscribe(struct iio_desc *desc, const char *device,
+			const char *channel, bool ch_out, const char *attr)
+{
+	struct iio_interface	*iface;
+	struct iio_attr_index	*attributes;
+	int32_t			i;
+
+	if (!desc)
+		return -EINVAL;
+
+	iface = iio_get_interface(device);
+	if (!iface)
+		return -ENODEV;
+
+	if (channel) {
+		i = iio_get_channel(iface, channel, ch_out);
+		if (IS_ERR_VALUE(i))
+			return i;
+		attributes = &iface->ch_attrs[i];
+	} else {
+		attributes = &iface->attrs;
+	}
+
+	i = iio_find_attr(attributes, attr);
+	if (IS_ERR_VALUE(i))
+		return i;
+
+	if (!attributes->cache || !attributes->cache[i].notify)
+		return -ENOENT;
+
+	attributes->cache[i].notify = NULL;
+	attributes->cache[i].ctx = NULL;
+	desc->nb_subscriptions--;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the channels used by the next buffer transfers of a device.
+ * Unlike the open command of libtinyiiod, this is not limited to 32 channels.
+ * @param desc - iio descriptor
+ * @param device - Device id.
+ * @param mask - Channel mask, IIO_CH_MASK_WORDS(num_ch) words.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_set_ch_mask(struct iio_desc *desc, const char *device,
+			const uint32_t *mask)
+{
+	struct iio_interface	*iface;
+	uint16_t		num_ch, words;
+
+	if (!desc || !mask)
+		return -EINVAL;
+
+	iface = iio_get_interface(device);
+	if (!iface)
+		return -ENODEV;
+
+	num_ch = iface->dev_descriptor->num_ch;
+	words = IIO_CH_MASK_WORDS(num_ch);
+	if (num_ch % 32 && (mask[words - 1] >> (num_ch % 32)))
+		return -ENOENT;
+
+	memcpy(iface->ch_mask, mask, words * sizeof(*mask));
+
+	return SUCCESS;
+}
+
 /**
  * @brief Execute an iio step
  * @param desc - IIo descriptor
@@ -767,6 +1685,9 @@ ssize_t iio_step(struct iio_desc *desc)
 {
 	int32_t ret;
 
+	if (desc->nb_subscriptions)
+		iio_refresh_subscriptions(desc);
+
 	if (desc->current_sock != NULL && (int32_t)desc->current_sock != -1) {
 		ret = _push_sock(desc, desc->current_sock);
 		if (IS_ERR_VALUE(ret))
@@ -779,12 +1700,14 @@ ssize_t iio_step(struct iio_desc *desc)
 }
 
 /*
- * Generate an xml describing a device and write it to buff.
+ * Generate an xml describing a device and write it to buff. The xml starts
+ * after the device id, which depends on the device position and is printed
+ * when the context xml is assembled.
  * Will return the size of the xml.
  * If buff_size is 0, no data will be written to buff, but size will be returned
  */
-static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
-					int32_t id, char *buff,
+static uint32_t iio_generate_device_xml(struct iio_device *device,
+					const char *name, char *buff,
 					uint32_t buff_size)
 {
 	struct iio_channel	*ch;
@@ -805,8 +1728,7 @@ static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
 		buff = ch_id;
 
 	i = 0;
-	i += snprintf(buff, max(n - i, 0),
-		      "<device id=\"device%d\" name=\"%s\">", id, name);
+	i += snprintf(buff, max(n - i, 0), " name=\"%s\">", name);
 
 	/* Write channels */
 	if (device->channels)
@@ -858,6 +1780,8 @@ static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
 			i += snprintf(buff + i, max(n - i, 0),
 				      "<debug-attribute name=\"%s\" />",
 				      device->debug_attributes[j]->name);
+	i += snprintf(buff + i, max(n - i, 0),
+		      "<debug-attribute name=\"%s\" />", IIO_BATCH_ATTR);
 
 	/* Write buffer attributes */
 	if (device->buffer_attributes)
@@ -883,10 +1807,8 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 		     char *name, void *dev_instance)
 {
 	struct iio_interface	*iio_interface;
+	struct iio_interface	**interfaces;
 	int32_t ret;
-	int32_t	n;
-	int32_t	new_size;
-	char	*aux;
 
 	iio_interface = (struct iio_interface *)calloc(1,
 			sizeof(*iio_interface));
@@ -896,38 +1818,40 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 	iio_interface->name = name;
 	iio_interface->dev_descriptor = dev_descriptor;
 
-	/* Get number of bytes needed for the xml of the new device */
-	n = iio_generate_device_xml(iio_interface->dev_descriptor, iio_interface->name,
-				    desc->dev_count, NULL, -1);
+	ret = iio_build_interface_index(iio_interface);
+	if (IS_ERR_VALUE(ret)) {
+		iio_free_interface(iio_interface);
+		return ret;
+	}
 
-	new_size = desc->xml_size + n;
-	aux = realloc(desc->xml_desc, new_size);
-	if (!aux) {
-		free(iio_interface);
+	interfaces = realloc(desc->interfaces,
+			     (desc->dev_count + 1) * sizeof(*interfaces));
+	if (!interfaces) {
+		iio_free_interface(iio_interface);
 		return -ENOMEM;
 	}
+	desc->interfaces = interfaces;
 
-	ret = desc->interfaces_list->push(desc->interfaces_list, iio_interface);
-	if (IS_ERR_VALUE(ret)) {
-		free(iio_interface);
-		free(aux);
-		return ret;
+	iio_interface->ch_mask = (uint32_t *)calloc(1,
+				 iio_ch_mask_size(dev_descriptor->num_ch));
+	if (!iio_interface->ch_mask) {
+		iio_free_interface(iio_interface);
+		return -ENOMEM;
 	}
 
-	desc->xml_desc = aux;
-	/* Print the new device xml at the end of the xml */
-	iio_generate_device_xml(iio_interface->dev_descriptor,
-				iio_interface->name,
-				desc->dev_count,
-				desc->xml_desc + desc->xml_size_to_last_dev,
-				new_size - desc->xml_size_to_last_dev);
-	sprintf((char *)iio_interface->dev_id, "device%d", (int)desc->dev_count);
-	desc->xml_size_to_last_dev += n;
-	desc->xml_size += n;
-	/* Copy end header at the end */
-	strcat(desc->xml_desc, header_end);
-
-	desc->dev_count++;
+	/* Get number of bytes needed for the xml of the new device */
+	iio_interface->xml_size = iio_generate_device_xml(dev_descriptor, name,
+				  NULL, -1);
+	iio_interface->xml = (char *)malloc(iio_interface->xml_size + 1);
+	if (!iio_interface->xml) {
+		iio_free_interface(iio_interface);
+		return -ENOMEM;
+	}
+	iio_generate_device_xml(dev_descriptor, name, iio_interface->xml,
+				iio_interface->xml_size + 1);
+
+	desc->interfaces[desc->dev_count++] = iio_interface;
+	desc->xml_outdated = true;
 
 	return SUCCESS;
 }
@@ -939,42 +1863,25 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
  */
 ssize_t iio_unregister(struct iio_desc *desc, char *name)
 {
-	struct iio_interface	*to_remove_interface;
-	struct iio_interface	search_interface;
-	int32_t			ret;
-	int32_t			n;
-	char			*aux;
-
-	/* Get if the item is found, get will remove it from the list */
-	search_interface.name = name;
-	ret = list_get_find(desc->interfaces_list,
-			    (void **)&to_remove_interface, &search_interface);
-	if (IS_ERR_VALUE(ret))
-		return ret;
-	free(to_remove_interface);
+	uint32_t id;
 
-	/* Get number of bytes needed for the xml of the device */
-	n = iio_generate_device_xml(to_remove_interface->dev_descriptor,
-				    to_remove_interface->name,
-				    desc->dev_count, NULL, -1);
+	for (id = 0; id < desc->dev_count; id++)
+		if (!strcmp(desc->interfaces[id]->name, name))
+			break;
+	if (id == desc->dev_count)
+		return -ENOENT;
 
-	/* Overwritte the deleted device */
-	aux = desc->xml_desc + desc->xml_size_to_last_dev - n;
-	strcpy(aux, aux + n);
+	iio_free_interface(desc->interfaces[id]);
 
-	/* Decrease the xml size */
-	desc->xml_size -= n;
-	desc->xml_size_to_last_dev -= n;
+	/* Renumber the following devices */
+	desc->dev_count--;
+	memmove(&desc->interfaces[id], &desc->interfaces[id + 1],
+		(desc->dev_count - id) * sizeof(*desc->interfaces));
+	desc->xml_outdated = true;
 
 	return SUCCESS;
 }
 
-static int32_t iio_cmp_interfaces(struct iio_interface *a,
-				  struct iio_interface *b)
-{
-	return strcmp(a->dev_id, b->dev_id);
-}
-
 /**
  * @brief Set communication ops and read/write ops that will be called
  * from "libtinyiiod".
@@ -1018,16 +1925,10 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->read = iio_phy_read;
 	ops->write = iio_phy_write;
 
-	ldesc->xml_size = sizeof(header) + sizeof(header_end);
-	ldesc->xml_desc = (char *)malloc(ldesc->xml_size);
-	if (!ldesc->xml_desc)
-		goto free_desc;
-
-	strcpy(ldesc->xml_desc, header);
-	strcat(ldesc->xml_desc, header_end);
-	ldesc->xml_size_to_last_dev = sizeof(header) - 1;
+	ldesc->xml_outdated = true;
 
 	ldesc->phy_type = init_param->phy_type;
+	ldesc->get_time_ms = init_param->get_time_ms;
 	if (init_param->phy_type == USE_UART) {
 		ret = uart_init((struct uart_desc **)&ldesc->uart_desc,
 				init_param->uart_init_param);
@@ -1057,22 +1958,15 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 
 	ops->get_xml = iio_get_xml;
 
-	ret = list_init(&ldesc->interfaces_list, LIST_PRIORITY_LIST,
-			(f_cmp)iio_cmp_interfaces);
-	if (IS_ERR_VALUE(ret))
-		goto free_pylink;
-
 	ldesc->iiod = tinyiiod_create(ops);
 	if (!(ldesc->iiod))
-		goto free_list;
+		goto free_pylink;
 
 	*desc = ldesc;
 	g_desc = ldesc;
 
 	return SUCCESS;
 
-free_list:
-	list_remove(ldesc->interfaces_list);
 free_pylink:
 	if (ldesc->phy_type == USE_UART)
 		uart_remove(ldesc->uart_desc);
@@ -1096,17 +1990,18 @@ free_ops:
  */
 ssize_t iio_remove(struct iio_desc *desc)
 {
-	struct iio_interface	*iio_interface;
+	uint32_t i;
 
-	while (SUCCESS == list_get_first(desc->interfaces_list,
-					 (void **)&iio_interface))
-		free(iio_interface);
-	list_remove(desc->interfaces_list);
+	for (i = 0; i < desc->dev_count; i++)
+		iio_free_interface(desc->interfaces[i]);
+	free(desc->interfaces);
 
 	free(desc->iiod_ops);
 	tinyiiod_destroy(desc->iiod);
 
 	free(desc->xml_desc);
+	for (i = 0; i < ARRAY_SIZE(desc->batch); i++)
+		free(desc->batch[i].req);
 
 	if (desc->phy_type == USE_UART)
 		uart_remove(desc->phy_desc);
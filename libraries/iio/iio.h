@@ -49,6 +49,16 @@
 #include "uart.h"
 #include "tcp_socket.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Debug attribute carrying batch requests, listed on every device. A client
+ * writes a request formatted by iio_batch_format() to it, then reads it to
+ * run the request and get the response of iio_batch(). Both commands can be
+ * sent back to back, each client has its own pending request. */
+#define IIO_BATCH_ATTR		"iio_batch"
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -60,12 +70,37 @@ enum pysical_link_type {
 
 struct iio_desc;
 
+/* Called from the firmware, inside iio_step() or an attribute write, with the
+ * new value of a subscribed attribute. Nothing is sent to IIO clients */
+typedef void (*iio_attr_notify)(void *ctx, const char *value, size_t len);
+
 struct iio_init_param {
 	enum pysical_link_type	phy_type;
 	union {
 		struct uart_init_param		*uart_init_param;
 		struct tcp_socket_init_param	*tcp_socket_init_param;
 	};
+	/* Millisecond time source for attribute caching. Optional */
+	uint32_t		(*get_time_ms)(void);
+};
+
+/**
+ * @struct iio_batch_attr
+ * @brief One attribute access of a batch.
+ */
+struct iio_batch_attr {
+	/** Device id: "device<n>" */
+	const char	*device;
+	/** Channel id, NULL for device attributes */
+	const char	*channel;
+	/** Channel type: input/output */
+	bool		ch_out;
+	/** Debug attribute, for device attributes */
+	bool		debug;
+	/** Attribute name */
+	const char	*attr;
+	/** Value to write, NULL to read the attribute */
+	const char	*value;
 };
 
 /******************************************************************************/
@@ -84,5 +119,27 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 		     char *name, void *dev_instance);
 /* Unregister interface. */
 ssize_t iio_unregister(struct iio_desc *desc, char *name);
+/* Execute a batch of attribute accesses. */
+ssize_t iio_batch(struct iio_desc *desc, struct iio_batch_attr *attrs,
+		  uint32_t nb_attrs, char *buf, size_t len);
+/* Parse a batch request in place. */
+int32_t iio_batch_parse(char *req, struct iio_batch_attr *attrs,
+			uint32_t max_attrs);
+/* Format a batch request. */
+ssize_t iio_batch_format(const struct iio_batch_attr *attrs, uint32_t nb_attrs,
+			 char *buf, size_t len);
+/* Get the result of one access from a batch response. */
+ssize_t iio_batch_get(const struct iio_batch_attr *attrs, const char *resp,
+		      size_t len, uint32_t index, const char **value);
+/* Get a local callback when the value of an attribute changes. */
+int32_t iio_subscribe(struct iio_desc *desc, const char *device,
+		      const char *channel, bool ch_out, const char *attr,
+		      iio_attr_notify notify, void *ctx);
+/* Remove a subscription made with iio_subscribe(). */
+int32_t iio_unsubscribe(struct iio_desc *desc, const char *device,
+			const char *channel, bool ch_out, const char *attr);
+/* Set the channels used by the next buffer transfers of a device. */
+int32_t iio_set_ch_mask(struct iio_desc *desc, const char *device,
+			const uint32_t *mask);
 
 #endif /* IIO_H_ */
@@ -0,0 +1,670 @@
+/***************************************************************************//**
+ *   @file   iio_format.c
+ *   @brief  Implementation of the iio scan element format engine.
+ *   @author Cristian Pop (cristian.pop@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "iio_format.h"
+#include "error.h"
+#include "util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define IIO_FORMAT_HOST_LE	true
+#else
+#define IIO_FORMAT_HOST_LE	false
+#endif
+
+#define IIO_FORMAT_ALIGN(off, bytes)	(((off) + (bytes) - 1) & ~((bytes) - 1))
+
+/*
+ * Pack/unpack for devices whose channels all have the same storage size. The
+ * scans have no padding then and a sample is a plain array access.
+ */
+#define IIO_FORMAT_COPY_KERNELS(bits)					\
+static void iio_format_pack_##bits(const struct iio_format *fmt,	\
+				   void *dst, const void *src,		\
+				   uint32_t nb_scans)			\
+{									\
+	const uint##bits##_t *in = src;					\
+	uint##bits##_t *out = dst;					\
+	uint32_t stride = fmt->full_scan_bytes / sizeof(*in);		\
+	uint32_t i;							\
+	uint16_t j;							\
+									\
+	for (i = 0; i < nb_scans; i++, in += stride)			\
+		for (j = 0; j < fmt->nb_ch; j++)			\
+			*out++ = in[fmt->ch[j].full_offset / sizeof(*in)]; \
+}									\
+									\
+static void iio_format_unpack_##bits(const struct iio_format *fmt,	\
+				     void *dst, const void *src,	\
+				     uint32_t nb_scans)			\
+{									\
+	const uint##bits##_t *in = src;					\
+	uint##bits##_t *out = dst;					\
+	uint32_t stride = fmt->full_scan_bytes / sizeof(*out);		\
+	uint32_t i;							\
+	uint16_t j;							\
+									\
+	for (i = 0; i < nb_scans; i++, out += stride)			\
+		for (j = 0; j < fmt->nb_ch; j++)			\
+			out[fmt->ch[j].full_offset / sizeof(*out)] = *in++; \
+}
+
+/*
+ * Decode/encode for scans of same-size, little endian samples that use all
+ * their storage bits. On a little endian CPU this is just a type conversion.
+ */
+#define IIO_FORMAT_PLAIN_KERNELS(name, type)				\
+static void iio_format_decode_##name(const struct iio_format *fmt,	\
+				     int32_t *dst, const void *src,	\
+				     uint32_t nb_scans)			\
+{									\
+	const type *in = src;						\
+	uint32_t i, n = nb_scans * fmt->nb_ch;				\
+									\
+	for (i = 0; i < n; i++)						\
+		dst[i] = (int32_t)in[i];				\
+}									\
+									\
+static void iio_format_encode_##name(const struct iio_format *fmt,	\
+				     void *dst, const int32_t *src,	\
+				     uint32_t nb_scans)			\
+{									\
+	type *out = dst;						\
+	uint32_t i, n = nb_scans * fmt->nb_ch;				\
+									\
+	for (i = 0; i < n; i++)						\
+		out[i] = (type)src[i];					\
+}
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+IIO_FORMAT_COPY_KERNELS(8)
+IIO_FORMAT_COPY_KERNELS(16)
+IIO_FORMAT_COPY_KERNELS(32)
+IIO_FORMAT_COPY_KERNELS(64)
+
+IIO_FORMAT_PLAIN_KERNELS(s8, int8_t)
+IIO_FORMAT_PLAIN_KERNELS(u8, uint8_t)
+IIO_FORMAT_PLAIN_KERNELS(s16, int16_t)
+IIO_FORMAT_PLAIN_KERNELS(u16, uint16_t)
+IIO_FORMAT_PLAIN_KERNELS(s32, int32_t)
+IIO_FORMAT_PLAIN_KERNELS(u32, uint32_t)
+
+/**
+ * @brief Pack/unpack when all the channels are enabled.
+ * @param fmt - Scan layout.
+ * @param dst - Destination scans.
+ * @param src - Source scans.
+ * @param nb_scans - Number of scans.
+ */
+static void iio_format_copy(const struct iio_format *fmt, void *dst,
+			    const void *src, uint32_t nb_scans)
+{
+	memcpy(dst, src, nb_scans * fmt->scan_bytes);
+}
+
+/**
+ * @brief Copy the enabled channels out of full scans, any layout.
+ * @param fmt - Scan layout.
+ * @param dst - Scans of the enabled channels.
+ * @param src - Full scans.
+ * @param nb_scans - Number of scans.
+ */
+static void iio_format_pack_generic(const struct iio_format *fmt, void *dst,
+				    const void *src, uint32_t nb_scans)
+{
+	const uint8_t *in = src;
+	uint8_t *out = dst;
+	uint32_t i;
+	uint16_t j;
+
+	for (i = 0; i < nb_scans; i++) {
+		for (j = 0; j < fmt->nb_ch; j++)
+			memcpy(out + fmt->ch[j].offset,
+			       in + fmt->ch[j].full_offset, fmt->ch[j].bytes);
+		in += fmt->full_scan_bytes;
+		out += fmt->scan_bytes;
+	}
+}
+
+/**
+ * @brief Copy the enabled channels into full scans, any layout. The samples
+ * of the disabled channels are left untouched.
+ * @param fmt - Scan layout.
+ * @param dst - Full scans.
+ * @param src - Scans of the enabled channels.
+ * @param nb_scans - Number of scans.
+ */
+static void iio_format_unpack_generic(const struct iio_format *fmt, void *dst,
+				      const void *src, uint32_t nb_scans)
+{
+	const uint8_t *in = src;
+	uint8_t *out = dst;
+	uint32_t i;
+	uint16_t j;
+
+	for (i = 0; i < nb_scans; i++) {
+		for (j = 0; j < fmt->nb_ch; j++)
+			memcpy(out + fmt->ch[j].full_offset,
+			       in + fmt->ch[j].offset, fmt->ch[j].bytes);
+		in += fmt->scan_bytes;
+		out += fmt->full_scan_bytes;
+	}
+}
+
+/**
+ * @brief Mask of the valid bits of a sample.
+ * @param ch - Channel layout.
+ * @return The mask, right aligned.
+ */
+static inline uint32_t iio_format_mask(const struct iio_format_ch *ch)
+{
+	return ch->realbits >= 32 ? 0xFFFFFFFF : (1UL << ch->realbits) - 1;
+}
+
+/**
+ * @brief Convert scans to CPU values, any layout.
+ * @param fmt - Scan layout.
+ * @param dst - One value per enabled channel and scan.
+ * @param src - Scans of the enabled channels.
+ * @param nb_scans - Number of scans.
+ */
+static void iio_format_decode_generic(const struct iio_format *fmt,
+				      int32_t *dst, const void *src,
+				      uint32_t nb_scans)
+{
+	const struct iio_format_ch *ch;
+	const uint8_t *in = src;
+	uint32_t i, val, mask;
+	uint16_t j;
+	uint8_t k;
+
+	for (i = 0; i < nb_scans; i++) {
+		for (j = 0; j < fmt->nb_ch; j++) {
+			ch = &fmt->ch[j];
+			val = 0;
+			if (ch->is_big_endian)
+				for (k = 0; k < ch->bytes; k++)
+					val = (val << 8) | in[ch->offset + k];
+			else
+				for (k = ch->bytes; k > 0; k--)
+					val = (val << 8) | in[ch->offset + k - 1];
+
+			mask = iio_format_mask(ch);
+			val = (val >> ch->shift) & mask;
+			if (ch->is_signed && (val & ~(mask >> 1)))
+				val |= ~mask;
+			*dst++ = (int32_t)val;
+		}
+		in += fmt->scan_bytes;
+	}
+}
+
+/**
+ * @brief Convert CPU values to scans, any layout. The bits of a sample outside
+ * of realbits are cleared.
+ * @param fmt - Scan layout.
+ * @param dst - Scans of the enabled channels.
+ * @param src - One value per enabled channel and scan.
+ * @param nb_scans - Number of scans.
+ */
+static void iio_format_encode_generic(const struct iio_format *fmt, void *dst,
+				      const int32_t *src, uint32_t nb_scans)
+{
+	const struct iio_format_ch *ch;
+	uint8_t *out = dst;
+	uint32_t i, val;
+	uint16_t j;
+	uint8_t k;
+
+	for (i = 0; i < nb_scans; i++) {
+		for (j = 0; j < fmt->nb_ch; j++) {
+			ch = &fmt->ch[j];
+			val = ((uint32_t)*src++ & iio_format_mask(ch)) << ch->shift;
+			if (ch->is_big_endian)
+				for (k = ch->bytes; k > 0; k--, val >>= 8)
+					out[ch->offset + k - 1] = val & 0xFF;
+			else
+				for (k = 0; k < ch->bytes; k++, val >>= 8)
+					out[ch->offset + k] = val & 0xFF;
+		}
+		out += fmt->scan_bytes;
+	}
+}
+
+/**
+ * @brief Pick the pack/unpack and decode/encode routines for a scan layout.
+ * @param fmt - Scan layout.
+ * @param uniform - True if all the channels of the device have the same
+ * storage size.
+ */
+static void iio_format_select(struct iio_format *fmt, bool uniform)
+{
+	bool plain = IIO_FORMAT_HOST_LE;
+	bool same = fmt->scan_bytes == fmt->full_scan_bytes;
+	uint16_t i;
+
+	/* Equal scan sizes alone do not make a copy right, the disabled
+	 * channels may be small enough to fit in the padding. */
+	for (i = 0; i < fmt->nb_ch; i++)
+		if (fmt->ch[i].offset != fmt->ch[i].full_offset)
+			same = false;
+
+	if (same) {
+		fmt->pack = iio_format_copy;
+		fmt->unpack = iio_format_copy;
+	} else if (uniform) {
+		switch (fmt->ch[0].bytes) {
+		case 1:
+			fmt->pack = iio_format_pack_8;
+			fmt->unpack = iio_format_unpack_8;
+			break;
+		case 2:
+			fmt->pack = iio_format_pack_16;
+			fmt->unpack = iio_format_unpack_16;
+			break;
+		case 4:
+			fmt->pack = iio_format_pack_32;
+			fmt->unpack = iio_format_unpack_32;
+			break;
+		default:
+			fmt->pack = iio_format_pack_64;
+			fmt->unpack = iio_format_unpack_64;
+			break;
+		}
+	} else {
+		fmt->pack = iio_format_pack_generic;
+		fmt->unpack = iio_format_unpack_generic;
+	}
+
+	for (i = 0; i < fmt->nb_ch; i++) {
+		if (fmt->ch[i].bytes > 4) {
+			fmt->decode = NULL;
+			fmt->encode = NULL;
+			return;
+		}
+		if (fmt->ch[i].bytes != fmt->ch[0].bytes ||
+		    fmt->ch[i].is_signed != fmt->ch[0].is_signed ||
+		    fmt->ch[i].is_big_endian || fmt->ch[i].shift ||
+		    fmt->ch[i].realbits != fmt->ch[i].bytes * 8)
+			plain = false;
+	}
+
+	fmt->decode = iio_format_decode_generic;
+	fmt->encode = iio_format_encode_generic;
+	if (!plain)
+		return;
+
+	switch (fmt->ch[0].bytes) {
+	case 1:
+		fmt->decode = fmt->ch[0].is_signed ? iio_format_decode_s8 :
+			      iio_format_decode_u8;
+		fmt->encode = fmt->ch[0].is_signed ? iio_format_encode_s8 :
+			      iio_format_encode_u8;
+		break;
+	case 2:
+		fmt->decode = fmt->ch[0].is_signed ? iio_format_decode_s16 :
+			      iio_format_decode_u16;
+		fmt->encode = fmt->ch[0].is_signed ? iio_format_encode_s16 :
+			      iio_format_encode_u16;
+		break;
+	case 4:
+		fmt->decode = fmt->ch[0].is_signed ? iio_format_decode_s32 :
+			      iio_format_decode_u32;
+		fmt->encode = fmt->ch[0].is_signed ? iio_format_encode_s32 :
+			      iio_format_encode_u32;
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Count the enabled channels of a channel mask.
+ * @param mask - Channel mask.
+ * @param nb_ch - Number of channels of the device.
+ * @return Number of bits set among the first nb_ch.
+ */
+uint16_t iio_ch_mask_weight(const uint32_t *mask, uint16_t nb_ch)
+{
+	uint16_t i, weight = 0;
+
+	for (i = 0; i < nb_ch / 32; i++)
+		weight += hweight32(mask[i]);
+	if (nb_ch % 32)
+		weight += hweight32(mask[i] & ((1UL << (nb_ch % 32)) - 1));
+
+	return weight;
+}
+
+/**
+ * @brief Find the next enabled channel of a channel mask. Zero words are
+ * skipped whole, so iterating a sparse mask is cheap:
+ * for (ch = iio_ch_mask_next(mask, nb_ch, 0); ch < nb_ch;
+ *      ch = iio_ch_mask_next(mask, nb_ch, ch + 1))
+ * @param mask - Channel mask.
+ * @param nb_ch - Number of channels of the device.
+ * @param ch - First channel to look at.
+ * @return The first enabled channel starting with ch, nb_ch if there is none.
+ */
+uint16_t iio_ch_mask_next(const uint32_t *mask, uint16_t nb_ch, uint16_t ch)
+{
+	uint32_t word;
+
+	while (ch < nb_ch) {
+		word = mask[ch / 32] >> (ch % 32);
+		if (word) {
+			ch += find_first_set_bit(word);
+			return min(ch, nb_ch);
+		}
+		ch = (ch / 32 + 1) * 32;
+	}
+
+	return nb_ch;
+}
+
+/**
+ * @brief Parse a channel mask written as a hex string, most significant
+ * word first, as libiio sends it.
+ * @param str - Mask string.
+ * @param mask - Channel mask, IIO_CH_MASK_WORDS(nb_ch) words.
+ * @param nb_ch - Number of channels of the device.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t iio_ch_mask_parse(const char *str, uint32_t *mask, uint16_t nb_ch)
+{
+	uint32_t digit, pos;
+	size_t len;
+
+	if (!str || !mask)
+		return -EINVAL;
+
+	len = strlen(str);
+	if (!len)
+		return -EINVAL;
+
+	memset(mask, 0, IIO_CH_MASK_WORDS(nb_ch) * sizeof(*mask));
+	for (pos = 0; pos < len; pos++) {
+		digit = (uint8_t)str[len - 1 - pos];
+		if (digit >= '0' && digit <= '9')
+			digit -= '0';
+		else if (digit >= 'a' && digit <= 'f')
+			digit -= 'a' - 10;
+		else if (digit >= 'A' && digit <= 'F')
+			digit -= 'A' - 10;
+		else
+			return -EINVAL;
+
+		if (!digit)
+			continue;
+		if (pos * 4 + find_last_set_bit(digit) >= nb_ch)
+			return -EINVAL;
+		mask[pos / 8] |= digit << (pos % 8 * 4);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Build the scan layout of a device for a channel mask.
+ *
+ * Bit n of ch_mask enables dev->channels[n]. Channels with a negative
+ * scan_index are not part of the scans and can't be enabled. The routines
+ * are selected once here, so read_data/write_data only pay for the format
+ * they actually use.
+ * @param fmt - Scan layout.
+ * @param dev - Device descriptor.
+ * @param ch_mask - Enabled channels.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t iio_format_init(struct iio_format **fmt, struct iio_device *dev,
+			const uint32_t *ch_mask)
+{
+	struct iio_format *format;
+	struct scan_type *scan;
+	uint16_t *order;
+	uint16_t i, j, nb_scan_ch = 0, full_off = 0, off = 0;
+	uint8_t bytes, first_bytes = 0, max_bytes = 1, full_max_bytes = 1;
+	bool uniform = true;
+	int32_t ret;
+
+	if (!fmt || !dev || !dev->channels || !ch_mask)
+		return -EINVAL;
+
+	if (!iio_ch_mask_weight(ch_mask, dev->num_ch) ||
+	    (dev->num_ch % 32 &&
+	     ch_mask[dev->num_ch / 32] >> (dev->num_ch % 32)))
+		return -EINVAL;
+
+	order = calloc(dev->num_ch, sizeof(*order));
+	if (!order)
+		return -ENOMEM;
+
+	format = calloc(1, sizeof(*format));
+	if (!format) {
+		ret = -ENOMEM;
+		goto error_order;
+	}
+
+	format->ch = calloc(dev->num_ch, sizeof(*format->ch));
+	if (!format->ch) {
+		ret = -ENOMEM;
+		goto error_format;
+	}
+
+	/* Channels taking part in scans, sorted by scan_index */
+	for (i = 0; i < dev->num_ch; i++) {
+		if (dev->channels[i]->scan_index < 0) {
+			if (IIO_CH_MASK_TEST(ch_mask, i)) {
+				ret = -EINVAL;
+				goto error_ch;
+			}
+			continue;
+		}
+		for (j = nb_scan_ch; j > 0; j--) {
+			if (dev->channels[order[j - 1]]->scan_index <=
+			    dev->channels[i]->scan_index)
+				break;
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+		nb_scan_ch++;
+	}
+
+	for (i = 0; i < nb_scan_ch; i++) {
+		scan = &dev->channels[order[i]]->scan_type;
+		bytes = scan->storagebits / 8;
+		if ((bytes != 1 && bytes != 2 && bytes != 4 && bytes != 8) ||
+		    scan->storagebits % 8 || !scan->realbits ||
+		    scan->realbits + scan->shift > scan->storagebits) {
+			ret = -EINVAL;
+			goto error_ch;
+		}
+
+		if (!i)
+			first_bytes = bytes;
+		else if (bytes != first_bytes)
+			uniform = false;
+		full_off = IIO_FORMAT_ALIGN(full_off, bytes);
+		full_max_bytes = max(full_max_bytes, bytes);
+
+		if (IIO_CH_MASK_TEST(ch_mask, order[i])) {
+			off = IIO_FORMAT_ALIGN(off, bytes);
+			max_bytes = max(max_bytes, bytes);
+			format->ch[format->nb_ch++] = (struct iio_format_ch) {
+				.ch = order[i],
+				.offset = off,
+				.full_offset = full_off,
+				.bytes = bytes,
+				.shift = scan->shift,
+				.realbits = scan->realbits,
+				.is_signed = scan->sign == 's',
+				.is_big_endian = scan->is_big_endian,
+			};
+			off += bytes;
+		}
+		full_off += bytes;
+	}
+
+	format->scan_bytes = IIO_FORMAT_ALIGN(off, max_bytes);
+	format->full_scan_bytes = IIO_FORMAT_ALIGN(full_off, full_max_bytes);
+	iio_format_select(format, uniform);
+
+	free(order);
+	*fmt = format;
+
+	return SUCCESS;
+
+error_ch:
+	free(format->ch);
+error_format:
+	free(format);
+error_order:
+	free(order);
+
+	return ret;
+}
+
+/**
+ * @brief Free the resources allocated by iio_format_init().
+ * @param fmt - Scan layout.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t iio_format_remove(struct iio_format *fmt)
+{
+	if (!fmt)
+		return -EINVAL;
+
+	free(fmt->ch);
+	free(fmt);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Copy the enabled channels out of full scans. Typical use is a
+ * read_data callback moving the samples the device left in RAM to pbuf.
+ * Both buffers must be aligned to the largest storage size.
+ * @param fmt - Scan layout.
+ * @param dst - Scans of the enabled channels.
+ * @param src - Full scans.
+ * @param nb_scans - Number of scans.
+ * @return Number of bytes written to dst, negative error code otherwise.
+ */
+ssize_t iio_format_pack(struct iio_format *fmt, void *dst, const void *src,
+			uint32_t nb_scans)
+{
+	if (!fmt || !dst || !src)
+		return -EINVAL;
+
+	fmt->pack(fmt, dst, src, nb_scans);
+
+	return nb_scans * fmt->scan_bytes;
+}
+
+/**
+ * @brief Copy the enabled channels into full scans. Typical use is a
+ * write_data callback moving pbuf to the RAM the device reads from.
+ * Both buffers must be aligned to the largest storage size.
+ * @param fmt - Scan layout.
+ * @param dst - Full scans.
+ * @param src - Scans of the enabled channels.
+ * @param nb_scans - Number of scans.
+ * @return Number of bytes written to dst, negative error code otherwise.
+ */
+ssize_t iio_format_unpack(struct iio_format *fmt, void *dst, const void *src,
+			  uint32_t nb_scans)
+{
+	if (!fmt || !dst || !src)
+		return -EINVAL;
+
+	fmt->unpack(fmt, dst, src, nb_scans);
+
+	return nb_scans * fmt->full_scan_bytes;
+}
+
+/**
+ * @brief Shift, mask and sign extend scans into one int32_t per sample.
+ * @param fmt - Scan layout.
+ * @param dst - Values, in scan order, nb_ch per scan.
+ * @param src - Scans of the enabled channels.
+ * @param nb_scans - Number of scans.
+ * @return Number of values written to dst, negative error code otherwise.
+ */
+ssize_t iio_format_decode(struct iio_format *fmt, int32_t *dst,
+			  const void *src, uint32_t nb_scans)
+{
+	if (!fmt || !dst || !src || !fmt->decode)
+		return -EINVAL;
+
+	fmt->decode(fmt, dst, src, nb_scans);
+
+	return nb_scans * fmt->nb_ch;
+}
+
+/**
+ * @brief Place one int32_t per sample into scans. Only the realbits of each
+ * value are kept.
+ * @param fmt - Scan layout.
+ * @param dst - Scans of the enabled channels.
+ * @param src - Values, in scan order, nb_ch per scan.
+ * @param nb_scans - Number of scans.
+ * @return Number of bytes written to dst, negative error code otherwise.
+ */
+ssize_t iio_format_encode(struct iio_format *fmt, void *dst,
+			  const int32_t *src, uint32_t nb_scans)
+{
+	if (!fmt || !dst || !src || !fmt->encode)
+		return -EINVAL;
+
+	fmt->encode(fmt, dst, src, nb_scans);
+
+	return nb_scans * fmt->scan_bytes;
+}
@@ -0,0 +1,140 @@
+/***************************************************************************//**
+ *   @file   iio_format.h
+ *   @brief  Header file of the iio scan element format engine.
+ *   @author Cristian Pop (cristian.pop@analog.com)
+********************************************************************************
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef IIO_FORMAT_H_
+#define IIO_FORMAT_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "iio_types.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct iio_format_ch
+ * @brief Layout of one enabled channel inside a scan.
+ */
+struct iio_format_ch {
+	/** Index of the channel in iio_device.channels */
+	uint16_t	ch;
+	/** Byte offset of the sample in a scan of the enabled channels */
+	uint16_t	offset;
+	/** Byte offset of the sample in a scan of all the channels */
+	uint16_t	full_offset;
+	/** Storage size, in bytes */
+	uint8_t		bytes;
+	/** Shift right by this before masking out realbits */
+	uint8_t		shift;
+	/** Number of valid bits of data */
+	uint8_t		realbits;
+	/** True if the sample is signed */
+	bool		is_signed;
+	/** True if the sample is big endian */
+	bool		is_big_endian;
+};
+
+/**
+ * @struct iio_format
+ * @brief Scan layout of a device for a channel mask, together with the
+ * conversion routines picked for it.
+ *
+ * A scan holds one sample of each channel, ordered by scan_index. Each sample
+ * is aligned to its own storage size and the scan is padded to the largest
+ * one, as in the Linux IIO buffers. A "full" scan is the same layout with all
+ * the channels of the device enabled, which is how most converters leave the
+ * data in RAM.
+ */
+struct iio_format {
+	/** Number of enabled channels */
+	uint16_t		nb_ch;
+	/** Size of a scan of the enabled channels, in bytes */
+	uint16_t		scan_bytes;
+	/** Size of a scan of all the channels, in bytes */
+	uint16_t		full_scan_bytes;
+	/** Enabled channels, in scan order */
+	struct iio_format_ch	*ch;
+	/** Copy the enabled channels out of full scans */
+	void (*pack)(const struct iio_format *fmt, void *dst, const void *src,
+		     uint32_t nb_scans);
+	/** Copy the enabled channels into full scans */
+	void (*unpack)(const struct iio_format *fmt, void *dst, const void *src,
+		       uint32_t nb_scans);
+	/** Convert scans to CPU values. NULL if a sample is wider than 32 bits */
+	void (*decode)(const struct iio_format *fmt, int32_t *dst,
+		       const void *src, uint32_t nb_scans);
+	/** Convert CPU values to scans. NULL if a sample is wider than 32 bits */
+	void (*encode)(const struct iio_format *fmt, void *dst,
+		       const int32_t *src, uint32_t nb_scans);
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Count the enabled channels of a channel mask. */
+uint16_t iio_ch_mask_weight(const uint32_t *mask, uint16_t nb_ch);
+/* Find the next enabled channel of a channel mask. */
+uint16_t iio_ch_mask_next(const uint32_t *mask, uint16_t nb_ch, uint16_t ch);
+/* Parse a channel mask written as a hex string. */
+int32_t iio_ch_mask_parse(const char *str, uint32_t *mask, uint16_t nb_ch);
+/* Build the scan layout of the channels of ch_mask. */
+int32_t iio_format_init(struct iio_format **fmt, struct iio_device *dev,
+			const uint32_t *ch_mask);
+/* Free the resources allocated by iio_format_init(). */
+int32_t iio_format_remove(struct iio_format *fmt);
+/* Copy the enabled channels out of full scans. */
+ssize_t iio_format_pack(struct iio_format *fmt, void *dst, const void *src,
+			uint32_t nb_scans);
+/* Copy the enabled channels into full scans. */
+ssize_t iio_format_unpack(struct iio_format *fmt, void *dst, const void *src,
+			  uint32_t nb_scans);
+/* Shift, mask and sign extend scans into one int32_t per sample. */
+ssize_t iio_format_decode(struct iio_format *fmt, int32_t *dst,
+			  const void *src, uint32_t nb_scans);
+/* Place one int32_t per sample into scans. */
+ssize_t iio_format_encode(struct iio_format *fmt, void *dst,
+			  const int32_t *src, uint32_t nb_scans);
+
+#endif /* IIO_FORMAT_H_ */
@@ -47,6 +47,16 @@
 #include <stdint.h>
 #include <sys/types.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Number of 32-bit words of a channel mask. Bit n of word n / 32 stands for
+ * channel n of the device */
+#define IIO_CH_MASK_WORDS(nb_ch)	(((nb_ch) + 31) / 32)
+/* True if channel ch is set in a channel mask */
+#define IIO_CH_MASK_TEST(mask, ch)	(((mask)[(ch) / 32] >> ((ch) % 32)) & 1)
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -85,6 +95,9 @@ struct iio_attribute {
 	/** Store function pointer */
 	ssize_t (*store)(void *device, char *buf, size_t len,
 			 const struct iio_ch_info *channel);
+	/** Time, in milliseconds, a show result is reused for before the
+	 * device is read again. Any store drops it. 0 disables caching */
+	uint32_t cache_ms;
 };
 
 /**
@@ -140,16 +153,16 @@ struct iio_device {
 	struct iio_attribute **buffer_attributes;
 	/** Transfer data from device into RAM */
 	ssize_t (*transfer_dev_to_mem)(void *dev_instance, size_t bytes_count,
-				       uint32_t ch_mask);
+				       const uint32_t *ch_mask);
 	/** Read data from RAM to pbuf. It should be called after "transfer_dev_to_mem" */
 	ssize_t (*read_data)(void *dev_instance, char *pbuf, size_t offset,
-			     size_t bytes_count, uint32_t ch_mask);
+			     size_t bytes_count, const uint32_t *ch_mask);
 	/** Transfer data from RAM to device */
 	ssize_t (*transfer_mem_to_dev)(void *dev_instance, size_t bytes_count,
-				       uint32_t ch_mask);
+				       const uint32_t *ch_mask);
 	/** Write data to RAM. It should be called before "transfer_mem_to_dev" */
 	ssize_t (*write_data)(void *dev_instance, char *pbuf, size_t offset,
-			      size_t bytes_count, uint32_t ch_mask);
+			      size_t bytes_count, const uint32_t *ch_mask);
 };
 
 #endif /* IIO_TYPES_H_ */
@@ -44,6 +44,7 @@
 
 #include <stdlib.h>
 #include "error.h"
+#include "pool.h"
 #include "tcp_socket.h"
 #include "util.h"
 
@@ -274,7 +275,7 @@ int32_t socket_init(struct tcp_socket_desc **desc,
 	if (!desc || !param)
 		return FAILURE;
 
-	ldesc = (typeof(ldesc))calloc(1, sizeof(*ldesc));
+	ldesc = (typeof(ldesc))pool_heap_calloc(1, sizeof(*ldesc));
 	if (!ldesc)
 		return FAILURE;
 
@@ -288,7 +289,7 @@ int32_t socket_init(struct tcp_socket_desc **desc,
 	ret = ldesc->net->socket_open(ldesc->net->net, &ldesc->id, PROTOCOL_TCP,
 				      buff_size);
 	if (IS_ERR_VALUE(ret)) {
-		free(ldesc);
+		pool_heap_free(ldesc);
 		return ret;
 	}
 
@@ -300,7 +301,7 @@ int32_t socket_init(struct tcp_socket_desc **desc,
 				       param->secure_init_param);
 	if (IS_ERR_VALUE(ret)) {
 		ldesc->net->socket_close(ldesc->net->net, ldesc->id);
-		free(ldesc);
+		pool_heap_free(ldesc);
 		return ret;
 	}
 #endif /* DISABLE_SECURE_SOCKET */
@@ -332,7 +333,7 @@ int32_t socket_remove(struct tcp_socket_desc *desc)
 	ret = desc->net->socket_close(desc->net->net, desc->id);
 	if (IS_ERR_VALUE(ret))
 		return ret;
-	free(desc);
+	pool_heap_free(desc);
 
 	return SUCCESS;
 }
@@ -455,7 +456,8 @@ int32_t socket_accept(struct tcp_socket_desc *desc,
 	if (IS_ERR_VALUE(ret))
 		return ret;
 
-	*new_client = (typeof(*new_client))calloc(1, sizeof(**new_client));
+	*new_client = (typeof(*new_client))pool_heap_calloc(1,
+			sizeof(**new_client));
 	if (!*new_client) {
 		desc->net->socket_close(desc->net->net, desc->id);
 		return -ENOMEM;
@@ -12,9 +12,11 @@
 SRCS := $(PROJECT)/src/ad7124-4sdz.c
 SRCS += $(DRIVERS)/spi/spi.c						\
 	$(DRIVERS)/adc/ad7124/ad7124.c					\
-	$(DRIVERS)/adc/ad7124/ad7124_regs.c				
+	$(DRIVERS)/adc/ad7124/ad7124_regs.c				\
+	$(NO-OS)/util/circular_buffer.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/xilinx_spi.c				\
+	$(PLATFORM_DRIVERS)/irq.c					\
 	$(PLATFORM_DRIVERS)/delay.c
 INCS += $(DRIVERS)/adc/ad7124/ad7124.h					\
 	$(DRIVERS)/adc/ad7124/ad7124_regs.h
@@ -29,5 +31,6 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
 	$(INCLUDE)/irq.h						\
+	$(INCLUDE)/circular_buffer.h					\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/util.h
@@ -580,14 +580,11 @@ int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 {
 	int32_t ret = 0;
 	uint16_t cmd;
-	uint8_t *rbuffer;
+	uint8_t rbuffer[MAX_MBYTE_SPI + 2];
 	if (num > MAX_MBYTE_SPI)
 		return -EINVAL;
 
 	cmd = AD_READ | AD_CNT(num) | AD_ADDR(reg);
-	rbuffer = malloc(num + 2);
-	if(!rbuffer)
-		return -ENOMEM;
 	rbuffer[0] = cmd >> 8;
 	rbuffer[1] = cmd & 0xFF;
 	ret = spi_write_and_read(spi, &rbuffer[0], 2 + num);
@@ -597,7 +594,6 @@ int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 	else
 		memcpy(rbuf, &rbuffer[2], num);
 
-	free(rbuffer);
 #ifdef _DEBUG
 	{
 		int32_t i;
@@ -4804,22 +4800,18 @@ int32_t ad9361_fastlock_load(struct ad9361_rf_phy *phy, bool tx,
 }
 
 /**
- * Fastlock store.
+ * Fastlock capture of the profile words matching the current LO settings.
  * @param phy The AD9361 state structure.
  * @param tx
- * @param profile
- * @return 0 in case of success, negative error code otherwise.
+ * @param val The 16 profile words.
+ * @return None.
  */
-int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx,
-			      uint32_t profile)
+static void ad9361_fastlock_capture(struct ad9361_rf_phy *phy, bool tx,
+				    uint8_t *val)
 {
 	struct spi_desc *spi = phy->spi;
-	uint8_t val[16];
 	uint32_t offs = 0, x, y;
 
-	dev_dbg(&phy->spi->dev, "%s: %s Profile %"PRIu32":",
-		__func__, tx ? "TX" : "RX", profile);
-
 	if (tx)
 		offs = REG_TX_FAST_LOCK_SETUP - REG_RX_FAST_LOCK_SETUP;
 
@@ -4870,6 +4862,24 @@ int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx,
 	x = ad9361_spi_readf(spi, REG_RX_FORCE_ALC + offs, FORCE_ALC_WORD(~0));
 	y = ad9361_spi_readf(spi, REG_RX_FORCE_VCO_TUNE_1 + offs, FORCE_VCO_TUNE);
 	val[15] = (x << 1) | y;
+}
+
+/**
+ * Fastlock store.
+ * @param phy The AD9361 state structure.
+ * @param tx
+ * @param profile
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_store(struct ad9361_rf_phy *phy, bool tx,
+			      uint32_t profile)
+{
+	uint8_t val[RX_FAST_LOCK_CONFIG_WORD_NUM];
+
+	dev_dbg(&phy->spi->dev, "%s: %s Profile %"PRIu32":",
+		__func__, tx ? "TX" : "RX", profile);
+
+	ad9361_fastlock_capture(phy, tx, val);
 
 	return ad9361_fastlock_load(phy, tx, profile, val);
 }
@@ -5010,6 +5020,386 @@ int32_t ad9361_fastlock_save(struct ad9361_rf_phy *phy, bool tx,
 	return 0;
 }
 
+/**
+ * Fastlock profile manager initialization.
+ *
+ * The manager caches any number of calibrated LO profiles in RAM and pages
+ * them into the 8 hardware profile slots of one synthesizer. Once created,
+ * it owns all the fastlock slots of that synthesizer: profiles must not be
+ * stored or loaded behind its back.
+ * @param phy The AD9361 state structure.
+ * @param mgr The fastlock profile manager.
+ * @param init_param The structure that contains the manager parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_init(struct ad9361_rf_phy *phy,
+				 struct ad9361_fastlock_mgr **mgr,
+				 const struct ad9361_fastlock_mgr_init_param *init_param)
+{
+	struct ad9361_fastlock_mgr *m;
+	uint32_t i;
+
+	if (!init_param->max_profiles)
+		return -EINVAL;
+
+	m = (struct ad9361_fastlock_mgr *)calloc(1, sizeof(*m));
+	if (!m)
+		return -ENOMEM;
+
+	m->profiles = (struct ad9361_fastlock_profile *)
+		      calloc(init_param->max_profiles, sizeof(*m->profiles));
+	if (!m->profiles) {
+		free(m);
+		return -ENOMEM;
+	}
+
+	m->phy = phy;
+	m->tx = init_param->tx;
+	m->max_profiles = init_param->max_profiles;
+	m->lookahead = init_param->lookahead;
+	m->auto_prefetch = init_param->auto_prefetch;
+	for (i = 0; i < AD9361_FASTLOCK_HW_PROFILES; i++)
+		m->slot_owner[i] = -1;
+
+	*mgr = m;
+
+	return 0;
+}
+
+/**
+ * Free the resources allocated by ad9361_fastlock_mgr_init().
+ * @param mgr The fastlock profile manager.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_remove(struct ad9361_fastlock_mgr *mgr)
+{
+	if (!mgr)
+		return -EINVAL;
+
+	free(mgr->schedule);
+	free(mgr->profiles);
+	free(mgr);
+
+	return 0;
+}
+
+/**
+ * Calibrate the synthesizer at a LO frequency and cache the resulting profile.
+ *
+ * This runs a full VCO calibration and leaves the synthesizer out of
+ * fastlock mode, tuned to the new frequency. Adding an already cached
+ * frequency returns the existing profile.
+ * @param mgr The fastlock profile manager.
+ * @param lo_freq_hz The LO frequency (Hz).
+ * @param id The id of the cached profile.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_add(struct ad9361_fastlock_mgr *mgr,
+				uint64_t lo_freq_hz, uint32_t *id)
+{
+	struct ad9361_rf_phy *phy = mgr->phy;
+	struct ad9361_fastlock_profile *prof;
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < mgr->nb_profiles; i++) {
+		if (mgr->profiles[i].lo_freq_hz == lo_freq_hz) {
+			*id = i;
+			return 0;
+		}
+	}
+
+	if (mgr->nb_profiles == mgr->max_profiles)
+		return -ENOMEM;
+
+	ret = clk_set_rate(phy, phy->ref_clk_scale[mgr->tx ? TX_RFPLL : RX_RFPLL],
+			   ad9361_to_clk(lo_freq_hz));
+	if (ret < 0)
+		return ret;
+
+	prof = &mgr->profiles[mgr->nb_profiles];
+	ad9361_fastlock_capture(phy, mgr->tx, prof->values);
+	prof->lo_freq_hz = lo_freq_hz;
+	prof->slot = -1;
+
+	*id = mgr->nb_profiles++;
+
+	return 0;
+}
+
+/**
+ * Set the hop schedule used to page profiles into the hardware slots.
+ *
+ * The schedule is copied and wraps around once its end is reached.
+ * @param mgr The fastlock profile manager.
+ * @param ids The profile ids, in hop order. NULL clears the schedule.
+ * @param len Number of entries in the schedule.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_set_schedule(struct ad9361_fastlock_mgr *mgr,
+		const uint32_t *ids, uint32_t len)
+{
+	uint32_t *schedule = NULL;
+	uint32_t i;
+
+	if (ids && len) {
+		for (i = 0; i < len; i++)
+			if (ids[i] >= mgr->nb_profiles)
+				return -EINVAL;
+
+		schedule = (uint32_t *)malloc(len * sizeof(*schedule));
+		if (!schedule)
+			return -ENOMEM;
+		memcpy(schedule, ids, len * sizeof(*schedule));
+	} else {
+		len = 0;
+	}
+
+	free(mgr->schedule);
+	mgr->schedule = schedule;
+	mgr->schedule_len = len;
+	mgr->schedule_pos = 0;
+
+	return 0;
+}
+
+/**
+ * Distance, in schedule entries, to the next use of a cached profile.
+ * @param mgr The fastlock profile manager.
+ * @param id The profile id.
+ * @return The distance, lookahead + 1 if the profile is not needed within
+ *         the lookahead window.
+ */
+static uint32_t ad9361_fastlock_mgr_next_use(struct ad9361_fastlock_mgr *mgr,
+		uint32_t id)
+{
+	uint32_t i, n;
+
+	n = min(mgr->lookahead, mgr->schedule_len);
+	for (i = 0; i < n; i++)
+		if (mgr->schedule[(mgr->schedule_pos + i) % mgr->schedule_len] == id)
+			return i;
+
+	return mgr->lookahead + 1;
+}
+
+/**
+ * Pick the hardware slot to page a profile into.
+ *
+ * A free slot is used first. Otherwise the slot whose profile is needed
+ * last in the lookahead window is evicted, the least recently used one
+ * among equals. The active slot and the slots needed before the incoming
+ * profile are never evicted.
+ * @param mgr The fastlock profile manager.
+ * @param need Distance to the use of the incoming profile.
+ * @return The slot, -EAGAIN if no slot can be evicted.
+ */
+static int32_t ad9361_fastlock_mgr_victim(struct ad9361_fastlock_mgr *mgr,
+		uint32_t need)
+{
+	int32_t active = mgr->phy->fastlock.current_profile[mgr->tx] - 1;
+	int32_t slot, victim = -EAGAIN;
+	uint32_t dist, victim_dist = 0;
+
+	for (slot = 0; slot < AD9361_FASTLOCK_HW_PROFILES; slot++) {
+		if (mgr->slot_owner[slot] < 0)
+			return slot;
+		if (slot == active)
+			continue;
+
+		dist = ad9361_fastlock_mgr_next_use(mgr, mgr->slot_owner[slot]);
+		if (dist <= need)
+			continue;
+
+		if ((victim < 0) || (dist > victim_dist) ||
+		    ((dist == victim_dist) &&
+		     (mgr->slot_stamp[slot] < mgr->slot_stamp[victim]))) {
+			victim = slot;
+			victim_dist = dist;
+		}
+	}
+
+	return victim;
+}
+
+/**
+ * Program a hardware slot with the minimum number of SPI writes.
+ * @param mgr The fastlock profile manager.
+ * @param slot The hardware slot.
+ * @param values The 16 profile words.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_fastlock_mgr_program(struct ad9361_fastlock_mgr *mgr,
+		uint32_t slot, const uint8_t *values)
+{
+	struct ad9361_rf_phy *phy = mgr->phy;
+	uint8_t *hw = mgr->slot_values[slot];
+	uint32_t i, diff = 0, last = 0;
+	int32_t ret = 0;
+
+	for (i = 0; i < RX_FAST_LOCK_CONFIG_WORD_NUM; i++) {
+		if (hw[i] != values[i]) {
+			diff++;
+			last = i;
+		}
+	}
+
+	/*
+	 * A single word costs three register writes, a full load takes
+	 * 18 SPI transfers. Unknown slot contents always get a full load.
+	 */
+	if ((mgr->slot_owner[slot] < 0) || (3 * diff + 1 >= 18)) {
+		memcpy(hw, values, RX_FAST_LOCK_CONFIG_WORD_NUM);
+		ret = ad9361_fastlock_load(phy, mgr->tx, slot, hw);
+	} else {
+		for (i = 0; i < RX_FAST_LOCK_CONFIG_WORD_NUM; i++) {
+			if (hw[i] == values[i])
+				continue;
+			ret |= ad9361_fastlock_writeval(phy->spi, mgr->tx, slot, i,
+							values[i], i == last);
+			hw[i] = values[i];
+		}
+
+		phy->fastlock.entry[mgr->tx][slot].flags = FASTLOOK_INIT;
+		phy->fastlock.entry[mgr->tx][slot].alc_orig = values[15];
+		phy->fastlock.entry[mgr->tx][slot].alc_written = values[15];
+	}
+
+	if (ret < 0) {
+		/* Contents are unknown after a failed write */
+		if (mgr->slot_owner[slot] >= 0)
+			mgr->profiles[mgr->slot_owner[slot]].slot = -1;
+		mgr->slot_owner[slot] = -1;
+		phy->fastlock.entry[mgr->tx][slot].flags = 0;
+	}
+
+	return ret;
+}
+
+/**
+ * Make a cached profile resident in a hardware slot.
+ * @param mgr The fastlock profile manager.
+ * @param id The profile id.
+ * @param need Distance to the use of the profile.
+ * @return The slot in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_fastlock_mgr_page_in(struct ad9361_fastlock_mgr *mgr,
+		uint32_t id, uint32_t need)
+{
+	struct ad9361_fastlock_profile *prof = &mgr->profiles[id];
+	int32_t slot, ret;
+
+	if (prof->slot >= 0) {
+		mgr->slot_hits++;
+		return prof->slot;
+	}
+
+	slot = ad9361_fastlock_mgr_victim(mgr, need);
+	if (slot < 0)
+		return slot;
+
+	ret = ad9361_fastlock_mgr_program(mgr, slot, prof->values);
+	if (ret < 0)
+		return ret;
+
+	if (mgr->slot_owner[slot] >= 0)
+		mgr->profiles[mgr->slot_owner[slot]].slot = -1;
+	mgr->slot_owner[slot] = id;
+	mgr->slot_stamp[slot] = ++mgr->stamp;
+	prof->slot = slot;
+	mgr->slot_loads++;
+
+	return slot;
+}
+
+/**
+ * Load the profiles needed within the lookahead window into the hardware
+ * slots, so that the next hops are plain recalls.
+ *
+ * Intended to run between hops; profiles needed sooner than every resident
+ * one are left in RAM.
+ * @param mgr The fastlock profile manager.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_prefetch(struct ad9361_fastlock_mgr *mgr)
+{
+	uint32_t i, n, id;
+	int32_t ret;
+
+	n = min(mgr->lookahead, mgr->schedule_len);
+	for (i = 0; i < n; i++) {
+		id = mgr->schedule[(mgr->schedule_pos + i) % mgr->schedule_len];
+		if (mgr->profiles[id].slot >= 0)
+			continue;
+
+		ret = ad9361_fastlock_mgr_page_in(mgr, id, i);
+		if (ret == -EAGAIN)
+			break;
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * Hop to a cached profile.
+ *
+ * A resident profile is recalled with a single register write. Otherwise
+ * it is first paged into a slot, writing only the words that differ from
+ * the slot contents.
+ * @param mgr The fastlock profile manager.
+ * @param id The profile id.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_hop(struct ad9361_fastlock_mgr *mgr, uint32_t id)
+{
+	struct ad9361_rf_phy *phy = mgr->phy;
+	int32_t slot, ret;
+
+	if (id >= mgr->nb_profiles)
+		return -EINVAL;
+
+	slot = ad9361_fastlock_mgr_page_in(mgr, id, 0);
+	if (slot < 0)
+		return slot;
+
+	ret = ad9361_fastlock_recall(phy, mgr->tx, slot);
+	if (ret < 0)
+		return ret;
+
+	/* The recall may rewrite the ALC word of the slot */
+	mgr->slot_values[slot][15] = phy->fastlock.entry[mgr->tx][slot].alc_written;
+	mgr->slot_stamp[slot] = ++mgr->stamp;
+
+	if (mgr->auto_prefetch)
+		return ad9361_fastlock_mgr_prefetch(mgr);
+
+	return 0;
+}
+
+/**
+ * Hop to the next profile of the hop schedule.
+ * @param mgr The fastlock profile manager.
+ * @param id The id of the profile hopped to. May be NULL.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_fastlock_mgr_hop_next(struct ad9361_fastlock_mgr *mgr,
+				     uint32_t *id)
+{
+	uint32_t next;
+
+	if (!mgr->schedule_len)
+		return -EINVAL;
+
+	next = mgr->schedule[mgr->schedule_pos];
+	mgr->schedule_pos = (mgr->schedule_pos + 1) % mgr->schedule_len;
+	if (id)
+		*id = next;
+
+	return ad9361_fastlock_mgr_hop(mgr, next);
+}
+
 /**
  * Multi Chip Sync (MCS) config.
  * @param phy The AD9361 state structure.
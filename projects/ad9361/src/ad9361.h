@@ -3290,6 +3290,43 @@ struct ad9361_fastlock {
 	struct ad9361_fastlock_entry entry[2][8];
 };
 
+#define AD9361_FASTLOCK_HW_PROFILES	8
+
+struct ad9361_fastlock_profile {
+	uint64_t lo_freq_hz;
+	uint8_t values[RX_FAST_LOCK_CONFIG_WORD_NUM];
+	int8_t slot;
+};
+
+struct ad9361_fastlock_mgr_init_param {
+	bool tx;
+	uint32_t max_profiles;
+	uint32_t lookahead;
+	bool auto_prefetch;
+};
+
+struct ad9361_fastlock_mgr {
+	struct ad9361_rf_phy *phy;
+	bool tx;
+	struct ad9361_fastlock_profile *profiles;
+	uint32_t nb_profiles;
+	uint32_t max_profiles;
+	/* Profile held by each hardware slot, -1 if free */
+	int32_t slot_owner[AD9361_FASTLOCK_HW_PROFILES];
+	uint32_t slot_stamp[AD9361_FASTLOCK_HW_PROFILES];
+	/* Shadow of the words programmed in each hardware slot */
+	uint8_t slot_values[AD9361_FASTLOCK_HW_PROFILES]
+	[RX_FAST_LOCK_CONFIG_WORD_NUM];
+	uint32_t stamp;
+	uint32_t *schedule;
+	uint32_t schedule_len;
+	uint32_t schedule_pos;
+	uint32_t lookahead;
+	bool auto_prefetch;
+	uint32_t slot_loads;
+	uint32_t slot_hits;
+};
+
 enum dig_tune_flags {
 	BE_VERBOSE = 1,
 	BE_MOREVERBOSE = 2,
@@ -3514,6 +3551,18 @@ int32_t ad9361_fastlock_load(struct ad9361_rf_phy *phy, bool tx,
 			     uint32_t profile, uint8_t *values);
 int32_t ad9361_fastlock_save(struct ad9361_rf_phy *phy, bool tx,
 			     uint32_t profile, uint8_t *values);
+int32_t ad9361_fastlock_mgr_init(struct ad9361_rf_phy *phy,
+				 struct ad9361_fastlock_mgr **mgr,
+				 const struct ad9361_fastlock_mgr_init_param *init_param);
+int32_t ad9361_fastlock_mgr_remove(struct ad9361_fastlock_mgr *mgr);
+int32_t ad9361_fastlock_mgr_add(struct ad9361_fastlock_mgr *mgr,
+				uint64_t lo_freq_hz, uint32_t *id);
+int32_t ad9361_fastlock_mgr_set_schedule(struct ad9361_fastlock_mgr *mgr,
+		const uint32_t *ids, uint32_t len);
+int32_t ad9361_fastlock_mgr_prefetch(struct ad9361_fastlock_mgr *mgr);
+int32_t ad9361_fastlock_mgr_hop(struct ad9361_fastlock_mgr *mgr, uint32_t id);
+int32_t ad9361_fastlock_mgr_hop_next(struct ad9361_fastlock_mgr *mgr,
+				     uint32_t *id);
 void ad9361_ensm_force_state(struct ad9361_rf_phy *phy, uint8_t ensm_state);
 uint8_t ad9361_ensm_get_state(struct ad9361_rf_phy *phy);
 void ad9361_ensm_restore_state(struct ad9361_rf_phy *phy, uint8_t ensm_state);
@@ -45,6 +45,7 @@
 #include <stdlib.h>
 #include "fifo.h"
 #include "error.h"
+#include "pool.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -58,14 +59,14 @@
  */
 static struct fifo_element * fifo_new_element(char *buff, uint32_t len)
 {
-	struct fifo_element *q = calloc(1, sizeof(struct fifo_element));
+	struct fifo_element *q = pool_heap_calloc(1, sizeof(*q));
 	if (!q)
 		return NULL;
 
 	q->len = len;
-	q->data = calloc(1, len);
+	q->data = pool_heap_calloc(1, len);
 	if (!(q->data)) {
-		free(q);
+		pool_heap_free(q);
 		return NULL;
 	}
 	memcpy(q->data, buff, len);
@@ -128,8 +129,8 @@ struct fifo_element * fifo_remove(struct fifo_element *p_fifo)
 
 	if (p_fifo != NULL) {
 		p_fifo = p_fifo->next;
-		free(p->data);
-		free(p);
+		pool_heap_free(p->data);
+		pool_heap_free(p);
 	}
 
 	return p_fifo;
@@ -43,6 +43,7 @@
 
 #include "list.h"
 #include "error.h"
+#include "pool.h"
 #include <stdlib.h>
 
 /******************************************************************************/
@@ -111,7 +112,7 @@ static inline struct list_elem *create_element(void *data,
 {
 	struct list_elem *elem;
 
-	elem = (struct list_elem *)calloc(1, sizeof(*elem));
+	elem = (struct list_elem *)pool_heap_calloc(1, sizeof(*elem));
 	if (!elem)
 		return NULL;
 	elem->data = data;
@@ -558,7 +559,7 @@ int32_t list_get_first(struct list_desc *list_desc, void **data)
 	list->nb_elements--;
 
 	*data = elem->data;
-	free(elem);
+	pool_heap_free(elem);
 
 	return SUCCESS;
 }
@@ -588,7 +589,7 @@ int32_t list_get_last(struct list_desc *list_desc, void **data)
 	list->nb_elements--;
 
 	*data = elem->data;
-	free(elem);
+	pool_heap_free(elem);
 
 	return SUCCESS;
 }
@@ -784,7 +785,7 @@ int32_t iterator_get(struct iterator *iter, void **data)
 		next = it->elem->prev;
 	else
 		next = it->elem->next;
-	free(it->elem);
+	pool_heap_free(it->elem);
 	it->elem = next;
 
 	return SUCCESS;
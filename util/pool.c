@@ -0,0 +1,499 @@
+/***************************************************************************//**
+ *   @file   pool.c
+ *   @brief  Fixed-block pool and arena allocators implementation
+ *   @author Mihail Chindris (mihail.chindris@analog.com)
+********************************************************************************
+ *   @copyright
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include "pool.h"
+#include "error.h"
+#include "util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Alignment of the blocks and of the arena allocations */
+#define POOL_ALIGN		8u
+#define POOL_ALIGN_UP(x)	(((x) + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1))
+
+#ifdef ENABLE_POOL_ALLOC
+/* Blocks of each size class of the hot path allocator */
+#ifndef POOL_HEAP_BLOCKS
+#define POOL_HEAP_BLOCKS	32
+#endif
+/* Size classes are 16, 32, 64, 128 and 256 bytes */
+#define POOL_HEAP_CLASSES	5
+#define POOL_HEAP_MIN_BLOCK	16u
+#endif
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct pool
+ * @brief Fixed-block pool descriptor
+ *
+ * Free blocks are chained through their first word, so allocating and
+ * freeing are a single list operation.
+ */
+struct pool {
+	/** Block storage */
+	uint8_t			*mem;
+	/** First free block */
+	void			*free_list;
+	/** Set if mem was allocated by pool_init() */
+	bool			own_mem;
+	/** Block size and usage */
+	struct pool_stats	stats;
+};
+
+/**
+ * @struct arena
+ * @brief Arena descriptor
+ *
+ * Allocations are carved one after the other and only released all at once,
+ * by arena_reset().
+ */
+struct arena {
+	/** Arena storage */
+	uint8_t		*mem;
+	/** Size of the storage in bytes */
+	uint32_t	size;
+	/** Bytes in use */
+	uint32_t	offset;
+	/** Highest offset since the arena was created */
+	uint32_t	peak;
+	/** Set if mem was allocated by arena_init() */
+	bool		own_mem;
+};
+
+#ifdef ENABLE_POOL_ALLOC
+/** Storage of all the size classes */
+static uint64_t pool_heap_mem[POOL_HEAP_BLOCKS * POOL_HEAP_MIN_BLOCK *
+			      ((1u << POOL_HEAP_CLASSES) - 1) /
+			      sizeof(uint64_t)];
+/** One pool per size class */
+static struct pool pool_heap[POOL_HEAP_CLASSES];
+/** Set once the size classes are set up */
+static bool pool_heap_ready;
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Chain all the blocks of a pool in its free list.
+ * @param desc - Pool reference
+ * @param block_size - Block size, already aligned
+ * @param nb_blocks - Number of blocks
+ * @param mem - Block storage
+ */
+static void pool_setup(struct pool *desc, uint32_t block_size,
+		       uint32_t nb_blocks, uint8_t *mem)
+{
+	uint32_t i;
+
+	desc->mem = mem;
+	desc->stats.block_size = block_size;
+	desc->stats.nb_blocks = nb_blocks;
+	desc->free_list = NULL;
+	for (i = nb_blocks; i > 0; i--) {
+		*(void **)(mem + (i - 1) * block_size) = desc->free_list;
+		desc->free_list = mem + (i - 1) * block_size;
+	}
+}
+
+/**
+ * @brief Create a fixed-block pool
+ *
+ * @note Pools are not thread or interrupt safe. A pool shared with an
+ * interrupt handler must be accessed with the interrupt disabled.
+ *
+ * @param desc - Where to store the pool reference
+ * @param block_size - Block size, rounded up to 8 bytes
+ * @param nb_blocks - Number of blocks
+ * @param mem - Storage of nb_blocks blocks, 8 bytes aligned. If NULL it is
+ * allocated once here.
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL, -ENOMEM : Otherwise
+ */
+int32_t pool_init(struct pool **desc, uint32_t block_size, uint32_t nb_blocks,
+		  void *mem)
+{
+	struct pool	*ldesc;
+
+	if (!desc || !block_size || !nb_blocks)
+		return -EINVAL;
+
+	block_size = POOL_ALIGN_UP(max_t(uint32_t, block_size, sizeof(void *)));
+
+	ldesc = (struct pool *)calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	if (!mem) {
+		mem = malloc(block_size * nb_blocks);
+		if (!mem) {
+			free(ldesc);
+			return -ENOMEM;
+		}
+		ldesc->own_mem = true;
+	}
+
+	pool_setup(ldesc, block_size, nb_blocks, mem);
+	*desc = ldesc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by pool_init()
+ * @param desc - Pool reference
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t pool_remove(struct pool *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	if (desc->own_mem)
+		free(desc->mem);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Allocate a block
+ * @param desc - Pool reference
+ * @return Address of the block, NULL if the pool is empty
+ */
+void *pool_alloc(struct pool *desc)
+{
+	void *block;
+
+	if (!desc)
+		return NULL;
+
+	block = desc->free_list;
+	if (!block) {
+		desc->stats.failures++;
+		return NULL;
+	}
+
+	desc->free_list = *(void **)block;
+	desc->stats.used++;
+	desc->stats.peak = max(desc->stats.peak, desc->stats.used);
+
+	return block;
+}
+
+/**
+ * @brief Check if an address belongs to a pool
+ * @param desc - Pool reference
+ * @param ptr - Address
+ * @return true if ptr is inside the pool storage
+ */
+bool pool_owns(struct pool *desc, const void *ptr)
+{
+	const uint8_t *p = ptr;
+
+	return desc && p >= desc->mem &&
+	       p < desc->mem + desc->stats.block_size * desc->stats.nb_blocks;
+}
+
+/**
+ * @brief Give a block back to its pool
+ * @param desc - Pool reference
+ * @param block - Block returned by pool_alloc()
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : If block is not a block of the pool
+ */
+int32_t pool_free(struct pool *desc, void *block)
+{
+	if (!pool_owns(desc, block) ||
+	    ((uint8_t *)block - desc->mem) % desc->stats.block_size)
+		return -EINVAL;
+
+	*(void **)block = desc->free_list;
+	desc->free_list = block;
+	desc->stats.used--;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the usage statistics of a pool
+ * @param desc - Pool reference
+ * @param stats - Where to store the statistics
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t pool_get_stats(struct pool *desc, struct pool_stats *stats)
+{
+	if (!desc || !stats)
+		return -EINVAL;
+
+	*stats = desc->stats;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Create an arena
+ * @param desc - Where to store the arena reference
+ * @param size - Size of the arena in bytes
+ * @param mem - Storage of size bytes. If NULL it is allocated once here.
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL, -ENOMEM : Otherwise
+ */
+int32_t arena_init(struct arena **desc, uint32_t size, void *mem)
+{
+	struct arena	*ldesc;
+
+	if (!desc || !size)
+		return -EINVAL;
+
+	ldesc = (struct arena *)calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	if (!mem) {
+		mem = malloc(size);
+		if (!mem) {
+			free(ldesc);
+			return -ENOMEM;
+		}
+		ldesc->own_mem = true;
+	}
+
+	ldesc->mem = mem;
+	ldesc->size = size;
+	*desc = ldesc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by arena_init()
+ * @param desc - Arena reference
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t arena_remove(struct arena *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	if (desc->own_mem)
+		free(desc->mem);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Allocate from an arena. There is no per allocation free.
+ * @param desc - Arena reference
+ * @param size - Number of bytes
+ * @return Address of the allocation, 8 bytes aligned, NULL if the arena is
+ * full
+ */
+void *arena_alloc(struct arena *desc, uint32_t size)
+{
+	uintptr_t addr;
+	uint32_t offset;
+
+	if (!desc || !size)
+		return NULL;
+
+	addr = POOL_ALIGN_UP((uintptr_t)(desc->mem + desc->offset));
+	offset = addr - (uintptr_t)desc->mem;
+	if (offset > desc->size || size > desc->size - offset)
+		return NULL;
+
+	desc->offset = offset + size;
+	desc->peak = max(desc->peak, desc->offset);
+
+	return (void *)addr;
+}
+
+/**
+ * @brief Release all the allocations of an arena at once
+ * @param desc - Arena reference
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t arena_reset(struct arena *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	desc->offset = 0;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the usage of an arena
+ * @param desc - Arena reference
+ * @param used - Where to store the bytes in use
+ * @param peak - Where to store the highest usage
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t arena_get_usage(struct arena *desc, uint32_t *used, uint32_t *peak)
+{
+	if (!desc || !used || !peak)
+		return -EINVAL;
+
+	*used = desc->offset;
+	*peak = desc->peak;
+
+	return SUCCESS;
+}
+
+#ifdef ENABLE_POOL_ALLOC
+/**
+ * @brief Set up the size classes of the hot path allocator.
+ */
+static void pool_heap_setup(void)
+{
+	uint8_t *mem = (uint8_t *)pool_heap_mem;
+	uint32_t i, block_size = POOL_HEAP_MIN_BLOCK;
+
+	for (i = 0; i < POOL_HEAP_CLASSES; i++, block_size <<= 1) {
+		pool_setup(&pool_heap[i], block_size, POOL_HEAP_BLOCKS, mem);
+		mem += block_size * POOL_HEAP_BLOCKS;
+	}
+	pool_heap_ready = true;
+}
+
+/**
+ * @brief Allocate zeroed memory for the hot paths. Requests up to the largest
+ * size class come from the smallest class that fits. Larger requests, and
+ * requests that find their class empty, fall back to calloc().
+ * @param nb - Number of elements
+ * @param size - Size of an element
+ * @return Address of the memory, NULL if the allocation fails
+ */
+void *pool_heap_calloc(size_t nb, size_t size)
+{
+	size_t total = nb * size;
+	uint32_t i, block_size = POOL_HEAP_MIN_BLOCK;
+	void *block;
+
+	if (size && total / size != nb)
+		return NULL;
+
+	if (!pool_heap_ready)
+		pool_heap_setup();
+
+	for (i = 0; i < POOL_HEAP_CLASSES; i++, block_size <<= 1) {
+		if (total > block_size)
+			continue;
+		block = pool_alloc(&pool_heap[i]);
+		if (!block)
+			break;
+		memset(block, 0, total);
+
+		return block;
+	}
+
+	return calloc(nb, size);
+}
+
+/**
+ * @brief Free memory allocated by pool_heap_calloc().
+ * @param ptr - Address of the memory
+ */
+void pool_heap_free(void *ptr)
+{
+	uint32_t i;
+
+	if (!ptr)
+		return;
+
+	for (i = 0; i < POOL_HEAP_CLASSES; i++)
+		if (pool_owns(&pool_heap[i], ptr)) {
+			pool_free(&pool_heap[i], ptr);
+			return;
+		}
+
+	free(ptr);
+}
+
+/**
+ * @brief Get the usage statistics of a size class of the hot path allocator.
+ * @param index - Size class, 0 for the smallest
+ * @param stats - Where to store the statistics
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -ENOENT : If there is no such size class
+ *  - -EINVAL : Otherwise
+ */
+int32_t pool_heap_get_stats(uint32_t index, struct pool_stats *stats)
+{
+	if (!stats)
+		return -EINVAL;
+	if (index >= POOL_HEAP_CLASSES)
+		return -ENOENT;
+
+	if (!pool_heap_ready)
+		pool_heap_setup();
+
+	return pool_get_stats(&pool_heap[index], stats);
+}
+#endif /* ENABLE_POOL_ALLOC */
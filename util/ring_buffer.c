@@ -0,0 +1,413 @@
+/***************************************************************************//**
+ *   @file   ring_buffer.c
+ *   @brief  Lock-free ring buffer implementation
+ *   @author Mihail Chindris (mihail.chindris@analog.com)
+********************************************************************************
+ *   @copyright
+ * Copyright 2020(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "ring_buffer.h"
+#include "error.h"
+#include "util.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct ring_buffer
+ * @brief Ring buffer descriptor
+ *
+ * Positions are free running and only masked when the buffer is accessed, so
+ * head - tail is always the number of stored bytes, also across wraps.
+ */
+struct ring_buffer {
+	/** Size of the buffer in bytes, a power of two */
+	uint32_t		size;
+	/** size - 1 */
+	uint32_t		mask;
+	/** Address of the buffer */
+	uint8_t			*buff;
+	/** True if more than one producer may write at a time */
+	bool			multi_producer;
+	/** End of the data visible to the consumer. Written by producers */
+	_Atomic uint32_t	head;
+	/** End of the space claimed by producers */
+	_Atomic uint32_t	reserve;
+	/** Start of the data not yet consumed. Written by the consumer */
+	_Atomic uint32_t	tail;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Create ring buffer structure
+ *
+ * @note Without multi_producer the ring buffer is lock-free for one writer
+ * and one reader, for example an interrupt handler and the main loop.
+ * With multi_producer any number of writers may share it. Writers claim
+ * space with a compare and swap and publish it in the order it was claimed,
+ * so a writer must not be preempted for long between rb_reserve() and
+ * rb_commit(), and never by another writer of the same ring. There is always
+ * a single reader.
+ *
+ * @param desc - Where to store the ring buffer reference
+ * @param size - Buffer size, a power of two
+ * @param multi_producer - Allow concurrent writers
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL, -ENOMEM : Otherwise
+ */
+int32_t rb_init(struct ring_buffer **desc, uint32_t size, bool multi_producer)
+{
+	struct ring_buffer	*ldesc;
+
+	if (!desc || !size || (size & (size - 1)))
+		return -EINVAL;
+
+	ldesc = (struct ring_buffer *)calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	ldesc->buff = calloc(1, size);
+	if (!ldesc->buff) {
+		free(ldesc);
+		return -ENOMEM;
+	}
+
+	ldesc->size = size;
+	ldesc->mask = size - 1;
+	ldesc->multi_producer = multi_producer;
+	atomic_init(&ldesc->head, 0);
+	atomic_init(&ldesc->reserve, 0);
+	atomic_init(&ldesc->tail, 0);
+
+	*desc = ldesc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated for the ring buffer structure
+ * @param desc - Ring buffer reference
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_remove(struct ring_buffer *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	free(desc->buff);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the number of bytes available for reading
+ * @param desc - Ring buffer reference
+ * @param size - Where to store the size
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_size(struct ring_buffer *desc, uint32_t *size)
+{
+	if (!desc || !size)
+		return -EINVAL;
+
+	*size = atomic_load_explicit(&desc->head, memory_order_acquire) -
+		atomic_load_explicit(&desc->tail, memory_order_relaxed);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the number of bytes that can be written
+ * @param desc - Ring buffer reference
+ * @param space - Where to store the free space
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_space(struct ring_buffer *desc, uint32_t *space)
+{
+	if (!desc || !space)
+		return -EINVAL;
+
+	*space = desc->size -
+		 (atomic_load_explicit(&desc->reserve, memory_order_relaxed) -
+		  atomic_load_explicit(&desc->tail, memory_order_acquire));
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Claim space for writing.
+ * @param desc - Ring buffer reference
+ * @param min_len - Fail if less than this can be claimed
+ * @param max_len - Claim at most this
+ * @param contiguous - Stop at the end of the buffer
+ * @param pos - Where to store the position of the claimed space
+ * @return Number of bytes claimed, -EAGAIN if there is not enough space
+ */
+static int32_t rb_claim(struct ring_buffer *desc, uint32_t min_len,
+			uint32_t max_len, bool contiguous, uint32_t *pos)
+{
+	uint32_t start, tail, len;
+
+	start = atomic_load_explicit(&desc->reserve, memory_order_relaxed);
+	do {
+		/* Acquire, so the reader is done with the space before reuse */
+		tail = atomic_load_explicit(&desc->tail, memory_order_acquire);
+		len = min(desc->size - (start - tail), max_len);
+		if (contiguous)
+			len = min(len, desc->size - (start & desc->mask));
+		if (!len || len < min_len)
+			return -EAGAIN;
+
+		if (!desc->multi_producer) {
+			atomic_store_explicit(&desc->reserve, start + len,
+					      memory_order_relaxed);
+			break;
+		}
+	} while (!atomic_compare_exchange_weak_explicit(&desc->reserve, &start,
+			start + len,
+			memory_order_relaxed,
+			memory_order_relaxed));
+
+	*pos = start;
+
+	return len;
+}
+
+/**
+ * @brief Make claimed space visible to the reader.
+ * @param desc - Ring buffer reference
+ * @param pos - Position of the claimed space
+ * @param len - Size of the claimed space
+ */
+static void rb_publish(struct ring_buffer *desc, uint32_t pos, uint32_t len)
+{
+	/*
+	 * Writers that claimed space earlier publish first. Acquire, so their
+	 * data is covered by the release below.
+	 */
+	if (desc->multi_producer)
+		while (atomic_load_explicit(&desc->head,
+					    memory_order_acquire) != pos)
+			;
+
+	atomic_store_explicit(&desc->head, pos + len, memory_order_release);
+}
+
+/**
+ * @brief Write data to the ring buffer. The data is written whole or not at
+ * all, so concurrent writers never interleave.
+ * @param desc - Ring buffer reference
+ * @param data - Data to write
+ * @param len - Number of bytes to write
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EAGAIN : If there is not enough space
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_write(struct ring_buffer *desc, const void *data, uint32_t len)
+{
+	uint32_t pos, idx, first;
+	int32_t ret;
+
+	if (!desc || !data || !len || len > desc->size)
+		return -EINVAL;
+
+	ret = rb_claim(desc, len, len, false, &pos);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	idx = pos & desc->mask;
+	first = min(len, desc->size - idx);
+	memcpy(desc->buff + idx, data, first);
+	memcpy(desc->buff, (const uint8_t *)data + first, len - first);
+
+	rb_publish(desc, pos, len);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Read data from the ring buffer.
+ * @param desc - Ring buffer reference
+ * @param data - Where to store the data
+ * @param len - Maximum number of bytes to read
+ * @return Number of bytes read, -EINVAL in case of error
+ */
+int32_t rb_read(struct ring_buffer *desc, void *data, uint32_t len)
+{
+	uint32_t head, tail, idx, first;
+
+	if (!desc || !data)
+		return -EINVAL;
+
+	tail = atomic_load_explicit(&desc->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&desc->head, memory_order_acquire);
+	len = min(len, head - tail);
+	if (!len)
+		return 0;
+
+	idx = tail & desc->mask;
+	first = min(len, desc->size - idx);
+	memcpy(data, desc->buff + idx, first);
+	memcpy((uint8_t *)data + first, desc->buff, len - first);
+
+	atomic_store_explicit(&desc->tail, tail + len, memory_order_release);
+
+	return len;
+}
+
+/**
+ * @brief Reserve a contiguous region to be filled in place, for example by
+ * a DMA transfer. The region may be shorter than requested when the free
+ * space wraps around the end of the buffer.
+ * @param desc - Ring buffer reference
+ * @param len - Number of bytes wanted
+ * @param span - Where to store the reserved region
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EAGAIN : If the buffer is full
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_reserve(struct ring_buffer *desc, uint32_t len,
+		   struct rb_span *span)
+{
+	uint32_t pos;
+	int32_t ret;
+
+	if (!desc || !span || !len)
+		return -EINVAL;
+
+	ret = rb_claim(desc, 1, len, true, &pos);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	span->buff = desc->buff + (pos & desc->mask);
+	span->len = ret;
+	span->pos = pos;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Make a region filled after rb_reserve() visible to the reader. All
+ * of the region is committed.
+ * @param desc - Ring buffer reference
+ * @param span - Region returned by rb_reserve()
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_commit(struct ring_buffer *desc, const struct rb_span *span)
+{
+	if (!desc || !span)
+		return -EINVAL;
+
+	rb_publish(desc, span->pos, span->len);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the contiguous region of data that can be read in place. The
+ * region may be shorter than the available data when it wraps around the
+ * end of the buffer.
+ * @param desc - Ring buffer reference
+ * @param len - Maximum number of bytes wanted
+ * @param span - Where to store the region
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EAGAIN : If the buffer is empty
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_peek(struct ring_buffer *desc, uint32_t len, struct rb_span *span)
+{
+	uint32_t head, tail;
+
+	if (!desc || !span || !len)
+		return -EINVAL;
+
+	tail = atomic_load_explicit(&desc->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&desc->head, memory_order_acquire);
+	len = min(len, head - tail);
+	len = min(len, desc->size - (tail & desc->mask));
+	if (!len)
+		return -EAGAIN;
+
+	span->buff = desc->buff + (tail & desc->mask);
+	span->len = len;
+	span->pos = tail;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Release a region returned by rb_peek(), after it has been used.
+ * @param desc - Ring buffer reference
+ * @param span - Region returned by rb_peek()
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -EINVAL : Otherwise
+ */
+int32_t rb_consume(struct ring_buffer *desc, const struct rb_span *span)
+{
+	if (!desc || !span ||
+	    span->pos != atomic_load_explicit(&desc->tail, memory_order_relaxed))
+		return -EINVAL;
+
+	atomic_store_explicit(&desc->tail, span->pos + span->len,
+			      memory_order_release);
+
+	return SUCCESS;
+}
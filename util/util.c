@@ -171,6 +171,46 @@ void rational_best_approximation(uint32_t given_numerator,
 	}
 }
 
+/**
+ * Find the divider whose output is closest to the desired rate. Odd dividers
+ * above odd_max are skipped, for dividers that only support a few odd ratios.
+ */
+uint32_t closest_divider(uint64_t parent_rate,
+			 uint64_t rate,
+			 uint32_t div_min,
+			 uint32_t div_max,
+			 uint32_t odd_max)
+{
+	uint64_t out, err, best_err = UINT64_MAX;
+	uint64_t div;
+	uint32_t cand, best_div;
+	int32_t i;
+
+	div_min = max(div_min, 1);
+	if (!rate)
+		return div_max;
+
+	/* The closest allowed ratio is at most one step around the quotient */
+	div = clamp(parent_rate / rate, div_min, div_max);
+	best_div = div;
+	for (i = -1; i <= 2; i++) {
+		if ((div + i < div_min) || (div + i > div_max))
+			continue;
+		cand = div + i;
+		if ((cand & 1) && (cand > odd_max))
+			continue;
+
+		out = DIV_ROUND_CLOSEST(parent_rate, cand);
+		err = (out > rate) ? out - rate : rate - out;
+		if (err < best_err) {
+			best_err = err;
+			best_div = cand;
+		}
+	}
+
+	return best_div;
+}
+
 /**
  * Calculate the number of set bits.
  */
@@ -187,6 +227,19 @@ uint32_t hweight8(uint32_t word)
 	return count;
 }
 
+/**
+ * Calculate the number of set bits in a 32-bit word, without looping over
+ * the bits.
+ */
+uint32_t hweight32(uint32_t word)
+{
+	word = word - ((word >> 1) & 0x55555555);
+	word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+	word = (word + (word >> 4)) & 0x0F0F0F0F;
+
+	return (word * 0x01010101) >> 24;
+}
+
 /**
  * Calculate the quotient and the remainder of an integer division.
  */
@@ -43,8 +43,10 @@
 
 #include <string.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include "xml.h"
 #include "error.h"
+#include "pool.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -67,21 +69,21 @@ ssize_t xml_create_attribute(struct xml_attribute **attribute, char *name,
 	if(!value)
 		return FAILURE;
 
-	*attribute = calloc(1, sizeof(struct xml_attribute));
+	*attribute = pool_heap_calloc(1, sizeof(struct xml_attribute));
 	if (!(*attribute))
 		return FAILURE;
 
-	(*attribute)->name = calloc(1, strlen(name) + 1);
+	(*attribute)->name = pool_heap_calloc(1, strlen(name) + 1);
 	if (!(*attribute)->name) {
-		free(*attribute);
+		pool_heap_free(*attribute);
 		return FAILURE;
 	}
 	strcpy((*attribute)->name, name);
 
-	(*attribute)->value = calloc(1, strlen(value) + 1);
+	(*attribute)->value = pool_heap_calloc(1, strlen(value) + 1);
 	if (!(*attribute)->value) {
-		free((*attribute)->name);
-		free(*attribute);
+		pool_heap_free((*attribute)->name);
+		pool_heap_free(*attribute);
 		return FAILURE;
 	}
 	strcpy((*attribute)->value, value);
@@ -133,12 +135,12 @@ ssize_t xml_create_node(struct xml_node **node, char *name)
 	if(!name)
 		return FAILURE;
 
-	*node = calloc(1, sizeof(struct xml_node));
+	*node = pool_heap_calloc(1, sizeof(struct xml_node));
 	if (!(*node))
 		return FAILURE;
-	(*node)->name = calloc(1, strlen(name) + 1);
+	(*node)->name = pool_heap_calloc(1, strlen(name) + 1);
 	if (!(*node)->name) {
-		free(*node);
+		pool_heap_free(*node);
 		return FAILURE;
 	}
 	strcpy((*node)->name, name);
@@ -183,9 +185,9 @@ ssize_t xml_add_node(struct xml_node *node_parent, struct xml_node *node_child)
  */
 ssize_t xml_delete_attribute(struct xml_attribute *attribute)
 {
-	free(attribute->name);
-	free(attribute->value);
-	free(attribute);
+	pool_heap_free(attribute->name);
+	pool_heap_free(attribute->value);
+	pool_heap_free(attribute);
 
 	return SUCCESS;
 }
@@ -204,10 +206,10 @@ ssize_t xml_delete_node(struct xml_node *node)
 	for (i = 0; i < node->children_cnt; i++) {
 		xml_delete_node(node->children[i]);
 	}
-	free(node->name);
+	pool_heap_free(node->name);
 	free(node->attributes);
 	free(node->children);
-	free(node);
+	pool_heap_free(node);
 
 	return SUCCESS;
 }
@@ -220,17 +222,23 @@ ssize_t xml_delete_node(struct xml_node *node)
  */
 static ssize_t xml_print_to_doc(struct xml_document *doc, char *data)
 {
-	uint32_t calc_len, print_len;
-
-	calc_len = strlen(data) + 1;
-	char *buff = realloc(doc->buff, doc->index + calc_len);
-	if (!buff)
-		return FAILURE;
-	doc->buff = buff;
-	print_len = sprintf(&(doc->buff[doc->index]), "%s", data);
-	if(print_len != calc_len - 1)
-		return FAILURE;
-	doc->index +=print_len;
+	uint32_t len, size;
+	char *buff;
+
+	len = strlen(data);
+	if (doc->index + len + 1 > doc->size) {
+		/* Grow geometrically, to keep building the document linear */
+		size = doc->size ? doc->size : 64;
+		while (doc->index + len + 1 > size)
+			size *= 2;
+		buff = realloc(doc->buff, size);
+		if (!buff)
+			return FAILURE;
+		doc->buff = buff;
+		doc->size = size;
+	}
+	memcpy(&doc->buff[doc->index], data, len + 1);
+	doc->index += len;
 
 	return SUCCESS;
 }
@@ -334,3 +342,191 @@ ssize_t xml_delete_document(struct xml_document *document)
 
 	return SUCCESS;
 }
+
+/**
+ * grow the buffer of a writer
+ * @param *writer
+ * @param len number of bytes that must fit after the current index,
+ * including the NULL terminator
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+static ssize_t xml_writer_grow(struct xml_writer *writer, uint32_t len)
+{
+	uint32_t size = writer->size;
+	char *buff;
+
+	while (writer->index + len > size)
+		size *= 2;
+
+	buff = realloc(writer->buff, size);
+	if (!buff) {
+		writer->error = FAILURE;
+		return FAILURE;
+	}
+	writer->buff = buff;
+	writer->size = size;
+
+	return SUCCESS;
+}
+
+/**
+ * print formatted data at the end of the document
+ * @param *writer
+ * @param *fmt format
+ * @param args format arguments
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+static ssize_t xml_writer_vprint(struct xml_writer *writer, const char *fmt,
+				 va_list args)
+{
+	va_list args_copy;
+	int len;
+
+	if (writer->error)
+		return writer->error;
+
+	va_copy(args_copy, args);
+	len = vsnprintf(writer->buff + writer->index,
+			writer->size - writer->index, fmt, args_copy);
+	va_end(args_copy);
+	if (len < 0) {
+		writer->error = FAILURE;
+		return FAILURE;
+	}
+
+	if ((uint32_t)len >= writer->size - writer->index) {
+		if (xml_writer_grow(writer, len + 1) < 0)
+			return FAILURE;
+		vsnprintf(writer->buff + writer->index,
+			  writer->size - writer->index, fmt, args);
+	}
+	writer->index += len;
+
+	return SUCCESS;
+}
+
+/**
+ * print formatted data at the end of the document
+ * @param *writer
+ * @param *fmt format
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+static ssize_t xml_writer_print(struct xml_writer *writer, const char *fmt, ...)
+{
+	va_list args;
+	ssize_t ret;
+
+	va_start(args, fmt);
+	ret = xml_writer_vprint(writer, fmt, args);
+	va_end(args);
+
+	return ret;
+}
+
+/**
+ * initialize a streaming xml writer
+ * @param *writer
+ * @param size_hint expected document size, the buffer grows if needed
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_writer_init(struct xml_writer *writer, uint32_t size_hint)
+{
+	if (!writer)
+		return FAILURE;
+
+	writer->size = size_hint ? size_hint : 256;
+	writer->index = 0;
+	writer->tag_open = false;
+	writer->error = SUCCESS;
+	writer->buff = malloc(writer->size);
+	if (!writer->buff)
+		return FAILURE;
+	writer->buff[0] = '\0';
+
+	return SUCCESS;
+}
+
+/**
+ * start a node, closing the start tag of its parent
+ * @param *writer
+ * @param *name node name
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_writer_start_node(struct xml_writer *writer, const char *name)
+{
+	ssize_t ret;
+
+	if (writer->tag_open) {
+		ret = xml_writer_print(writer, ">\n");
+		if (ret < 0)
+			return ret;
+	}
+	writer->tag_open = true;
+
+	return xml_writer_print(writer, "<%s ", name);
+}
+
+/**
+ * print an attribute of the last started node, before any of its children
+ * @param *writer
+ * @param *name attribute name
+ * @param *fmt attribute value format, followed by its arguments
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_writer_attribute(struct xml_writer *writer, const char *name,
+			     const char *fmt, ...)
+{
+	va_list args;
+	ssize_t ret;
+
+	if (!writer->tag_open)
+		return FAILURE;
+
+	ret = xml_writer_print(writer, "%s=\"", name);
+	if (ret < 0)
+		return ret;
+
+	va_start(args, fmt);
+	ret = xml_writer_vprint(writer, fmt, args);
+	va_end(args);
+	if (ret < 0)
+		return ret;
+
+	return xml_writer_print(writer, "\" ");
+}
+
+/**
+ * end the last started node
+ * @param *writer
+ * @param *name node name
+ * @return SUCCESS in case of success or negative value otherwise
+ */
+ssize_t xml_writer_end_node(struct xml_writer *writer, const char *name)
+{
+	if (writer->tag_open) {
+		writer->tag_open = false;
+		return xml_writer_print(writer, "/>\n");
+	}
+
+	return xml_writer_print(writer, "</%s>\n", name);
+}
+
+/**
+ * get the document, on error the buffer is freed
+ * @param *writer
+ * @param **buff NULL terminated document, to be freed by the caller
+ * @return document length or negative value in case of error
+ */
+ssize_t xml_writer_finish(struct xml_writer *writer, char **buff)
+{
+	if (writer->error || !buff) {
+		free(writer->buff);
+		writer->buff = NULL;
+		return FAILURE;
+	}
+
+	*buff = writer->buff;
+	writer->buff = NULL;
+
+	return writer->index;
+}